@@ -39,10 +39,12 @@
 #include "iolib.h"
 #include "luacallback.h"
 #include "map.h"
+#include "pathfinder.h"
 #include "player.h"
 #include "script.h"
 #include "sound.h"
 #include "translate.h"
+#include "trigger.h"
 #include "unit.h"
 #include "unittype.h"
 
@@ -165,6 +167,8 @@ static void Finish(COrder_Built &order, CUnit &unit)
 		player.UnitTypesAiActiveCount[type.Slot]++;
 	}
 	unit.Constructed = 0;
+	TriggerUnitChanged(unit);
+	DistanceFieldsUnitChanged(unit);
 	if (unit.Frame < 0) {
 		unit.Frame = -1;
 	} else {
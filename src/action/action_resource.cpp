@@ -353,6 +353,9 @@ void COrder_Resource::UpdatePathFinderData(PathFinderInput &input) /* override *
 		tileSize.x = goal->Type->TileWidth;
 		tileSize.y = goal->Type->TileHeight;
 		input.SetGoal(goal->tilePos, tileSize);
+		if (this->Resource.Mine && this->Depot && (goal == this->Resource.Mine || goal == this->Depot)) {
+			input.SetHarvestRoute(this->Resource.Mine, this->Depot);
+		}
 	} else {
 		tileSize.x = 0;
 		tileSize.y = 0;
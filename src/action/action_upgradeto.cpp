@@ -41,10 +41,12 @@
 #include "animation.h"
 #include "iolib.h"
 #include "map.h"
+#include "pathfinder.h"
 #include "player.h"
 #include "script.h"
 #include "spells.h"
 #include "translate.h"
+#include "trigger.h"
 #include "unit.h"
 #include "unittype.h"
 
@@ -90,6 +92,7 @@ static int TransformUnitIntoType(CUnit &unit, const CUnitType &newtype)
 	if (&oldtype == &newtype) { // nothing to do
 		return 1;
 	}
+	TriggerUnitChanged(unit);
 	const Vec2i pos = unit.tilePos + oldtype.GetHalfTileSize() - newtype.GetHalfTileSize();
 	CUnit *container = unit.Container;
 
@@ -164,6 +167,9 @@ static int TransformUnitIntoType(CUnit &unit, const CUnitType &newtype)
 	}
 
 	UpdateForNewUnit(unit, 1);
+	TriggerUnitChanged(unit);
+	DistanceFieldsUnitChanged(unit);
+	AiInfluenceUnitChanged(unit);
 	//  Update Possible sight range change
 	UpdateUnitSightRange(unit);
 	if (!container) {
@@ -71,6 +71,7 @@
 #include "player.h"
 #include "script.h"
 #include "spells.h"
+#include "synchash.h"
 #include "unit.h"
 #include "unit_find.h"
 #include "unit_manager.h"
@@ -449,10 +450,42 @@ static void HandleUnitAction(CUnit &unit)
 	unit.Orders[0]->Execute(unit);
 }
 
-static void UnitActionsEachSecond(const std::vector<CUnit *> &units)
+/**
+**  Call a batched callback of the unit-types, once per unit-type with the
+**  ids of all its usable units, instead of once per unit.
+**
+**  @param count       Number of locked units to handle.
+**  @param eachSecond  Call OnEachSecondBatch instead of OnEachCycleBatch.
+*/
+void UnitActionsBatchedCallback(size_t count, bool eachSecond)
+{
+	const auto callback = eachSecond ? &CUnitType::OnEachSecondBatch : &CUnitType::OnEachCycleBatch;
+	// Kept between the calls, to reuse the memory.
+	static std::vector<std::vector<int>> unitIds; // by unit-type slot
+
+	unitIds.resize(UnitTypes.size());
+	for (size_t i = 0; i != count; ++i) {
+		const CUnit &unit = UnitManager->GetLockedUnit(i);
+
+		if (!unit.Destroyed && unit.Type->*callback && unit.IsUnusable(false) == false) {
+			unitIds[unit.Type->Slot].push_back(UnitNumber(unit));
+		}
+	}
+	// Ordered by unit-type slot, to be the same on all the network peers.
+	for (size_t slot = 0; slot != unitIds.size(); ++slot) {
+		if (!unitIds[slot].empty()) {
+			(UnitTypes[slot]->*callback)(unitIds[slot]);
+			unitIds[slot].clear();
+		}
+	}
+}
+
+static void UnitActionsEachSecond(size_t count)
 {
-	for (CUnit *unitPtr : units) {
-		CUnit &unit = *unitPtr;
+	UnitActionsBatchedCallback(count, true);
+
+	for (size_t i = 0; i != count; ++i) {
+		CUnit &unit = UnitManager->GetLockedUnit(i);
 
 		if (unit.Destroyed) {
 			continue;
@@ -544,10 +577,12 @@ static void DumpUnitInfo(const CUnit &unit)
 	fflush(nullptr);
 }
 
-static void UnitActionsEachCycle(const std::vector<CUnit *> &units)
+static void UnitActionsEachCycle(size_t count)
 {
-	for (auto *unitPtr : units) {
-		CUnit &unit = *unitPtr;
+	UnitActionsBatchedCallback(count, false);
+
+	for (size_t i = 0; i != count; ++i) {
+		CUnit &unit = UnitManager->GetLockedUnit(i);
 
 		if (unit.Destroyed) {
 			continue;
@@ -586,6 +621,9 @@ static void UnitActionsEachCycle(const std::vector<CUnit *> &units)
 		              ? static_cast<std::underlying_type_t<UnitAction>>(unit.CurrentAction()) << 18
 		              : 0;
 		SyncHash ^= unit.Refs << 3;
+		if (StrongSyncHashEnabled) {
+			StrongSyncHash.UpdateUnit(unit);
+		}
 
 		if (EnableUnitDebug) {
 			const char *currentAction =
@@ -612,15 +650,23 @@ static void UnitActionsEachCycle(const std::vector<CUnit *> &units)
 void UnitActions()
 {
 	const bool isASecondCycle = !(GameCycle % CYCLES_PER_SECOND);
-	// Unit list may be modified during loop... so make a copy
-	std::vector<CUnit *> units(UnitManager->GetUnits());
+	// Unit list may be modified during loop... lock it to walk the units
+	// there now, the new units are skipped.
+	UnitManager->LockUnits();
+	const size_t count = UnitManager->GetLockedCount();
 
 	// Check for things that only happen every second
 	if (isASecondCycle) {
-		UnitActionsEachSecond(units);
+		UnitActionsEachSecond(count);
 	}
+	// Search together the paths needed by the actions
+	PathfinderPrefetchPaths(UnitManager->GetUnits());
 	// Do all actions
-	UnitActionsEachCycle(units);
+	UnitActionsEachCycle(count);
+	UnitManager->UnlockUnits();
+	if (StrongSyncHashEnabled) {
+		StrongSyncHash.EndCycle();
+	}
 }
 
 //@}
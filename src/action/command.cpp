@@ -937,10 +937,9 @@ void CommandSharedVision(int playerIndex, bool state, int opponentIndex)
 		const size_t fieldsNum = Map.Info.MapWidth * Map.Info.MapHeight;
 		for (size_t i = 0; i != fieldsNum; ++i) {
 			CMapField &mf = *Map.Field(i);
-			CMapFieldPlayerInfo &mfp = mf.playerInfo;
 
-			if (mfp.Visible[playerIndex] && !mfp.Visible[opponentIndex]) {
-				mfp.Visible[opponentIndex] = 1;
+			if (Map.Visibility.IsExplored(playerIndex, i) && !Map.Visibility.IsExplored(opponentIndex, i)) {
+				Map.Visibility.SetVisible(opponentIndex, i, 1);
 				/// TODO: change ThisPlayer to currently rendered player/players #RenderTargets
 				if (opponent == ThisPlayer) {
 					Map.MarkSeenTile(mf);
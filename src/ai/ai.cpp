@@ -84,11 +84,12 @@
 ** ::AiEachCycle(::Player)
 **
 ** Called each game cycle, to handle quick checks, which needs
-** less CPU.
+** less CPU, and to continue the tasks started by ::AiEachSecond.
 **
 ** ::AiEachSecond(::Player)
 **
-** Called each second, to handle more CPU intensive things.
+** Called each second, to handle more CPU intensive things. They are
+** spread over the next cycles, within a budget for each cycle.
 **
 **
 ** @subsection aiecall Event call-backs
@@ -149,6 +150,7 @@
 #include "map.h"
 #include "pathfinder.h"
 #include "player.h"
+#include "profiler.h"
 #include "script.h"
 #include "unit.h"
 #include "unit_manager.h"
@@ -382,7 +384,9 @@ static void SaveAiPlayer(CFile &file, int plynr, const PlayerAi &ai)
 	}
 	file.printf("},\n");
 
-	file.printf("  \"repair-building\", %u\n", ai.LastRepairBuilding);
+	file.printf("  \"repair-building\", %u,\n", ai.LastRepairBuilding);
+	file.printf("  \"task\", %d, \"next-force\", %u, \"force-pathing\", %d\n",
+				static_cast<int>(ai.NextTask), ai.NextForce, ai.ForcePathing);
 
 	file.printf(")\n\n");
 }
@@ -474,6 +478,7 @@ void CleanAi()
 	for (int p = 0; p < PlayerMax; ++p) {
 		Players[p].Ai = nullptr;
 	}
+	AiCleanInfluence();
 }
 
 
@@ -990,23 +995,113 @@ void AiResearchComplete(CUnit &unit, const CUpgrade *what)
 	// FIXME: upgrading knights -> paladins, must rebuild lists!
 }
 
+/**
+**  Cost of the next task of the current second (or of the update of the
+**  next force) for an AI player.
+**
+**  It is computed before the task is run, from the game state only.
+**
+**  @param ai  The AI player.
+**
+**  @return    Cost of the task, about the number of units processed.
+*/
+int AiNextTaskCost(const PlayerAi &ai)
+{
+	switch (ai.NextTask) {
+		case AiTask::Script:
+		case AiTask::Explorers:
+			return 1;
+		case AiTask::CheckUnits:
+		case AiTask::Resources:
+		case AiTask::AssignFreeUnits:
+		case AiTask::Magic:
+			return 1 + ai.Player->GetUnitCount();
+		case AiTask::Forces:
+			if (ai.NextForce < ai.Force.Size() && ai.ForcePathing >= 0) {
+				return 1 + static_cast<int>(ai.Force[ai.NextForce].Size());
+			}
+			return 1;
+		case AiTask::Done:
+			break;
+	}
+	return 0;
+}
+
+/**
+**  Run the next task of the current second (or the update of the next
+**  force) for the current AI player.
+*/
+static void AiRunNextTask()
+{
+	switch (AiPlayer->NextTask) {
+		case AiTask::Script:
+			AiExecuteScript();
+			AiPlayer->NextTask = AiTask::CheckUnits;
+			break;
+		case AiTask::CheckUnits:
+			AiCheckUnits();
+			AiPlayer->NextTask = AiTask::Resources;
+			break;
+		case AiTask::Resources:
+			AiResourceManager();
+			AiPlayer->NextTask = AiTask::Forces;
+			break;
+		case AiTask::Forces:
+			if (AiPlayer->NextForce < AiPlayer->Force.Size()
+			    && AiPlayer->Force.UpdateForce(AiPlayer->NextForce, AiPlayer->ForcePathing)) {
+				++AiPlayer->NextForce;
+			} else {
+				AiPlayer->NextTask = AiTask::AssignFreeUnits;
+			}
+			break;
+		case AiTask::AssignFreeUnits:
+			AiAssignFreeUnitsToForce();
+			AiPlayer->NextTask = AiTask::Magic;
+			break;
+		case AiTask::Magic:
+			AiCheckMagic();
+			AiPlayer->NextTask = AiTask::Explorers;
+			break;
+		case AiTask::Explorers:
+			// At most 1 explorer each 5 seconds
+			if (GameCycle > AiPlayer->LastExplorationGameCycle + 5 * CYCLES_PER_SECOND) {
+				AiSendExplorers();
+			}
+			AiPlayer->NextTask = AiTask::Done;
+			break;
+		case AiTask::Done:
+			break;
+	}
+}
+
 /**
 **  This is called for each player, each game cycle.
 **
+**  Continue the tasks started by the last AiEachSecond.
+**
 **  @param player  The player structure pointer.
 */
 void AiEachCycle(CPlayer &player)
 {
 	AiPlayer = player.Ai.get();
+	if (!AiPlayer || AiPlayer->NextTask == AiTask::Done) {
+		return;
+	}
+	PROFILE_ZONE_ARG("AiEachCycle", player.Index);
+	AiRunTasks(*AiPlayer, AiRunNextTask);
 }
 
 /**
 **  This is called for each player each second.
 **
+**  Start the tasks of the second, they are spread over the next cycles
+**  by AiEachCycle.
+**
 **  @param player  The player structure pointer.
 */
 void AiEachSecond(CPlayer &player)
 {
+	PROFILE_ZONE_ARG("AiEachSecond", player.Index);
 	AiPlayer = player.Ai.get();
 #ifdef DEBUG
 	if (!AiPlayer) {
@@ -1014,25 +1109,14 @@ void AiEachSecond(CPlayer &player)
 	}
 #endif
 
-	//  Advance script
-	AiExecuteScript();
-
-	//  Look if everything is fine.
-	AiCheckUnits();
-
-	//  Handle the resource manager.
-	AiResourceManager();
-
-	//  Handle the force manager.
-	AiForceManager();
-
-	//  Check for magic actions.
-	AiCheckMagic();
-
-	// At most 1 explorer each 5 seconds
-	if (GameCycle > AiPlayer->LastExplorationGameCycle + 5 * CYCLES_PER_SECOND) {
-		AiSendExplorers();
+	// Finish the tasks of the previous second (if the budget was too small)
+	while (AiPlayer->NextTask != AiTask::Done) {
+		AiRunNextTask();
 	}
+	AiPlayer->NextTask = AiTask::Script;
+	AiPlayer->NextForce = 0;
+	AiPlayer->ForcePathing = AI_MAX_FORCE_PATHING;
+	AiRunTasks(*AiPlayer, AiRunNextTask);
 }
 
 std::vector<std::vector<CUnitType *>> &AiHelper::Train()
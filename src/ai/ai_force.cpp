@@ -66,6 +66,7 @@ class EnemyUnitFinder
 		movemask(unit.Type->MovementMask & ~(MapFieldLandUnit | MapFieldAirUnit | MapFieldSeaUnit)),
 		attackrange(unit.Stats->Variables[ATTACKRANGE_INDEX].Max),
 		find_type(find_type),
+		enemies(AiInfluenceEnemies(*unit.Player)),
 		result_unit(result_unit)
 	{
 		*result_unit = nullptr;
@@ -76,6 +77,7 @@ class EnemyUnitFinder
 	unsigned int movemask;
 	const int attackrange;
 	const int find_type;
+	const std::bitset<PlayerMax> enemies;
 	CUnit **result_unit;
 };
 
@@ -87,6 +89,10 @@ VisitResult EnemyUnitFinder::Visit(TerrainTraversal &terrainTraversal, const Vec
 
 	Vec2i minpos = pos - Vec2i(attackrange, attackrange);
 	Vec2i maxpos = pos + Vec2i(unit.Type->TileWidth - 1 + attackrange, unit.Type->TileHeight - 1 + attackrange);
+	// Most tiles have no enemy around, the influence map tells it without looking at the units.
+	if (AiGetInfluence(enemies, minpos, maxpos).Units == 0) {
+		return VisitResult::Ok;
+	}
 	std::vector<CUnit *> table = Select(minpos, maxpos, HasNotSamePlayerAs(Players[PlayerNumNeutral]));
 	for (CUnit *dest : table) {
 		const CUnitType &dtype = *dest->Type;
@@ -1053,93 +1059,91 @@ void AiForce::Update()
 	}
 }
 
-void AiForceManager::Update()
+/**
+**  Update a force, called for each force every second.
+**
+**  @param index       Index of the force.
+**  @param maxPathing  Map searches left this second, decremented by the searches.
+**
+**  @return            false if the next forces must wait for the next second.
+*/
+bool AiForceManager::UpdateForce(unsigned int index, int &maxPathing)
 {
-	int maxPathing = 2; // reduce load by stopping after issuing a few map searches
-	for (AiForce &force : forces) {
-		if (maxPathing < 0) {
-			return;
-		}
+	if (maxPathing < 0) {
+		return false;
+	}
+	AiForce &force = forces[index];
 
-		//  Look if our defenders still have enemies in range.
+	//  Look if our defenders still have enemies in range.
 
-		if (force.Defending) {
-			force.RemoveDeadUnit();
+	if (force.Defending) {
+		force.RemoveDeadUnit();
 
-			if (force.Size() == 0) {
-				force.Attacking = false;
-				force.Defending = false;
-				force.State = AiForceAttackingState::Waiting;
-				continue;
-			}
-			const int nearDist = 5;
+		if (force.Size() == 0) {
+			force.Attacking = false;
+			force.Defending = false;
+			force.State = AiForceAttackingState::Waiting;
+			return true;
+		}
+		const int nearDist = 5;
 
-			if (Map.Info.IsPointOnMap(force.GoalPos) == false) {
-				force.ReturnToHome();
-			} else {
-				//  Check if some unit from force reached goal point
-				for (const CUnit *aiunit : force.Units) {
-					if (aiunit->MapDistanceTo(force.GoalPos) <= nearDist) {
-						//  Look if still enemies in attack range.
-						const CUnit *dummy = nullptr;
-						maxPathing--;
-						if (!AiForceEnemyFinder<AIATTACK_RANGE>(force, &dummy).found()) {
-							force.ReturnToHome();
-						}
+		if (Map.Info.IsPointOnMap(force.GoalPos) == false) {
+			force.ReturnToHome();
+		} else {
+			//  Check if some unit from force reached goal point
+			for (const CUnit *aiunit : force.Units) {
+				if (aiunit->MapDistanceTo(force.GoalPos) <= nearDist) {
+					//  Look if still enemies in attack range.
+					const CUnit *dummy = nullptr;
+					maxPathing--;
+					if (!AiForceEnemyFinder<AIATTACK_RANGE>(force, &dummy).found()) {
+						force.ReturnToHome();
 					}
 				}
+			}
 
-				if (force.Defending == false) {
-					// force is no longer defending
-					return;
-				}
+			if (force.Defending == false) {
+				// force is no longer defending
+				return false;
+			}
 
-				// Find idle units and order them to defend
-				// Don't attack if there aren't our units near goal point
-				const Vec2i offset(15, 15);
-				maxPathing--;
-				std::vector<CUnit *> nearGoal = Select(force.GoalPos - offset,
-				                                       force.GoalPos + offset,
-				                                       IsAnAlliedUnitOf(*force.Units[0]->Player));
-				if (nearGoal.empty()) {
-					force.ReturnToHome();
-				} else {
-					std::vector<CUnit *> idleUnits;
-					ranges::copy_if(
-						force.Units, std::back_inserter(idleUnits), [](const CUnit *aiunit) {
-							return aiunit->IsIdle() && aiunit->IsAliveOnMap();
-						});
-					for (unsigned int i = 0; i != idleUnits.size(); ++i) {
-						CUnit *const unit = idleUnits[i];
-
-						if (unit->Container == nullptr) {
-							const int delay = i / 5; // To avoid lot of CPU consuption, send them with a small time difference.
-
-							unit->Wait = delay;
-							if (unit->Type->CanAttack) {
-								CommandAttack(*unit, force.GoalPos, nullptr, FlushCommands);
-							} else {
-								CommandMove(*unit, force.GoalPos, FlushCommands);
-							}
+			// Find idle units and order them to defend
+			// Don't attack if there aren't our units near goal point
+			const Vec2i offset(15, 15);
+			maxPathing--;
+			std::vector<CUnit *> nearGoal = Select(force.GoalPos - offset,
+			                                       force.GoalPos + offset,
+			                                       IsAnAlliedUnitOf(*force.Units[0]->Player));
+			if (nearGoal.empty()) {
+				force.ReturnToHome();
+			} else {
+				std::vector<CUnit *> idleUnits;
+				ranges::copy_if(
+					force.Units, std::back_inserter(idleUnits), [](const CUnit *aiunit) {
+						return aiunit->IsIdle() && aiunit->IsAliveOnMap();
+					});
+				for (unsigned int i = 0; i != idleUnits.size(); ++i) {
+					CUnit *const unit = idleUnits[i];
+
+					if (unit->Container == nullptr) {
+						const int delay = i / 5; // To avoid lot of CPU consuption, send them with a small time difference.
+
+						unit->Wait = delay;
+						if (unit->Type->CanAttack) {
+							CommandAttack(*unit, force.GoalPos, nullptr, FlushCommands);
+						} else {
+							CommandMove(*unit, force.GoalPos, FlushCommands);
 						}
 					}
 				}
 			}
-		} else if (force.Attacking) {
-			force.RemoveDeadUnit();
-			maxPathing--;
-			force.Update();
 		}
+	} else if (force.Attacking) {
+		force.RemoveDeadUnit();
+		maxPathing--;
+		force.Update();
 	}
-}
-
-/**
-**  Entry point of force manager, periodic called.
-*/
-void AiForceManager()
-{
-	AiPlayer->Force.Update();
-	AiAssignFreeUnitsToForce();
+	return true;
 }
 
 //@}
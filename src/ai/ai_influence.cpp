@@ -0,0 +1,299 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name ai_influence.cpp - The AI influence map. */
+//
+//      (c) Copyright 2026 by the Stratagus Team
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+//@{
+
+/*
+**  The influence map cuts the map in cells of AiInfluenceCellSize tiles
+**  and keeps, for each player and cell, the number of units on the map,
+**  their strength and their threat against each movement type.
+**
+**  It is updated when a unit is inserted in or removed from the map (so
+**  each time it moves to another tile), changes owner or type. What each
+**  unit added is remembered, so removing it is exact even if its stats
+**  changed in between.
+**
+**  The strength of a unit is its damage (basic and piercing) if it can
+**  attack, and counts as threat against the movement types it can target.
+**
+**  The dying units still on the map are counted too, without strength:
+**  the unit selections find them, and AiEnemyUnitsInDistance must not
+**  skip a selection which would find one.
+*/
+
+/*----------------------------------------------------------------------------
+--  Includes
+----------------------------------------------------------------------------*/
+
+#include "stratagus.h"
+
+#include "ai.h"
+#include "ai_local.h"
+
+#include "map.h"
+#include "player.h"
+#include "unit.h"
+#include "unittype.h"
+
+#include <algorithm>
+
+/*----------------------------------------------------------------------------
+--  Declarations
+----------------------------------------------------------------------------*/
+
+namespace
+{
+
+/// What a unit added to the influence map
+struct InfluenceContribution {
+	int Player = -1;              /// Owner of the unit, -1 if it added nothing
+	unsigned int Cell = 0;        /// Cell of the unit
+	int Strength = 0;             /// Strength of the unit
+	bool Targets[3]{};            /// Movement types the unit can attack (by EMovement)
+};
+
+} // namespace
+
+/*----------------------------------------------------------------------------
+--  Variables
+----------------------------------------------------------------------------*/
+
+static int InfluenceMapWidth;     /// Width in tiles of the map of the cells
+static int InfluenceMapHeight;    /// Height in tiles of the map of the cells
+static int InfluenceCellsX;       /// Number of cells on the x axis
+static int InfluenceCellsY;       /// Number of cells on the y axis
+/// Biggest width or height of the units added, they are counted in the cell of their top left tile
+static int InfluenceMaxUnitSize = 1;
+/// Cells of each player
+static std::vector<AiInfluence> InfluenceCells[PlayerMax];
+/// Contribution of each unit slot
+static std::vector<InfluenceContribution> InfluenceContributions;
+
+/*----------------------------------------------------------------------------
+--  Functions
+----------------------------------------------------------------------------*/
+
+/**
+**  Forget all the units, at the end of a game.
+*/
+void AiCleanInfluence()
+{
+	InfluenceMapWidth = 0;
+	InfluenceMapHeight = 0;
+	InfluenceCellsX = 0;
+	InfluenceCellsY = 0;
+	InfluenceMaxUnitSize = 1;
+	for (auto &cells : InfluenceCells) {
+		cells.clear();
+	}
+	InfluenceContributions.clear();
+}
+
+/// Allocate the cells for the current map, dropping the previous ones
+static void AiInitInfluence()
+{
+	AiCleanInfluence();
+	InfluenceMapWidth = Map.Info.MapWidth;
+	InfluenceMapHeight = Map.Info.MapHeight;
+	InfluenceCellsX = (InfluenceMapWidth + AiInfluenceCellSize - 1) / AiInfluenceCellSize;
+	InfluenceCellsY = (InfluenceMapHeight + AiInfluenceCellSize - 1) / AiInfluenceCellSize;
+	for (auto &cells : InfluenceCells) {
+		cells.assign(InfluenceCellsX * InfluenceCellsY, AiInfluence());
+	}
+}
+
+/// Add or remove (sign -1) a contribution to the cells of its player
+static void AiApplyInfluence(const InfluenceContribution &contribution, int sign)
+{
+	AiInfluence &cell = InfluenceCells[contribution.Player][contribution.Cell];
+
+	cell.Units += sign;
+	cell.Strength += sign * contribution.Strength;
+	for (int i = 0; i != 3; ++i) {
+		if (contribution.Targets[i]) {
+			cell.Threat[i] += sign * contribution.Strength;
+			cell.Attackers[i] += sign;
+		}
+	}
+}
+
+/**
+**  Update the influence of a unit, after it was placed, moved, removed,
+**  given to another player or transformed.
+**
+**  @param unit     The unit.
+**  @param removed  The unit is being removed from the map.
+*/
+void AiInfluenceUnitChanged(const CUnit &unit, bool removed)
+{
+	if (InfluenceMapWidth != Map.Info.MapWidth || InfluenceMapHeight != Map.Info.MapHeight) {
+		AiInitInfluence();
+	}
+	const int slot = UnitNumber(unit);
+	if (slot < 0) { // not managed (tests)
+		return;
+	}
+	if (size_t(slot) >= InfluenceContributions.size()) {
+		InfluenceContributions.resize(slot + 1);
+	}
+	InfluenceContribution &contribution = InfluenceContributions[slot];
+
+	if (contribution.Player != -1) {
+		AiApplyInfluence(contribution, -1);
+		contribution = InfluenceContribution();
+	}
+	if (removed || !unit.Player || unit.Removed) {
+		return;
+	}
+	const CUnitType &type = *unit.Type;
+	InfluenceMaxUnitSize = std::max<int>({InfluenceMaxUnitSize, type.TileWidth, type.TileHeight});
+	contribution.Player = unit.Player->Index;
+	contribution.Cell = (unit.tilePos.y / AiInfluenceCellSize) * InfluenceCellsX
+	                    + unit.tilePos.x / AiInfluenceCellSize;
+	if (type.CanAttack) {
+		if (unit.IsAlive()) {
+			contribution.Strength = unit.Stats->Variables[BASICDAMAGE_INDEX].Value
+			                        + unit.Stats->Variables[PIERCINGDAMAGE_INDEX].Value;
+		}
+		contribution.Targets[int(EMovement::Land)] = (type.CanTarget & ECanTargetFlag::Land) != ECanTargetFlag::NulFlag;
+		contribution.Targets[int(EMovement::Fly)] = (type.CanTarget & ECanTargetFlag::Air) != ECanTargetFlag::NulFlag;
+		contribution.Targets[int(EMovement::Naval)] = (type.CanTarget & ECanTargetFlag::Sea) != ECanTargetFlag::NulFlag;
+	}
+	AiApplyInfluence(contribution, 1);
+}
+
+/**
+**  Get the players which are enemies of a player (whose units it attacks).
+*/
+std::bitset<PlayerMax> AiInfluenceEnemies(const CPlayer &player)
+{
+	std::bitset<PlayerMax> players;
+
+	for (int i = 0; i != PlayerMax; ++i) {
+		if (player.IsEnemy(i)) {
+			players.set(i);
+		}
+	}
+	return players;
+}
+
+/**
+**  Get the players which are hostile to a player (whose units attack it).
+*/
+std::bitset<PlayerMax> AiInfluenceHostiles(const CPlayer &player)
+{
+	std::bitset<PlayerMax> players;
+
+	for (int i = 0; i != PlayerMax; ++i) {
+		if (Players[i].IsEnemy(player)) {
+			players.set(i);
+		}
+	}
+	return players;
+}
+
+/**
+**  Sum the influence of some players on the cells covering a tile area.
+**
+**  The cells are coarse: the result may include units a few tiles outside
+**  of the area, but never misses one inside.
+**
+**  @param players      Players to sum.
+**  @param topLeft      Top left tile of the area (may be out of the map).
+**  @param bottomRight  Bottom right tile of the area (may be out of the map).
+*/
+AiInfluence AiGetInfluence(const std::bitset<PlayerMax> &players, const Vec2i &topLeft, const Vec2i &bottomRight)
+{
+	AiInfluence sum;
+
+	if (InfluenceMapWidth != Map.Info.MapWidth || InfluenceMapHeight != Map.Info.MapHeight
+	    || InfluenceCellsX == 0) {
+		return sum;
+	}
+	// the units starting before the area may cover it
+	const int minX = std::clamp((topLeft.x - InfluenceMaxUnitSize + 1) / AiInfluenceCellSize, 0, InfluenceCellsX - 1);
+	const int minY = std::clamp((topLeft.y - InfluenceMaxUnitSize + 1) / AiInfluenceCellSize, 0, InfluenceCellsY - 1);
+	const int maxX = std::clamp(bottomRight.x / AiInfluenceCellSize, 0, InfluenceCellsX - 1);
+	const int maxY = std::clamp(bottomRight.y / AiInfluenceCellSize, 0, InfluenceCellsY - 1);
+	for (int p = 0; p != PlayerMax; ++p) {
+		if (!players.test(p)) {
+			continue;
+		}
+		for (int y = minY; y <= maxY; ++y) {
+			for (int x = minX; x <= maxX; ++x) {
+				const AiInfluence &cell = InfluenceCells[p][y * InfluenceCellsX + x];
+				sum.Units += cell.Units;
+				sum.Strength += cell.Strength;
+				for (int i = 0; i != 3; ++i) {
+					sum.Threat[i] += cell.Threat[i];
+					sum.Attackers[i] += cell.Attackers[i];
+				}
+			}
+		}
+	}
+	return sum;
+}
+
+/**
+**  Find the cell where some players are the strongest (or have the most
+**  units if none can attack).
+**
+**  @param players  Players to sum.
+**  @param pos      Output: center tile of the cell.
+**
+**  @return         false if the players have no units on the map.
+*/
+bool AiFindInfluence(const std::bitset<PlayerMax> &players, Vec2i *pos)
+{
+	int best = -1;
+	std::pair<int, int> bestValue(0, 0);
+
+	for (int y = 0; y != InfluenceCellsY; ++y) {
+		for (int x = 0; x != InfluenceCellsX; ++x) {
+			const Vec2i cellPos(x * AiInfluenceCellSize, y * AiInfluenceCellSize);
+			const AiInfluence cell = AiGetInfluence(players, cellPos, cellPos);
+			const std::pair<int, int> value(cell.Strength, cell.Units);
+			// the first cell wins on ties, to stay deterministic
+			if (value > bestValue) {
+				best = y * InfluenceCellsX + x;
+				bestValue = value;
+			}
+		}
+	}
+	if (best == -1) {
+		return false;
+	}
+	*pos = Vec2i(std::min((best % InfluenceCellsX) * AiInfluenceCellSize + AiInfluenceCellSize / 2,
+	                      InfluenceMapWidth - 1),
+	             std::min((best / InfluenceCellsX) * AiInfluenceCellSize + AiInfluenceCellSize / 2,
+	                      InfluenceMapHeight - 1));
+	return true;
+}
+
+//@}
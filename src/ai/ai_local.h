@@ -37,10 +37,12 @@
 ----------------------------------------------------------------------------*/
 
 #include <array>
+#include <bitset>
 #include <memory>
 #include <optional>
 #include <vector>
 
+#include "settings.h" // PlayerMax
 #include "upgrade_structs.h" // MaxCost
 #include "vec2i.h"
 
@@ -193,6 +195,8 @@ class AiForce
 // forces
 #define AI_MAX_FORCES 50                           /// How many forces are supported
 #define AI_MAX_FORCE_INTERNAL (AI_MAX_FORCES / 2)  /// The forces after AI_MAX_FORCE_INTERNAL are for internal use
+#define AI_MAX_FORCE_PATHING 2                     /// Map searches of the forces each second, to reduce load
+#define AI_TASK_BUDGET 256                         /// Cost of the AI tasks run by a player each cycle
 
 /**
 **  AI force manager.
@@ -230,7 +234,7 @@ class AiForceManager
 	std::optional<int> GetForce(const CUnit &unit);
 	void RemoveDeadUnit();
 	bool Assign(CUnit &unit, int force = -1);
-	void Update();
+	bool UpdateForce(unsigned int index, int &maxPathing);
 	unsigned int FindFreeForce(AiForceRole role = AiForceRole::Default, int begin = 0);
 	void CheckUnits(std::array<int, UnitTypeMax> &counter);
 
@@ -270,6 +274,20 @@ class AiExplorationRequest
 	int Mask;           /// mask ( ex: MapFieldLandUnit )
 };
 
+/**
+**  Tasks of the AI each second, run in this order over the next cycles.
+*/
+enum class AiTask {
+	Script,          /// Advance the script
+	CheckUnits,      /// Look if everything is fine
+	Resources,       /// Resource manager
+	Forces,          /// Update of the forces, one each step
+	AssignFreeUnits, /// Assign the free units to the forces
+	Magic,           /// Check for magic actions
+	Explorers,       /// Send explorers
+	Done             /// All the tasks of the second are done
+};
+
 /**
 **  AI variables.
 */
@@ -305,6 +323,9 @@ class PlayerAi
 	std::vector<CUpgrade *> ResearchRequests;     /// Upgrades requested and priority list
 	std::vector<AiBuildQueue> UnitTypeBuilt;      /// What the resource manager should build
 	int LastRepairBuilding = 0;                   /// Last building checked for repair in this turn
+	AiTask NextTask = AiTask::Done;               /// Next task of the current second
+	unsigned int NextForce = 0;                   /// Next force to update in this second
+	int ForcePathing = 0;                         /// Map searches left for the forces in this second
 };
 
 /**
@@ -437,9 +458,6 @@ extern void AiAttackWithForce(unsigned int force);
 /// Attack with forces in array
 extern void AiAttackWithForces(int *forces);
 
-/// Periodic called force manager handler
-extern void AiForceManager();
-
 //
 // Plans
 //
@@ -458,6 +476,65 @@ extern bool AiEnemyUnitsInDistance(const CPlayer &player, const CUnitType *type,
 /// Check for magic
 extern void AiCheckMagic();
 
+//
+// Tasks
+//
+/// Cost of the next task of an AI player, about the number of units processed
+extern int AiNextTaskCost(const PlayerAi &ai);
+
+/**
+**  Run the next tasks of an AI player, until their cost reaches the
+**  budget of a cycle.
+**
+**  The costs only depend on the game state, so all the clients split the
+**  tasks the same way. At least one task is run, so a second always ends.
+**
+**  @param ai       The AI player.
+**  @param runTask  Runs the next task of the AI player.
+*/
+template <typename RunTask>
+void AiRunTasks(PlayerAi &ai, RunTask runTask)
+{
+	int budget = AI_TASK_BUDGET;
+
+	while (ai.NextTask != AiTask::Done && budget > 0) {
+		budget -= AiNextTaskCost(ai);
+		runTask();
+	}
+}
+
+//
+// Influence map
+//
+/// Number of tiles on each side of the cells of the influence map
+constexpr int AiInfluenceCellSize = 8;
+
+/**
+**  Units of some players in cells of the influence map.
+**
+**  Threat and Attackers are indexed by the EMovement of the units
+**  which can be attacked. The dying units are counted in Units and
+**  Attackers, but have no strength.
+*/
+struct AiInfluence {
+	int Units = 0;           /// Number of units
+	int Strength = 0;        /// Damage of the units which can attack
+	int Threat[3]{};         /// Damage against each movement type
+	int Attackers[3]{};      /// Number of units which can attack each movement type
+};
+
+/// Forget all the units of the influence map
+extern void AiCleanInfluence();
+/// Players whose units the player attacks
+extern std::bitset<PlayerMax> AiInfluenceEnemies(const CPlayer &player);
+/// Players whose units attack the player
+extern std::bitset<PlayerMax> AiInfluenceHostiles(const CPlayer &player);
+/// Sum the influence of players on the cells covering an area
+extern AiInfluence AiGetInfluence(const std::bitset<PlayerMax> &players, const Vec2i &topLeft,
+								  const Vec2i &bottomRight);
+/// Find the cell where players are the strongest
+extern bool AiFindInfluence(const std::bitset<PlayerMax> &players, Vec2i *pos);
+
 //@}
 
 #endif // !__AI_LOCAL_H__
@@ -203,12 +203,26 @@ bool AiEnemyUnitsInDistance(const CPlayer &player,
 						    const CUnitType *type, const Vec2i &pos, unsigned range)
 {
 	const Vec2i offset(range, range);
+	const Vec2i typeSize = type ? Vec2i(type->TileWidth - 1, type->TileHeight - 1) : Vec2i(0, 0);
+
+	// Nothing to look for if the influence map has no such enemy around.
+	const AiInfluence influence = AiGetInfluence(AiInfluenceHostiles(player), pos - offset, pos + typeSize + offset);
+	if (type == nullptr) {
+		if (influence.Units == 0) {
+			return false;
+		}
+	} else if (type->MoveType == EMovement::Land && type->BoolFlag[SHOREBUILDING_INDEX].value) {
+		if (influence.Attackers[int(EMovement::Land)] + influence.Attackers[int(EMovement::Naval)] == 0) {
+			return false;
+		}
+	} else if (influence.Attackers[int(type->MoveType)] == 0) {
+		return false;
+	}
 
 	if (type == nullptr) {
 		std::vector<CUnit *> units = Select<1>(pos - offset, pos + offset, IsAEnemyUnitOf<true>(player));
 		return !units.empty();
 	} else {
-		const Vec2i typeSize(type->TileWidth - 1, type->TileHeight - 1);
 		const IsAEnemyUnitWhichCanCounterAttackOf<true> pred(player, *type);
 
 		std::vector<CUnit *> units = Select<1>(pos - offset, pos + typeSize + offset, pred);
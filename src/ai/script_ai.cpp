@@ -1449,6 +1449,83 @@ static int CclAiSetCollect(lua_State *l)
 	return 0;
 }
 
+/**
+** <b>Description</b>
+**
+**  Get the units around a tile on the influence map, for the current AI player.
+**
+**  @param l  Lua state.
+**
+**  @return   Table with the number and strength of the own units and of
+**            the enemy units, and the threat of the enemies against each
+**            movement type.
+**
+** Example:
+**
+** <div class="example"><code>local influence = <strong>AiGetInfluence</strong>(40, 32, 8)
+**	if influence.LandThreat > influence.Strength then
+**		-- don't send the peasants there
+**	end</code></div>
+*/
+static int CclAiGetInfluence(lua_State *l)
+{
+	const int args = lua_gettop(l);
+	if (args != 2 && args != 3) {
+		LuaError(l, "incorrect argument");
+	}
+	const Vec2i pos(LuaToNumber(l, 1), LuaToNumber(l, 2));
+	const int range = args == 3 ? LuaToNumber(l, 3) : 0;
+	const Vec2i offset(range, range);
+	const CPlayer &player = *AiPlayer->Player;
+
+	std::bitset<PlayerMax> own;
+	own.set(player.Index);
+	const AiInfluence ownInfluence = AiGetInfluence(own, pos - offset, pos + offset);
+	const AiInfluence enemyInfluence = AiGetInfluence(AiInfluenceEnemies(player), pos - offset, pos + offset);
+
+	lua_newtable(l);
+	const auto setField = [l](const char *name, int value) {
+		lua_pushnumber(l, value);
+		lua_setfield(l, -2, name);
+	};
+	setField("Units", ownInfluence.Units);
+	setField("Strength", ownInfluence.Strength);
+	setField("EnemyUnits", enemyInfluence.Units);
+	setField("EnemyStrength", enemyInfluence.Strength);
+	setField("LandThreat", enemyInfluence.Threat[int(EMovement::Land)]);
+	setField("AirThreat", enemyInfluence.Threat[int(EMovement::Fly)]);
+	setField("NavalThreat", enemyInfluence.Threat[int(EMovement::Naval)]);
+	return 1;
+}
+
+/**
+** <b>Description</b>
+**
+**  Find where the enemies of the current AI player are the strongest.
+**
+**  @param l  Lua state.
+**
+**  @return   x and y of the center of the cell, nothing if no enemy is on the map.
+**
+** Example:
+**
+** <div class="example"><code>local x, y = <strong>AiFindEnemyInfluence</strong>()
+**	if x and AiGetInfluence(x, y, 8).EnemyStrength > AiGetInfluence(x, y, 8).Strength then
+**		-- the enemies gather there
+**	end</code></div>
+*/
+static int CclAiFindEnemyInfluence(lua_State *l)
+{
+	LuaCheckArgs(l, 0);
+	Vec2i pos;
+	if (!AiFindInfluence(AiInfluenceEnemies(*AiPlayer->Player), &pos)) {
+		return 0;
+	}
+	lua_pushnumber(l, pos.x);
+	lua_pushnumber(l, pos.y);
+	return 2;
+}
+
 /**
 **  Set AI player build.
 **
@@ -1835,6 +1912,16 @@ static int CclDefineAiPlayer(lua_State *l)
 			CclParseBuildQueue(l, ai, j + 1);
 		} else if (value == "repair-building") {
 			ai.LastRepairBuilding = LuaToNumber(l, j + 1);
+		} else if (value == "task") {
+			const int task = LuaToNumber(l, j + 1);
+			if (task < 0 || task > static_cast<int>(AiTask::Done)) {
+				LuaError(l, "incorrect task: %d", task);
+			}
+			ai.NextTask = AiTask(task);
+		} else if (value == "next-force") {
+			ai.NextForce = LuaToNumber(l, j + 1);
+		} else if (value == "force-pathing") {
+			ai.ForcePathing = LuaToNumber(l, j + 1);
 		} else {
 			LuaError(l, "Unsupported tag: %s", value.data());
 		}
@@ -1976,6 +2063,8 @@ void AiCclRegister()
 	lua_register(Lua, "AiSetCollect", CclAiSetCollect);
 
 	lua_register(Lua, "AiSetBuildDepots", CclAiSetBuildDepots);
+	lua_register(Lua, "AiGetInfluence", CclAiGetInfluence);
+	lua_register(Lua, "AiFindEnemyInfluence", CclAiFindEnemyInfluence);
 
 	lua_register(Lua, "AiDump", CclAiDump);
 
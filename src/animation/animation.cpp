@@ -155,28 +155,32 @@ int UnitShowAnimation(CUnit &unit, const std::vector<std::unique_ptr<CAnimation>
 }
 
 /**
-**  Parse player number in animation frame
-**
-**  @param unit      Unit of the animation.
-**  @param parseint  Integer to parse.
-**
-**  @return  The parsed value.
+**  Report a bad operand in an animation definition.
 */
-
-static int ParseAnimPlayer(const CUnit &unit, std::string_view parseint)
+static void AnimIntError(lua_State *l, const std::string &message)
 {
-	if (parseint == "this") {
-		return unit.Player->Index;
+	if (l) {
+		LuaError(l, "%s", message.c_str());
 	}
-	return ParseAnimInt(unit, parseint);
+	ErrorPrint("%s\n", message.c_str());
+	ExitFatal(1);
 }
 
+/**
+**  Parse a number of an animation operand.
+*/
+static int ParseAnimNumber(std::string_view s, lua_State *l)
+{
+	if (s.empty() || !(isdigit(s[0]) || s[0] == '-')) {
+		AnimIntError(l, "Bad number '" + std::string(s) + "' in animation");
+	}
+	return to_number(s);
+}
 
 /**
 **  Parse integer in animation frame.
 **
-**  @param unit      Unit of the animation.
-**  @param s         Integer to parse.
+**  @param s  Integer to parse.
 **         either:
 **           - v.UnitVar.Value // own value
 **           - t.UnitVar.Value // target value
@@ -196,142 +200,227 @@ static int ParseAnimPlayer(const CUnit &unit, std::string_view parseint)
 **           - R // unit rotation
 **           - W // remaining way
 **           - number
-**
-**  @return  The parsed value.
+**  @param l  Lua state, to report the errors (may be null).
 */
-int ParseAnimInt(const CUnit &unit, const std::string_view s)
+CAnimInt::CAnimInt(std::string_view s, lua_State *l)
 {
-	const CUnit *goal = &unit;
-
 	if (s.empty()) {
-		return 0;
+		return;
+	}
+	if ((s[0] == 'v' || s[0] == 't' || s[0] == 'b' || s[0] == 'g' || s[0] == 's' || s[0] == 'S'
+	     || s[0] == 'p' || s[0] == 'r' || s[0] == 'l') && (s.size() < 3 || s[1] != '.')) {
+		AnimIntError(l, "Bad animation operand '" + std::string(s) + "'");
 	}
 	if (s[0] == 'v' || s[0] == 't') { //unit variable detected
-		if (s[0] == 't') {
-			if (unit.CurrentOrder()->HasGoal()) {
-				goal = unit.CurrentOrder()->GetGoal();
-			} else if (unit.CurrentOrder()->Action == UnitAction::Build) {
-				goal = static_cast<const COrder_Build *>(unit.CurrentOrder())->GetBuildingUnit();
-			} else {
-				return 0;
-			}
-		}
-		auto dot_pos = s.find('.', 2);
+		OnGoal = s[0] == 't';
+		const auto dot_pos = s.find('.', 2);
 		if (dot_pos == std::string_view::npos) {
-			ErrorPrint("Need also specify the variable '%s' tag \n", s.substr(2).data());
-			ExitFatal(1);
+			AnimIntError(l, "Need also specify the variable '" + std::string(s.substr(2)) + "' tag");
 		}
-		auto cur = s.substr(2, dot_pos - 2);
-		auto next = s.substr(dot_pos + 1);
-		const int index = UnitTypeVar.VariableNameLookup[cur];// User variables
-		if (index == -1) {
+		const auto cur = s.substr(2, dot_pos - 2);
+		const auto next = s.substr(dot_pos + 1);
+		Index = UnitTypeVar.VariableNameLookup[cur];// User variables
+		if (Index == -1) {
 			if (cur == "ResourcesHeld") {
-				return goal->ResourcesHeld;
+				Kind = EKind::ResourcesHeld;
 			} else if (cur == "ResourceActive") {
-				return goal->Resource.Active;
+				Kind = EKind::ResourceActive;
 			} else if (cur == "_Distance") {
-				return unit.MapDistanceTo(*goal);
+				Kind = EKind::Distance;
+			} else {
+				AnimIntError(l, "Bad variable name '" + std::string(cur) + "'");
 			}
-			ErrorPrint("Bad variable name '%s'\n", cur.data());
-			ExitFatal(1);
+			return;
 		}
+		Kind = EKind::Variable;
 		if (next == "Value") {
-			return goal->Variable[index].Value;
+			Field = EField::Value;
 		} else if (next == "Max") {
-			return goal->Variable[index].Max;
+			Field = EField::Max;
 		} else if (next == "Increase") {
-			return goal->Variable[index].Increase;
+			Field = EField::Increase;
 		} else if (next == "Enable") {
-			return goal->Variable[index].Enable;
+			Field = EField::Enable;
 		} else if (next == "Percent") {
-			return goal->Variable[index].Value * 100 / goal->Variable[index].Max;
+			Field = EField::Percent;
+		} else {
+			AnimIntError(l, "Bad variable tag '" + std::string(next) + "'");
 		}
-		return 0;
 	} else if (s[0] == 'b' || s[0] == 'g') { //unit bool flag detected
-		if (s[0] == 'g') {
-			if (unit.CurrentOrder()->HasGoal()) {
-				goal = unit.CurrentOrder()->GetGoal();
-			} else {
-				return 0;
-			}
-		}
-		auto cur = s.substr(2);
-		const int index = UnitTypeVar.BoolFlagNameLookup[cur]; // User bool flags
-		if (index == -1) {
-			ErrorPrint("Bad bool-flag name '%s'\n", cur.data());
-			ExitFatal(1);
+		OnGoal = s[0] == 'g';
+		const auto cur = s.substr(2);
+		Kind = EKind::BoolFlag;
+		Index = UnitTypeVar.BoolFlagNameLookup[cur]; // User bool flags
+		if (Index == -1) {
+			AnimIntError(l, "Bad bool-flag name '" + std::string(cur) + "'");
 		}
-		return goal->Type->BoolFlag[index].value;
 	} else if (s[0] == 's') { //spell type detected
-		Assert(goal->CurrentAction() == UnitAction::SpellCast);
-		const COrder_SpellCast &order = *static_cast<COrder_SpellCast *>(goal->CurrentOrder());
-		const SpellType &spell = order.GetSpell();
-		if (spell.Ident == s.substr(2)) {
-			return 1;
-		}
-		return 0;
+		// spells may be defined after the animations
+		Kind = EKind::Spell;
+		Name = s.substr(2);
 	} else if (s[0] == 'S') { // check if autocast for this spell available
-		auto cur = s.substr(2);
-		const SpellType &spell = SpellTypeByIdent(cur);
-		if (unit.AutoCastSpell[spell.Slot]) {
-			return 1;
-		}
-		return 0;
+		Kind = EKind::AutoCast;
+		Name = s.substr(2);
 	} else if (s[0] == 'p') { //player variable detected
 		auto cur = s.substr(2);
 		std::string_view next;
 		if (cur[0] == '(') {
 			cur = cur.substr(1);
-			auto parent_pos = cur.find(')');
+			const auto parent_pos = cur.find(')');
 			if (parent_pos == std::string_view::npos) {
-				ErrorPrint("ParseAnimInt: expected ')'\n");
-				ExitFatal(1);
+				AnimIntError(l, "Expected ')' in '" + std::string(s) + "'");
 			}
 			next = cur.substr(parent_pos + 1);
 			cur = cur.substr(0, parent_pos);
 		} else {
-			auto dot_pos = cur.find('.');
+			const auto dot_pos = cur.find('.');
 
 			if (dot_pos == std::string_view::npos) {
-				ErrorPrint("Need also specify the %s player's property\n", cur.data());
-				ExitFatal(1);
-			} else {
-				next = cur.substr(dot_pos + 1);
-				cur = cur.substr(0, dot_pos);
+				AnimIntError(l, "Need also specify the " + std::string(cur) + " player's property");
 			}
+			next = cur.substr(dot_pos + 1);
+			cur = cur.substr(0, dot_pos);
+		}
+		const auto dot_pos = next.find('.');
+		Kind = EKind::PlayerData;
+		Arg = dot_pos == std::string_view::npos ? "" : next.substr(dot_pos + 1);
+		Name = next.substr(0, dot_pos);
+		if (cur != "this") {
+			PlayerOperand = std::make_unique<CAnimInt>(cur, l);
 		}
-		auto dot_pos = next.find('.');
-		auto arg = dot_pos == std::string_view::npos ? "" : next.substr(dot_pos + 1);
-		next = next.substr(0, dot_pos);
-		return GetPlayerData(ParseAnimPlayer(unit, cur), next, arg);
 	} else if (s[0] == 'r') { //random value
-		auto cur = s.substr(2);
-		auto dot_pos = cur.find('.');
+		const auto cur = s.substr(2);
+		const auto dot_pos = cur.find('.');
 
+		Kind = EKind::Random;
 		if (dot_pos == std::string_view::npos) {
-			return SyncRand(to_number(cur) + 1);
+			Max = ParseAnimNumber(cur, l);
 		} else {
-			const int min = to_number(cur);
-			return min + SyncRand(to_number(cur.substr(dot_pos + 1)) - min + 1);
+			Index = ParseAnimNumber(cur.substr(0, dot_pos), l);
+			Max = ParseAnimNumber(cur.substr(dot_pos + 1), l);
 		}
 	} else if (s[0] == 'l') { //player number
-		return ParseAnimPlayer(unit, s.substr(2));
+		Kind = EKind::Player;
+		if (s.substr(2) != "this") {
+			PlayerOperand = std::make_unique<CAnimInt>(s.substr(2), l);
+		}
 	} else if (s[0] == 'U') { //unit itself
-		return UnitNumber(unit);
+		Kind = EKind::UnitSelf;
 	} else if (s[0] == 'G') { //goal
-		if (unit.CurrentOrder()->HasGoal()) {
-			return UnitNumber(*unit.CurrentOrder()->GetGoal());
-		} else {
-			return 0;
-		}
+		Kind = EKind::Goal;
 	} else if (s[0] == 'R') { //pending rotational value
-		return unit.Anim.Rotate;
+		Kind = EKind::Rotate;
 	} else if (s[0] == 'W') { //remaining way
-		return unit.pathFinderData->output.Length + 1 + unit.pathFinderData->output.OverflowLength;
+		Kind = EKind::RemainingWay;
+	} else {
+		Kind = EKind::Number;
+		Index = ParseAnimNumber(s, l);
 	}
-	// Check if we trying to parse a number
-	Assert(isdigit(s[0]) || s[0] == '-');
-	return to_number(s);
+}
+
+/**
+**  Get the unit whose variables are read.
+**
+**  @return  The unit, its goal, or null if it has no goal.
+*/
+const CUnit *CAnimInt::GetUnit(const CUnit &unit) const
+{
+	if (!OnGoal) {
+		return &unit;
+	}
+	if (unit.CurrentOrder()->HasGoal()) {
+		return unit.CurrentOrder()->GetGoal();
+	} else if (Kind != EKind::BoolFlag && unit.CurrentOrder()->Action == UnitAction::Build) {
+		return static_cast<const COrder_Build *>(unit.CurrentOrder())->GetBuildingUnit();
+	}
+	return nullptr;
+}
+
+/**
+**  Get the player of PlayerData and Player.
+*/
+int CAnimInt::GetPlayer(const CUnit &unit) const
+{
+	return PlayerOperand ? PlayerOperand->Eval(unit) : unit.Player->Index;
+}
+
+/**
+**  Evaluate the operand.
+**
+**  @param unit  Unit of the animation.
+**
+**  @return  The value.
+*/
+int CAnimInt::Eval(const CUnit &unit) const
+{
+	switch (Kind) {
+		case EKind::Zero:
+			return 0;
+		case EKind::Number:
+			return Index;
+		case EKind::Variable: {
+			const CUnit *goal = GetUnit(unit);
+			if (goal == nullptr) {
+				return 0;
+			}
+			const CVariable &variable = goal->Variable[Index];
+			switch (Field) {
+				case EField::Value: return variable.Value;
+				case EField::Max: return variable.Max;
+				case EField::Increase: return variable.Increase;
+				case EField::Enable: return variable.Enable;
+				case EField::Percent: return variable.Value * 100 / variable.Max;
+			}
+			return 0;
+		}
+		case EKind::ResourcesHeld: {
+			const CUnit *goal = GetUnit(unit);
+			return goal ? goal->ResourcesHeld : 0;
+		}
+		case EKind::ResourceActive: {
+			const CUnit *goal = GetUnit(unit);
+			return goal ? goal->Resource.Active : 0;
+		}
+		case EKind::Distance: {
+			const CUnit *goal = GetUnit(unit);
+			return goal ? unit.MapDistanceTo(*goal) : 0;
+		}
+		case EKind::BoolFlag: {
+			const CUnit *goal = GetUnit(unit);
+			return goal ? goal->Type->BoolFlag[Index].value : 0;
+		}
+		case EKind::Spell: {
+			Assert(unit.CurrentAction() == UnitAction::SpellCast);
+			const COrder_SpellCast &order = *static_cast<COrder_SpellCast *>(unit.CurrentOrder());
+			return order.GetSpell().Ident == Name;
+		}
+		case EKind::AutoCast:
+			return unit.AutoCastSpell[SpellTypeByIdent(Name).Slot];
+		case EKind::PlayerData:
+			return GetPlayerData(GetPlayer(unit), Name, Arg);
+		case EKind::Player:
+			return GetPlayer(unit);
+		case EKind::Random:
+			return Index + SyncRand(Max - Index + 1);
+		case EKind::UnitSelf:
+			return UnitNumber(unit);
+		case EKind::Goal:
+			return unit.CurrentOrder()->HasGoal() ? UnitNumber(*unit.CurrentOrder()->GetGoal()) : 0;
+		case EKind::Rotate:
+			return unit.Anim.Rotate;
+		case EKind::RemainingWay:
+			return unit.pathFinderData->output.Length + 1 + unit.pathFinderData->output.OverflowLength;
+	}
+	return 0;
+}
+
+/**
+**  Get the value of a number operand, used when there is no unit.
+*/
+int CAnimInt::GetNumber() const
+{
+	Assert(Kind == EKind::Number || Kind == EKind::Zero);
+	return Index;
 }
 
 /**
@@ -43,26 +43,17 @@ void CAnimation_ExactFrame::Action(CUnit &unit, int & /*move*/, int /*scale*/) c
 {
 	Assert(unit.Anim.CurrAnim);
 	Assert((*unit.Anim.CurrAnim)[unit.Anim.Anim].get() == this);
-	unit.Frame = ParseAnimInt(&unit);
+	unit.Frame = this->frame.Eval(unit);
 }
 
-void CAnimation_ExactFrame::Init(std::string_view s, lua_State *) /* override */
+void CAnimation_ExactFrame::Init(std::string_view s, lua_State *l) /* override */
 {
-	this->frame = s;
+	this->frame = CAnimInt(s, l);
 }
 
 std::optional<int> CAnimation_ExactFrame::GetStillFrame(const CUnitType &type) /* override */
 {
-	return ParseAnimInt(nullptr) + type.NumDirections / 2;
-}
-
-int CAnimation_ExactFrame::ParseAnimInt(const CUnit *unit) const
-{
-	if (unit == nullptr) {
-		return to_number(this->frame);
-	} else {
-		return ::ParseAnimInt(*unit, this->frame);
-	}
+	return this->frame.GetNumber() + type.NumDirections / 2;
 }
 
 //@}
@@ -46,28 +46,19 @@ void CAnimation_Frame::Action(CUnit &unit, int &/*move*/, int /*scale*/) const /
 	Assert((*unit.Anim.CurrAnim)[unit.Anim.Anim].get() == this);
 	if (unit.Type->Building && unit.Type->NumDirections == 1 && FancyBuildings && unit.Type->BoolFlag[NORANDOMPLACING_INDEX].value == false && unit.Frame < 0) {
 	} else {
-		unit.Frame = ParseAnimInt(&unit);
+		unit.Frame = this->frame.Eval(unit);
 	}
 	UnitUpdateHeading(unit);
 }
 
-void CAnimation_Frame::Init(std::string_view s, lua_State *) /* override */
+void CAnimation_Frame::Init(std::string_view s, lua_State *l) /* override */
 {
-	this->frame = s;
+	this->frame = CAnimInt(s, l);
 }
 
 std::optional<int> CAnimation_Frame::GetStillFrame(const CUnitType &type) /* override */
 {
-	return ParseAnimInt(nullptr) + type.NumDirections / 2;
-}
-
-int CAnimation_Frame::ParseAnimInt(const CUnit *unit) const
-{
-	if (unit == nullptr) {
-		return to_number(this->frame);
-	} else {
-		return ::ParseAnimInt(*unit, this->frame);
-	}
+	return this->frame.GetNumber() + type.NumDirections / 2;
 }
 
 //@}
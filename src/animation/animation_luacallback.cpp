@@ -40,6 +40,7 @@
 #include "script.h"
 #include "unit.h"
 
+#include <algorithm>
 #include <iterator>
 #include <sstream>
 
@@ -50,8 +51,8 @@ void CAnimation_LuaCallback::Action(CUnit &unit, int & /*move*/, int /*scale*/)
 	Assert(cb);
 
 	cb.pushPreamble();
-	for (const std::string &str : cbArgs) {
-		const int arg = ParseAnimInt(unit, str);
+	for (const CAnimInt &cbArg : cbArgs) {
+		const int arg = cbArg.Eval(unit);
 		cb.pushInteger(arg);
 	}
 	cb.run();
@@ -74,9 +75,9 @@ void CAnimation_LuaCallback::Init(std::string_view s, lua_State *l) /* override
 	}
 
 	std::istringstream iss{std::string(s.substr(space_pos + 1))};
-	std::copy(std::istream_iterator<std::string>(iss),
-	          std::istream_iterator<std::string>(),
-	          std::back_inserter(this->cbArgs));
+	std::for_each(std::istream_iterator<std::string>(iss),
+	              std::istream_iterator<std::string>(),
+	              [&](const std::string &arg) { this->cbArgs.emplace_back(arg, l); });
 }
 
 //@}
@@ -45,12 +45,12 @@ void CAnimation_Move::Action(CUnit &unit, int &move, int /*scale*/) const /* ove
 	Assert((*unit.Anim.CurrAnim)[unit.Anim.Anim].get() == this);
 	Assert(!move);
 
-	move = ParseAnimInt(unit, this->moveStr);
+	move = this->moveValue.Eval(unit);
 }
 
-void CAnimation_Move::Init(std::string_view s, lua_State *) /* override */
+void CAnimation_Move::Init(std::string_view s, lua_State *l) /* override */
 {
-	this->moveStr = s;
+	this->moveValue = CAnimInt(s, l);
 }
 
 //@}
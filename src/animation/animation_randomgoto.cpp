@@ -46,7 +46,7 @@ void CAnimation_RandomGoto::Action(CUnit &unit, int & /*move*/, int /*scale*/) c
 	Assert(unit.Anim.CurrAnim);
 	Assert((*unit.Anim.CurrAnim)[unit.Anim.Anim].get() == this);
 
-	if (SyncRand() % 100 < ParseAnimInt(unit, this->randomStr)) {
+	if (SyncRand() % 100 < this->random.Eval(unit)) {
 		unit.Anim.Anim = this->gotoLabel;
 	}
 }
@@ -54,11 +54,13 @@ void CAnimation_RandomGoto::Action(CUnit &unit, int & /*move*/, int /*scale*/) c
 /*
 **  s : "percent label"
 */
-void CAnimation_RandomGoto::Init(std::string_view s, lua_State *) /* override */
+void CAnimation_RandomGoto::Init(std::string_view s, lua_State *l) /* override */
 {
 	std::istringstream is{std::string(s)};
+	std::string randomStr;
 	std::string label;
-	is >> this->randomStr >> label;
+	is >> randomStr >> label;
+	this->random = CAnimInt(randomStr, l);
 
 	FindLabelLater(&this->gotoLabel, std::move(label));
 }
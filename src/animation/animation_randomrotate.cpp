@@ -48,15 +48,15 @@ void CAnimation_RandomRotate::Action(CUnit &unit,
 	Assert((*unit.Anim.CurrAnim)[unit.Anim.Anim].get() == this);
 
 	if ((SyncRand() >> 8) & 1) {
-		UnitRotate(unit, -ParseAnimInt(unit, this->rotateStr));
+		UnitRotate(unit, -this->rotate.Eval(unit));
 	} else {
-		UnitRotate(unit, ParseAnimInt(unit, this->rotateStr));
+		UnitRotate(unit, this->rotate.Eval(unit));
 	}
 }
 
-void CAnimation_RandomRotate::Init(std::string_view s, lua_State *) /* override */
+void CAnimation_RandomRotate::Init(std::string_view s, lua_State *l) /* override */
 {
-	this->rotateStr = s;
+	this->rotate = CAnimInt(s, l);
 }
 
 //@}
@@ -46,8 +46,8 @@ void CAnimation_RandomWait::Action(CUnit &unit, int & /*move*/, int /*scale*/) c
 	Assert(unit.Anim.CurrAnim);
 	Assert((*unit.Anim.CurrAnim)[unit.Anim.Anim].get() == this);
 
-	const int arg1 = ParseAnimInt(unit, this->minWait);
-	const int arg2 = ParseAnimInt(unit, this->maxWait);
+	const int arg1 = this->minWait.Eval(unit);
+	const int arg2 = this->maxWait.Eval(unit);
 
 	unit.Anim.Wait = arg1 + SyncRand() % (arg2 - arg1 + 1);
 }
@@ -55,11 +55,15 @@ void CAnimation_RandomWait::Action(CUnit &unit, int & /*move*/, int /*scale*/) c
 /*
 ** s = "minWait MaxWait"
 */
-void CAnimation_RandomWait::Init(std::string_view s, lua_State *) /* override */
+void CAnimation_RandomWait::Init(std::string_view s, lua_State *l) /* override */
 {
 	std::istringstream is{std::string(s)};
+	std::string minWaitStr;
+	std::string maxWaitStr;
 
-	is >> this->minWait >> this->maxWait;
+	is >> minWaitStr >> maxWaitStr;
+	this->minWait = CAnimInt(minWaitStr, l);
+	this->maxWait = CAnimInt(maxWaitStr, l);
 }
 
 //@}
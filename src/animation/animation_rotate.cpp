@@ -59,7 +59,7 @@ void CAnimation_Rotate::Action(CUnit &unit, int & /*move*/, int /*scale*/) const
 	Assert(unit.Anim.CurrAnim);
 	Assert((*unit.Anim.CurrAnim)[unit.Anim.Anim].get() == this);
 
-	if (this->rotateStr == "target") {
+	if (this->toTarget) {
 		COrder *order = unit.CurrentOrder();
 		CUnit *target;
 		if (order->HasGoal()) {
@@ -79,13 +79,17 @@ void CAnimation_Rotate::Action(CUnit &unit, int & /*move*/, int /*scale*/) const
 		dpos.y += doff.y / PixelTileSize.y;
 		UnitHeadingFromDeltaXY(unit, dpos);
 	} else {
-		UnitRotate(unit, ParseAnimInt(unit, this->rotateStr));
+		UnitRotate(unit, this->rotate.Eval(unit));
 	}
 }
 
-void CAnimation_Rotate::Init(std::string_view s, lua_State *) /* override */
+void CAnimation_Rotate::Init(std::string_view s, lua_State *l) /* override */
 {
-	this->rotateStr = s;
+	if (s == "target") {
+		this->toTarget = true;
+	} else {
+		this->rotate = CAnimInt(s, l);
+	}
 }
 
 //@}
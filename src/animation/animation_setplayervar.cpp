@@ -185,8 +185,8 @@ void CAnimation_SetPlayerVar::Action(CUnit &unit,
 	Assert(unit.Anim.CurrAnim);
 	Assert((*unit.Anim.CurrAnim)[unit.Anim.Anim].get() == this);
 
-	const int playerId = ParseAnimInt(unit, this->playerStr);
-	const int rop = ParseAnimInt(unit, this->valueStr);
+	const int playerId = this->player.Eval(unit);
+	const int rop = this->value.Eval(unit);
 	int data = GetPlayerData(playerId, this->varStr, this->argStr);
 
 	modifyValue(this->mod, data, rop);
@@ -196,13 +196,17 @@ void CAnimation_SetPlayerVar::Action(CUnit &unit,
 /*
 **  s = "player var mod value [arg2]"
 */
-void CAnimation_SetPlayerVar::Init(std::string_view s, lua_State *) /* override */
+void CAnimation_SetPlayerVar::Init(std::string_view s, lua_State *l) /* override */
 {
 	std::istringstream is{std::string(s)};
 
+	std::string playerStr;
 	std::string modStr;
-	is >> this->playerStr >> this->varStr >> modStr >> this->valueStr >> this->argStr;
+	std::string valueStr;
+	is >> playerStr >> this->varStr >> modStr >> valueStr >> this->argStr;
+	this->player = CAnimInt(playerStr, l);
 	this->mod = toSetVar_ModifyTypes(modStr);
+	this->value = CAnimInt(valueStr, l);
 }
 
 //@}
@@ -92,7 +92,7 @@ void CAnimation_SetVar::Action(CUnit &unit, int & /*move*/, int /*scale*/) const
 		return;
 	}
 
-	const int rop = ParseAnimInt(unit, this->valueStr);
+	const int rop = this->value.Eval(unit);
 	const auto next = std::string_view{this->varStr.c_str() + dot_pos + 1};
 	int value = 0;
 	if (next == "Value") {
@@ -128,13 +128,16 @@ void CAnimation_SetVar::Action(CUnit &unit, int & /*move*/, int /*scale*/) const
 /*
 **  s = "var mod value [unitSlot]"
 */
-void CAnimation_SetVar::Init(std::string_view s, lua_State *) /* override */
+void CAnimation_SetVar::Init(std::string_view s, lua_State *l) /* override */
 {
 	std::istringstream is{std::string(s)};
 
 	std::string modStr;
 	is >> this->varStr >> modStr >> this->valueStr >> this->unitSlotStr;
 	this->mod = toSetVar_ModifyTypes(modStr);
+	if (this->varStr.find('.') != std::string::npos) {
+		this->value = CAnimInt(this->valueStr, l);
+	}
 }
 
 //@}
@@ -103,12 +103,12 @@ void CAnimation_SpawnMissile::Action(CUnit &unit, int &/*move*/, int /*scale*/)
 	Assert(unit.Anim.CurrAnim);
 	Assert((*unit.Anim.CurrAnim)[unit.Anim.Anim].get() == this);
 
-	const int startx = ParseAnimInt(unit, this->startXStr);
-	const int starty = ParseAnimInt(unit, this->startYStr);
-	const int destx = ParseAnimInt(unit, this->destXStr);
-	const int desty = ParseAnimInt(unit, this->destYStr);
+	const int startx = this->startX.Eval(unit);
+	const int starty = this->startY.Eval(unit);
+	const int destx = this->destX.Eval(unit);
+	const int desty = this->destY.Eval(unit);
 	const SpawnMissile_Flags flags = ParseAnimFlags(this->flagsStr);
-	const int offsetnum = ParseAnimInt(unit, this->offsetNumStr);
+	const int offsetnum = this->offsetNum.Eval(unit);
 	const CUnit *goal = flags & SM_RelTarget ? unit.CurrentOrder()->GetGoal() : &unit;
 	if (!goal || goal->Destroyed) {
 		return;
@@ -197,12 +197,22 @@ void CAnimation_SpawnMissile::Action(CUnit &unit, int &/*move*/, int /*scale*/)
 /*
 **  s = "missileType startX startY destX destY [flag1[.flagN]] [missileoffset]"
 */
-void CAnimation_SpawnMissile::Init(std::string_view s, lua_State *) /* override */
+void CAnimation_SpawnMissile::Init(std::string_view s, lua_State *l) /* override */
 {
 	std::istringstream is{std::string(s)};
-
-	is >> this->missileTypeStr >> this->startXStr >> this->startYStr >> this->destXStr
-		>> this->destYStr >> this->flagsStr >> this->offsetNumStr;
+	std::string startXStr;
+	std::string startYStr;
+	std::string destXStr;
+	std::string destYStr;
+	std::string offsetNumStr;
+
+	is >> this->missileTypeStr >> startXStr >> startYStr >> destXStr >> destYStr
+		>> this->flagsStr >> offsetNumStr;
+	this->startX = CAnimInt(startXStr, l);
+	this->startY = CAnimInt(startYStr, l);
+	this->destX = CAnimInt(destXStr, l);
+	this->destY = CAnimInt(destYStr, l);
+	this->offsetNum = CAnimInt(offsetNumStr, l);
 }
 
 //@}
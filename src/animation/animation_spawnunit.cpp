@@ -86,10 +86,10 @@ void CAnimation_SpawnUnit::Action(CUnit &unit, int & /*move*/, int /*scale*/) co
 	Assert(unit.Anim.CurrAnim);
 	Assert((*unit.Anim.CurrAnim)[unit.Anim.Anim].get() == this);
 
-	const int offX = ParseAnimInt(unit, this->offXStr);
-	const int offY = ParseAnimInt(unit, this->offYStr);
-	const int range = ParseAnimInt(unit, this->rangeStr);
-	const int playerId = ParseAnimInt(unit, this->playerStr);
+	const int offX = this->offX.Eval(unit);
+	const int offY = this->offY.Eval(unit);
+	const int range = this->range.Eval(unit);
+	const int playerId = this->player.Eval(unit);
 	const SpawnUnit_Flags flags = ParseAnimFlags(this->flagsStr);
 
 	CPlayer &player = Players[playerId];
@@ -123,11 +123,18 @@ void CAnimation_SpawnUnit::Action(CUnit &unit, int & /*move*/, int /*scale*/) co
 /*
 **  s = "unitType offX offY range player [flags]"
 */
-void CAnimation_SpawnUnit::Init(std::string_view s, lua_State *) /* override */
+void CAnimation_SpawnUnit::Init(std::string_view s, lua_State *l) /* override */
 {
 	std::istringstream is{std::string(s)};
-	is >> this->unitTypeStr >> this->offXStr >> this->offYStr >> this->rangeStr >> this->playerStr
-		>> this->flagsStr;
+	std::string offXStr;
+	std::string offYStr;
+	std::string rangeStr;
+	std::string playerStr;
+	is >> this->unitTypeStr >> offXStr >> offYStr >> rangeStr >> playerStr >> this->flagsStr;
+	this->offX = CAnimInt(offXStr, l);
+	this->offY = CAnimInt(offYStr, l);
+	this->range = CAnimInt(rangeStr, l);
+	this->player = CAnimInt(playerStr, l);
 }
 
 //@}
@@ -43,7 +43,7 @@ void CAnimation_Wait::Action(CUnit &unit, int & /*move*/, int scale) const /* ov
 {
 	Assert(unit.Anim.CurrAnim);
 	Assert((*unit.Anim.CurrAnim)[unit.Anim.Anim].get() == this);
-	unit.Anim.Wait = ParseAnimInt(unit, this->wait) << scale >> 8;
+	unit.Anim.Wait = this->wait.Eval(unit) << scale >> 8;
 	if (unit.Variable[SLOW_INDEX].Value) { // unit is slowed down
 		unit.Anim.Wait <<= 1;
 	}
@@ -55,9 +55,9 @@ void CAnimation_Wait::Action(CUnit &unit, int & /*move*/, int scale) const /* ov
 	}
 }
 
-void CAnimation_Wait::Init(std::string_view s, lua_State *) /* override */
+void CAnimation_Wait::Init(std::string_view s, lua_State *l) /* override */
 {
-	this->wait = s;
+	this->wait = CAnimInt(s, l);
 }
 
 //@}
@@ -45,8 +45,8 @@
 
 void CAnimation_Wiggle::Action(CUnit &unit, int & /*move*/, int /*scale*/) const /* override */
 {
-	int x = ParseAnimInt(unit, this->x);
-	int y = ParseAnimInt(unit, this->y);
+	int x = this->x.Eval(unit);
+	int y = this->y.Eval(unit);
 	if (this->isHeading) {
 		x *= Heading2X[unit.Direction / NextDirection];
 		y *= Heading2Y[unit.Direction / NextDirection];
@@ -57,7 +57,7 @@ void CAnimation_Wiggle::Action(CUnit &unit, int & /*move*/, int /*scale*/) const
 		int targetY = y * PixelTileSize.y;
 		int curX = unit.tilePos.x * PixelTileSize.x + unit.IX;
 		int curY = unit.tilePos.y * PixelTileSize.y + unit.IY;
-		int speed = ParseAnimInt(unit, this->speed);
+		int speed = this->speed.Eval(unit);
 
 		bool reachedX = curX == targetX;
 		if (reachedX && curY == targetY) {
@@ -111,15 +111,21 @@ void CAnimation_Wiggle::Action(CUnit &unit, int & /*move*/, int /*scale*/) const
 	}
 }
 
-void CAnimation_Wiggle::Init(std::string_view s, lua_State *) /* override */
+void CAnimation_Wiggle::Init(std::string_view s, lua_State *l) /* override */
 {
 	std::istringstream is{std::string(s)};
-	is >> this->x >> this->y >> this->speed;
+	std::string xStr;
+	std::string yStr;
+	std::string speedStr;
+	is >> xStr >> yStr >> speedStr;
+	this->x = CAnimInt(xStr, l);
+	this->y = CAnimInt(yStr, l);
 
-	if (this->speed == "absolute") {
-	} else if (this->speed == "heading") {
+	if (speedStr == "absolute") {
+	} else if (speedStr == "heading") {
 		this->isHeading = true;
 	} else {
+		this->speed = CAnimInt(speedStr, l);
 		std::string label;
 		is >> label;
 		FindLabelLater(&this->ifNotReached, std::move(label));
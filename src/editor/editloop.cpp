@@ -1906,7 +1906,7 @@ void CEditor::Init()
 			}
 		}
 
-		Map.Fields.resize(Map.Info.MapWidth * Map.Info.MapHeight);
+		Map.Create();
 
 		const int defaultTile = Map.Tileset->getDefaultTileIndex();
 
@@ -57,12 +57,14 @@
 #include "parameters.h"
 #include "pathfinder.h"
 #include "player.h"
+#include "profiler.h"
 #include "replay.h"
 #include "results.h"
 #include "settings.h"
 #include "sound.h"
 #include "sound_server.h"
 #include "spells.h"
+#include "synchash.h"
 #include "tileset.h"
 #include "translate.h"
 #include "trigger.h"
@@ -882,6 +884,7 @@ void CreateGame(const fs::path &filename, CMap *map)
 	GameCycle = 0;
 	FastForwardCycle = 0;
 	SyncHash = 0;
+	StrongSyncHash.Clear();
 	InitSyncRand();
 
 	NetworkOnStartGame();
@@ -1577,6 +1580,7 @@ void LuaRegisterModules()
 	NetworkCclRegister();
 	PathfinderCclRegister();
 	PlayerCclRegister();
+	ProfilerCclRegister();
 	ReplayCclRegister();
 	ScriptRegister();
 	SelectionCclRegister();
@@ -51,6 +51,7 @@
 #include "sound.h"
 #include "sound_server.h"
 #include "spells.h"
+#include "synchash.h"
 #include "trigger.h"
 #include "ui.h"
 #include "unit.h"
@@ -216,6 +217,7 @@ void LoadGame(const fs::path &filename)
 	GameCycle = game_cycle;
 	SyncRandSeed = syncrand;
 	SyncHash = synchash;
+	StrongSyncHash.Clear();
 	SelectionChanged();
 }
 
@@ -66,26 +66,6 @@ extern void StartMap(const std::string &filename, bool clean);
 // Structures
 //----------------------------------------------------------------------------
 
-/**
-**  LogEntry structure.
-*/
-class LogEntry
-{
-public:
-	LogEntry() = default;
-
-	unsigned long GameCycle = 0;
-	int UnitNumber = 0;
-	std::string UnitIdent;
-	std::string Action;
-	int Flush = 0;
-	Vec2i Pos{0, 0};
-	int DestUnitNumber = 0;
-	std::string Value;
-	int Num = 0;
-	unsigned SyncRandSeed = 0;
-};
-
 /**
 ** Full replay structure (definition + logs)
 */
@@ -114,6 +94,21 @@ class FullReplay
 // Constants
 //----------------------------------------------------------------------------
 
+/// Start of the binary replay logs, followed by the lua header and the commands
+static constexpr char ReplayMagic[4] = {'S', 'R', 'P', '1'};
+/// The buffered commands are written to the log when the buffer reaches this size
+static constexpr size_t ReplayLogBufferMax = 4096;
+
+/// Optional fields of a binary command
+enum EReplayFields : uint64_t {
+	ReplayFieldUnit = 1 << 0,
+	ReplayFieldUnitIdent = 1 << 1,
+	ReplayFieldPos = 1 << 2,
+	ReplayFieldDestUnit = 1 << 3,
+	ReplayFieldValue = 1 << 4,
+	ReplayFieldNum = 1 << 5
+};
+
 
 //----------------------------------------------------------------------------
 // Variables
@@ -128,6 +123,178 @@ static unsigned long NextLogCycle; /// Next log cycle number
 static bool InitReplay;             /// Initialize replay
 static std::unique_ptr<FullReplay> CurrentReplay;
 static std::optional<std::size_t> ReplayIndex;
+static std::string LogBuffer;                /// Commands not written to LogFile yet
+static CReplayCommandWriter LogWriter;       /// Binary form of the LogFile commands
+static bool ReplayLoadOnly;                  /// Don't apply the settings of the loaded replay
+
+//----------------------------------------------------------------------------
+// Binary commands
+//----------------------------------------------------------------------------
+
+static void WriteVarUInt(uint64_t value, std::string &out)
+{
+	while (value >= 0x80) {
+		out.push_back(char((value & 0x7F) | 0x80));
+		value >>= 7;
+	}
+	out.push_back(char(value));
+}
+
+static void WriteVarInt(int64_t value, std::string &out)
+{
+	WriteVarUInt((uint64_t(value) << 1) ^ uint64_t(value >> 63), out);
+}
+
+static bool ReadVarUInt(const unsigned char *&p, const unsigned char *end, uint64_t &value)
+{
+	value = 0;
+	for (int shift = 0; p != end && shift < 64; shift += 7) {
+		const unsigned char byte = *p++;
+		value |= uint64_t(byte & 0x7F) << shift;
+		if (!(byte & 0x80)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool ReadVarInt(const unsigned char *&p, const unsigned char *end, int &value)
+{
+	uint64_t zigzag;
+	if (!ReadVarUInt(p, end, zigzag)) {
+		return false;
+	}
+	value = int(int64_t(zigzag >> 1) ^ -int64_t(zigzag & 1));
+	return true;
+}
+
+void CReplayCommandWriter::WriteString(const std::string &s, std::string &out)
+{
+	const auto [it, inserted] = Strings.try_emplace(s, Strings.size());
+	WriteVarUInt(it->second, out);
+	if (inserted) {
+		WriteVarUInt(s.size(), out);
+		out += s;
+	}
+}
+
+void CReplayCommandWriter::Write(const LogEntry &log, std::string &out)
+{
+	uint64_t fields = 0;
+	if (log.UnitNumber != -1) {
+		fields |= ReplayFieldUnit;
+	}
+	if (!log.UnitIdent.empty()) {
+		fields |= ReplayFieldUnitIdent;
+	}
+	if (log.Pos.x != -1 || log.Pos.y != -1) {
+		fields |= ReplayFieldPos;
+	}
+	if (log.DestUnitNumber != -1) {
+		fields |= ReplayFieldDestUnit;
+	}
+	if (!log.Value.empty()) {
+		fields |= ReplayFieldValue;
+	}
+	if (log.Num != -1) {
+		fields |= ReplayFieldNum;
+	}
+
+	WriteVarInt(int64_t(log.GameCycle) - int64_t(LastCycle), out);
+	LastCycle = log.GameCycle;
+	WriteVarUInt(fields, out);
+	WriteString(log.Action, out);
+	WriteVarInt(log.Flush, out);
+	if (fields & ReplayFieldUnit) {
+		WriteVarInt(log.UnitNumber, out);
+	}
+	if (fields & ReplayFieldUnitIdent) {
+		WriteString(log.UnitIdent, out);
+	}
+	if (fields & ReplayFieldPos) {
+		WriteVarInt(log.Pos.x, out);
+		WriteVarInt(log.Pos.y, out);
+	}
+	if (fields & ReplayFieldDestUnit) {
+		WriteVarInt(log.DestUnitNumber, out);
+	}
+	if (fields & ReplayFieldValue) {
+		WriteString(log.Value, out);
+	}
+	if (fields & ReplayFieldNum) {
+		WriteVarInt(log.Num, out);
+	}
+	for (int i = 0; i != 4; ++i) {
+		out.push_back(char((log.SyncRandSeed >> (8 * i)) & 0xFF));
+	}
+}
+
+bool CReplayCommandReader::ReadString(const unsigned char *&p, const unsigned char *end, std::string &s)
+{
+	uint64_t index;
+	if (!ReadVarUInt(p, end, index) || index > Strings.size()) {
+		return false;
+	}
+	if (index == Strings.size()) {
+		uint64_t size;
+		if (!ReadVarUInt(p, end, size) || size > uint64_t(end - p)) {
+			return false;
+		}
+		Strings.emplace_back(reinterpret_cast<const char *>(p), size);
+		p += size;
+	}
+	s = Strings[index];
+	return true;
+}
+
+/**
+**  Read a command.
+**
+**  @return  false if the data is truncated or invalid, log is undefined then.
+*/
+bool CReplayCommandReader::Read(const unsigned char *&p, const unsigned char *end, LogEntry &log)
+{
+	log = LogEntry();
+	log.UnitNumber = -1;
+	log.Pos = {-1, -1};
+	log.DestUnitNumber = -1;
+	log.Num = -1;
+
+	int delta;
+	uint64_t fields;
+	if (!ReadVarInt(p, end, delta) || !ReadVarUInt(p, end, fields)
+	    || !ReadString(p, end, log.Action) || !ReadVarInt(p, end, log.Flush)) {
+		return false;
+	}
+	LastCycle += delta;
+	log.GameCycle = LastCycle;
+	if (((fields & ReplayFieldUnit) && !ReadVarInt(p, end, log.UnitNumber))
+	    || ((fields & ReplayFieldUnitIdent) && !ReadString(p, end, log.UnitIdent))) {
+		return false;
+	}
+	if (fields & ReplayFieldPos) {
+		int x;
+		int y;
+		if (!ReadVarInt(p, end, x) || !ReadVarInt(p, end, y)) {
+			return false;
+		}
+		log.Pos.x = x;
+		log.Pos.y = y;
+	}
+	if (((fields & ReplayFieldDestUnit) && !ReadVarInt(p, end, log.DestUnitNumber))
+	    || ((fields & ReplayFieldValue) && !ReadString(p, end, log.Value))
+	    || ((fields & ReplayFieldNum) && !ReadVarInt(p, end, log.Num))) {
+		return false;
+	}
+	if (end - p < 4) {
+		return false;
+	}
+	log.SyncRandSeed = 0;
+	for (int i = 0; i != 4; ++i) {
+		log.SyncRandSeed |= unsigned(*p++) << (8 * i);
+	}
+	return true;
+}
 
 //----------------------------------------------------------------------------
 // Log commands
@@ -250,56 +417,107 @@ static void PrintLogCommand(const LogEntry &log, CFile &file)
 }
 
 /**
-**  Output the FullReplay list to file
+**  Output the header of a replay, the ReplayLog call
 **
-**  @param file  The file to output to
+**  @param replay  The replay to output
+**  @param file    The file to output to
 */
-static void SaveFullLog(CFile &file)
+static void SaveReplayHeader(const FullReplay &replay, CFile &file)
 {
 	file.printf("\n--- -----------------------------------------\n");
 	file.printf("--- MODULE: replay list\n");
 
 	file.printf("\n");
 	file.printf("ReplayLog( {\n");
-	file.printf("  Comment1 = \"%s\",\n", CurrentReplay->Comment1.c_str());
-	file.printf("  Comment2 = \"%s\",\n", CurrentReplay->Comment2.c_str());
-	file.printf("  Date = \"%s\",\n", CurrentReplay->Date.c_str());
-	file.printf("  Map = \"%s\",\n", CurrentReplay->Map.c_str());
-	file.printf("  MapPath = \"%s\",\n", CurrentReplay->MapPath.c_str());
-	file.printf("  MapId = %u,\n", CurrentReplay->MapId);
-	file.printf("  LocalPlayer = %d,\n", CurrentReplay->LocalPlayer);
+	file.printf("  Comment1 = \"%s\",\n", replay.Comment1.c_str());
+	file.printf("  Comment2 = \"%s\",\n", replay.Comment2.c_str());
+	file.printf("  Date = \"%s\",\n", replay.Date.c_str());
+	file.printf("  Map = \"%s\",\n", replay.Map.c_str());
+	file.printf("  MapPath = \"%s\",\n", replay.MapPath.c_str());
+	file.printf("  MapId = %u,\n", replay.MapId);
+	file.printf("  LocalPlayer = %d,\n", replay.LocalPlayer);
 	file.printf("  Players = {\n");
 	for (int i = 0; i < PlayerMax; ++i) {
-		file.printf("\t{ Name = \"%s\", ", CurrentReplay->PlayerNames[i].c_str());
-		CurrentReplay->ReplaySettings.Presets[i].Save([&] (std::string field) {
+		file.printf("\t{ Name = \"%s\", ", replay.PlayerNames[i].c_str());
+		replay.ReplaySettings.Presets[i].Save([&] (std::string field) {
 			file.printf("%s, ", field.c_str());
 		});
 		file.printf("}%s", i != PlayerMax - 1 ? ",\n" : "\n");
 	}
 	file.printf("  },\n");
-	CurrentReplay->ReplaySettings.Save([&] (std::string field) {
+	replay.ReplaySettings.Save([&] (std::string field) {
 		file.printf("  %s,\n", field.c_str());
 	}, false);
 	file.printf("  Engine = { %d, %d, %d },\n",
-				CurrentReplay->Engine[0], CurrentReplay->Engine[1], CurrentReplay->Engine[2]);
+				replay.Engine[0], replay.Engine[1], replay.Engine[2]);
 	file.printf("  Network = { %d, %d, %d }\n",
-				CurrentReplay->Network[0], CurrentReplay->Network[1], CurrentReplay->Network[2]);
+				replay.Network[0], replay.Network[1], replay.Network[2]);
 	file.printf("} )\n");
-	for (const auto &command : CurrentReplay->Commands) {
+}
+
+/**
+**  Output the FullReplay list to file, in the lua format
+**
+**  @param replay  The replay to output
+**  @param file    The file to output to
+*/
+static void SaveFullLog(const FullReplay &replay, CFile &file)
+{
+	SaveReplayHeader(replay, file);
+	for (const auto &command : replay.Commands) {
 		PrintLogCommand(command, file);
 	}
 }
 
+/**
+**  Output the FullReplay list, in the binary format
+**
+**  @param replay  The replay to output
+**  @param writer  Interned strings of the output
+**  @param out     The buffer to output to
+*/
+static void SaveBinaryLog(const FullReplay &replay, CReplayCommandWriter &writer, std::string &out)
+{
+	CFile header;
+	header.open(nullptr, CL_WRITE_MEMORY | CL_OPEN_WRITE);
+	SaveReplayHeader(replay, header);
+	header.close();
+	const std::string headerContent = header.takeBuffer();
+
+	out.append(ReplayMagic, sizeof(ReplayMagic));
+	WriteVarUInt(headerContent.size(), out);
+	out += headerContent;
+	for (const auto &command : replay.Commands) {
+		writer.Write(command, out);
+	}
+}
+
+/**
+**  Write the buffered commands to LogFile.
+**
+**  Called each second, so a crash loses at most the last second of commands.
+*/
+void FlushReplayLog()
+{
+	if (!LogFile || LogBuffer.empty()) {
+		return;
+	}
+	LogFile->write(LogBuffer.data(), LogBuffer.size());
+	LogFile->flush();
+	LogBuffer.clear();
+}
+
 /**
 **  Append the LogEntry structure at the end of currentLog, and to LogFile
 **
 **  @param log   Pointer the replay log entry to be added
-**  @param dest  The file to output to
 */
-static void AppendLog(LogEntry&& log, CFile &file)
+static void AppendLog(LogEntry&& log)
 {
-	PrintLogCommand(log, file);
-	file.flush();
+	LogWriter.Write(log, LogBuffer);
+	if (LogBuffer.size() >= ReplayLogBufferMax) {
+		FlushReplayLog();
+	}
 
 	CurrentReplay->Commands.push_back(std::move(log));
 }
@@ -357,15 +575,19 @@ void CommandLog(const char *action,
 			return;
 		}
 		LastLogFileName = path;
+		LogBuffer.clear();
+		LogWriter = CReplayCommandWriter();
 		if (CurrentReplay) {
-			SaveFullLog(*LogFile);
+			SaveBinaryLog(*CurrentReplay, LogWriter, LogBuffer);
+			FlushReplayLog();
 		}
 	}
 
 	if (!CurrentReplay) {
 		CurrentReplay = StartReplay();
 
-		SaveFullLog(*LogFile);
+		SaveBinaryLog(*CurrentReplay, LogWriter, LogBuffer);
+		FlushReplayLog();
 	}
 
 	if (!action) {
@@ -409,7 +631,7 @@ void CommandLog(const char *action,
 	log.SyncRandSeed = SyncRandSeed;
 
 	// Append it to ReplayLog list
-	AppendLog(std::move(log), *LogFile);
+	AppendLog(std::move(log));
 }
 
 /**
@@ -556,7 +778,9 @@ static int CclReplayLog(lua_State *l)
 	CurrentReplay = std::move(replay);
 
 	// Apply CurrentReplay settings.
-	if (!SaveGameLoading) {
+	if (ReplayLoadOnly) {
+		// only read, see CclConvertReplay
+	} else if (!SaveGameLoading) {
 		ApplyReplaySettings();
 	} else {
 		CommandLogDisabled = false;
@@ -573,6 +797,14 @@ bool IsReplayGame()
 	return ReplayGameType != EReplayType::NoReplay;
 }
 
+/**
+**  Check if all the commands of the replay have been run
+*/
+bool IsReplayFinished()
+{
+	return IsReplayGame() && !InitReplay && !ReplayIndex;
+}
+
 /**
 **  Save generated replay
 **
@@ -580,7 +812,60 @@ bool IsReplayGame()
 */
 void SaveReplayList(CFile &file)
 {
-	SaveFullLog(file);
+	if (CurrentReplay) {
+		SaveFullLog(*CurrentReplay, file);
+	}
+}
+
+/**
+**  Read a replay file, in the binary or the lua format, into CurrentReplay.
+**
+**  @param name         name of file to load.
+**  @param exitOnError  exit if the lua part can't be run.
+**
+**  @return             true if the replay is read. The commands after a
+**                      truncated one (crash while writing) are dropped.
+*/
+static bool LoadReplayFile(const fs::path &name, bool exitOnError)
+{
+	CFile file;
+	if (file.open(name.string().c_str(), CL_OPEN_READ) == -1) {
+		ErrorPrint("Can't open replay '%s'\n", name.u8string().c_str());
+		return false;
+	}
+	std::string content;
+	char buf[4096];
+	for (int n; (n = file.read(buf, sizeof(buf))) > 0;) {
+		content.append(buf, n);
+	}
+	file.close();
+
+	if (content.compare(0, sizeof(ReplayMagic), ReplayMagic, sizeof(ReplayMagic)) != 0) {
+		return LuaLoadFile(name, "", exitOnError) == 0;
+	}
+	const unsigned char *p = reinterpret_cast<const unsigned char *>(content.data()) + sizeof(ReplayMagic);
+	const unsigned char *end = reinterpret_cast<const unsigned char *>(content.data()) + content.size();
+	uint64_t headerSize;
+	if (!ReadVarUInt(p, end, headerSize) || headerSize > uint64_t(end - p)) {
+		ErrorPrint("Invalid replay '%s'\n", name.u8string().c_str());
+		return false;
+	}
+	if (CclCommand(std::string(reinterpret_cast<const char *>(p), headerSize), exitOnError) != 0
+	    || !CurrentReplay) {
+		return false;
+	}
+	p += headerSize;
+
+	CReplayCommandReader reader;
+	LogEntry log;
+	while (p != end && reader.Read(p, end, log)) {
+		CurrentReplay->Commands.push_back(std::move(log));
+	}
+	if (p != end) {
+		ErrorPrint("Replay '%s' is truncated after %d commands\n",
+		           name.u8string().c_str(), int(CurrentReplay->Commands.size()));
+	}
+	return true;
 }
 
 /**
@@ -592,7 +877,7 @@ static void LoadReplay(const fs::path &name)
 {
 	CleanReplayLog();
 	ReplayGameType = EReplayType::SinglePlayer;
-	LuaLoadFile(name);
+	LoadReplayFile(name, true);
 
 	NextLogCycle = ~0UL;
 	if (!CommandLogDisabled) {
@@ -609,6 +894,7 @@ static void LoadReplay(const fs::path &name)
 void EndReplayLog()
 {
 	if (LogFile) {
+		FlushReplayLog();
 		LogFile->close();
 		LogFile = nullptr;
 	}
@@ -862,6 +1148,68 @@ void StartReplay(const std::string &filename, bool reveal)
 	StartMap(CurrentMapPath, false);
 }
 
+/**
+**  Convert a replay between the binary format of the logs and the lua format.
+**
+**  @param l  Lua state.
+**
+**  Example:
+**
+**  <div class="example"><code>-- A binary log to lua, and back.
+**      <strong>ConvertReplay</strong>("log_of_stratagus_0_1700000000.log", "game.lua")
+**      <strong>ConvertReplay</strong>("game.lua", "game.log")</code></div>
+**
+**  The relative file names are in the logs directory, the format is
+**  the other one than the one of the source.
+*/
+static int CclConvertReplay(lua_State *l)
+{
+	LuaCheckArgs(l, 2);
+	const fs::path logs = Parameters::Instance.GetUserDirectory() / GameName / "logs";
+	const fs::path source = logs / std::string(LuaToString(l, 1));
+	const fs::path destination = logs / std::string(LuaToString(l, 2));
+
+	std::string content;
+	{
+		CFile file;
+		char magic[sizeof(ReplayMagic)]{};
+		if (file.open(source.string().c_str(), CL_OPEN_READ) == -1) {
+			LuaError(l, "Can't open replay '%s'", source.u8string().c_str());
+		}
+		const bool binary = file.read(magic, sizeof(magic)) == sizeof(magic)
+		                    && std::equal(magic, magic + sizeof(magic), ReplayMagic);
+		file.close();
+
+		std::unique_ptr<FullReplay> currentReplay = std::move(CurrentReplay);
+		ReplayLoadOnly = true;
+		const bool loaded = LoadReplayFile(source, false);
+		ReplayLoadOnly = false;
+		std::unique_ptr<FullReplay> replay = std::move(CurrentReplay);
+		CurrentReplay = std::move(currentReplay);
+		if (!loaded || !replay) {
+			LuaError(l, "Can't read replay '%s'", source.u8string().c_str());
+		}
+
+		if (binary) {
+			CFile lua;
+			lua.open(nullptr, CL_WRITE_MEMORY | CL_OPEN_WRITE);
+			SaveFullLog(*replay, lua);
+			lua.close();
+			content = lua.takeBuffer();
+		} else {
+			CReplayCommandWriter writer;
+			SaveBinaryLog(*replay, writer, content);
+		}
+	}
+	CFile file;
+	if (file.open(destination.string().c_str(), CL_OPEN_WRITE) == -1
+	    || file.write(content.data(), content.size()) <= 0) {
+		LuaError(l, "Can't save to '%s'", destination.u8string().c_str());
+	}
+	file.close();
+	return 0;
+}
+
 /**
 **  Register Ccl functions with lua
 */
@@ -869,6 +1217,7 @@ void ReplayCclRegister()
 {
 	lua_register(Lua, "Log", CclLog);
 	lua_register(Lua, "ReplayLog", CclReplayLog);
+	lua_register(Lua, "ConvertReplay", CclConvertReplay);
 }
 
 //@}
@@ -54,6 +54,8 @@
 #include "upgrade.h"
 #include "version.h"
 
+#include <chrono>
+#include <future>
 #include <time.h>
 
 extern void StartMap(const std::string &filename, bool clean);
@@ -95,23 +97,48 @@ static fs::path GetSaveDir()
 }
 
 /**
-**  Save a game to file.
+**  Get the file of the binary map fields of a save game.
 **
-**  @param filename  File name to be stored.
-**  @return  -1 if saving failed, 0 if all OK
+**  @param savePath  Save game, with or without its compression extension.
+*/
+static fs::path GetMapFieldsPath(fs::path savePath)
+{
+	if (savePath.extension() == ".gz" || savePath.extension() == ".bz2") {
+		savePath.replace_extension();
+	}
+	return savePath.replace_extension(".fields");
+}
+
+namespace
+{
+
+/// Save game serialized in memory, to be written to the disk
+struct SaveGameSnapshot
+{
+	fs::path Path;       /// Save game file
+	std::string Content; /// Lua part of the save game
+	std::string Fields;  /// Binary map fields, referenced by the Lua part
+};
+
+} // namespace
+
+/// Save game being written by a worker thread
+static std::future<int> SaveGameWriting;
+
+/**
+**  Serialize the game in memory. Must be called by the game thread.
 **
-**  @note  Later we want to store in a more compact binary format.
+**  @param filename  File name to be stored.
 */
-int SaveGame(const std::string &filename)
+static SaveGameSnapshot TakeSaveGameSnapshot(const std::string &filename)
 {
-	CFile file;
-	fs::path fullpath(GetSaveDir());
+	SaveGameSnapshot snapshot;
+	snapshot.Path = GetSaveDir() / filename;
 
-	fullpath /= filename;
-	if (file.open(fullpath.string().c_str(), CL_WRITE_GZ | CL_OPEN_WRITE) == -1) {
-		ErrorPrint("Can't save to '%s'\n", filename.c_str());
-		return -1;
-	}
+	CFile file;
+	file.open(nullptr, CL_WRITE_MEMORY | CL_OPEN_WRITE);
+	CFile fieldsFile;
+	fieldsFile.open(nullptr, CL_WRITE_MEMORY | CL_OPEN_WRITE);
 
 	time_t now;
 	char dateStr[64];
@@ -157,7 +184,7 @@ int SaveGame(const std::string &filename)
 	SaveUnitTypes(file);
 	SaveUpgrades(file);
 	SavePlayers(file);
-	Map.Save(file);
+	Map.Save(file, &fieldsFile, GetMapFieldsPath(snapshot.Path).filename().u8string());
 	UnitManager->Save(file);
 	SaveUserInterface(file);
 	SaveAi(file);
@@ -173,7 +200,81 @@ int SaveGame(const std::string &filename)
 	}
 	SaveTriggers(file); //Triggers are saved in SaveGlobal, so load it after Global
 	file.close();
-	return 0;
+	fieldsFile.close();
+	snapshot.Content = file.takeBuffer();
+	snapshot.Fields = fieldsFile.takeBuffer();
+	return snapshot;
+}
+
+/**
+**  Compress and write a save game to the disk. Can be called by any thread.
+**
+**  @return  -1 if saving failed, 0 if all OK
+*/
+static int WriteSaveGameSnapshot(const SaveGameSnapshot &snapshot)
+{
+	const auto writeFile = [](const fs::path &path, const std::string &content) {
+		CFile file;
+		if (file.open(path.string().c_str(), CL_WRITE_GZ | CL_OPEN_WRITE) == -1) {
+			ErrorPrint("Can't save to '%s'\n", path.u8string().c_str());
+			return false;
+		}
+		const bool ok = content.empty() || file.write(content.data(), content.size()) > 0;
+		if (file.close() != 0 || !ok) {
+			ErrorPrint("Can't write '%s'\n", path.u8string().c_str());
+			return false;
+		}
+		return true;
+	};
+	// the fields first, the save game refers to them
+	if (!snapshot.Fields.empty() && !writeFile(GetMapFieldsPath(snapshot.Path), snapshot.Fields)) {
+		return -1;
+	}
+	return writeFile(snapshot.Path, snapshot.Content) ? 0 : -1;
+}
+
+/**
+**  Wait for the save game written in background, if any.
+**
+**  @return  -1 if saving failed, 0 if all OK or nothing to wait for
+*/
+int WaitSaveGame()
+{
+	return SaveGameWriting.valid() ? SaveGameWriting.get() : 0;
+}
+
+/**
+**  Save a game to file.
+**
+**  @param filename  File name to be stored.
+**  @return  -1 if saving failed, 0 if all OK
+**
+**  @note  The map fields are stored in a binary file next to it.
+*/
+int SaveGame(const std::string &filename)
+{
+	WaitSaveGame();
+	return WriteSaveGameSnapshot(TakeSaveGameSnapshot(filename));
+}
+
+/**
+**  Save a game to file, only serializing it in the game thread.
+**  The compression and the writing are done by a worker thread.
+**
+**  @param filename  File name to be stored.
+**  @return  false if a save game is still being written, nothing is done then.
+*/
+bool SaveGameAsync(const std::string &filename)
+{
+	if (SaveGameWriting.valid()
+	    && SaveGameWriting.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+		return false;
+	}
+	WaitSaveGame();
+	SaveGameWriting = std::async(std::launch::async, [snapshot = TakeSaveGameSnapshot(filename)]() {
+		return WriteSaveGameSnapshot(snapshot);
+	});
+	return true;
 }
 
 /**
@@ -188,14 +289,22 @@ void DeleteSaveGame(const std::string &filename)
 		return;
 	}
 
+	WaitSaveGame();
 	fs::path fullpath = GetSaveDir() / filename;
 	if (unlink(fullpath.string().c_str()) == -1) {
 		ErrorPrint("delete failed for '%s'", fullpath.u8string().c_str());
 	}
+	// CFile may have added a compression extension to it
+	const fs::path fieldsPath = GetMapFieldsPath(fullpath);
+	std::error_code ec;
+	for (const char *extension : {"", ".gz", ".bz2"}) {
+		fs::remove(fieldsPath.string() + extension, ec);
+	}
 }
 
 void StartSavedGame(const std::string &filename)
 {
+	WaitSaveGame();
 	SaveGameLoading = true;
 	CleanPlayers();
 	LoadGame(ExpandPath(filename));
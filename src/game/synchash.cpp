@@ -0,0 +1,255 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name synchash.cpp - The strong sync hash. */
+//
+//      (c) Copyright 2026 by the Stratagus Team
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+//@{
+
+/*----------------------------------------------------------------------------
+--  Includes
+----------------------------------------------------------------------------*/
+
+#include "stratagus.h"
+
+#include "synchash.h"
+
+#include "actions.h"
+#include "map.h"
+#include "player.h"
+#include "unit.h"
+#include "unit_manager.h"
+#include "unittype.h"
+
+#include <algorithm>
+
+/*----------------------------------------------------------------------------
+--  Variables
+----------------------------------------------------------------------------*/
+
+bool StrongSyncHashEnabled = false;
+CSyncHash StrongSyncHash;
+
+/*----------------------------------------------------------------------------
+--  Functions
+----------------------------------------------------------------------------*/
+
+/// Mix a value into a hash (murmur3 finalizer)
+static uint32_t SyncHashMix(uint32_t hash, uint32_t value)
+{
+	hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	hash ^= hash >> 16;
+	hash *= 0x85ebca6b;
+	hash ^= hash >> 13;
+	hash *= 0xc2b2ae35;
+	hash ^= hash >> 16;
+	return hash;
+}
+
+/// Fold a hash into the 16 bits sent for each bucket
+static uint16_t SyncHashFold(uint32_t hash)
+{
+	return uint16_t(hash ^ (hash >> 16));
+}
+
+/// Hash of the state of a unit, never 0
+static uint32_t SyncHashUnit(const CUnit &unit)
+{
+	uint32_t hash = SyncHashMix(0, UnitNumber(unit));
+
+	hash = SyncHashMix(hash, unit.Player ? unit.Player->Index : PlayerMax);
+	hash = SyncHashMix(hash, (unit.tilePos.x << 16) | (unit.tilePos.y & 0xFFFF));
+	hash = SyncHashMix(hash, ((unit.IX & 0xFF) << 8) | (unit.IY & 0xFF));
+	hash = SyncHashMix(hash, unit.Variable[HP_INDEX].Value);
+	hash = SyncHashMix(hash, unit.ResourcesHeld);
+	hash = SyncHashMix(hash, unit.Orders.size());
+	if (!unit.Orders.empty()) {
+		const Vec2i goalPos = unit.CurrentOrder()->GetGoalPos();
+		hash = SyncHashMix(hash, static_cast<uint32_t>(unit.CurrentAction()));
+		hash = SyncHashMix(hash, (goalPos.x << 16) | (goalPos.y & 0xFFFF));
+	}
+	return hash ? hash : 1;
+}
+
+/// Map region of a tile
+static uint8_t SyncHashRegion(const Vec2i &pos)
+{
+	const int x = std::clamp(pos.x * SyncHashRegionSide / std::max(1, Map.Info.MapWidth), 0, SyncHashRegionSide - 1);
+	const int y = std::clamp(pos.y * SyncHashRegionSide / std::max(1, Map.Info.MapHeight), 0, SyncHashRegionSide - 1);
+	return uint8_t(y * SyncHashRegionSide + x);
+}
+
+/// Slot range of a unit slot
+static int SyncHashRange(unsigned int slot)
+{
+	return (slot / SyncHashUnitRangeSize) % SyncHashUnitRangeCount;
+}
+
+/**
+**  Forget all the contributions, at the start of a game.
+*/
+void CSyncHash::Clear()
+{
+	Units.clear();
+	HashedSlots.clear();
+	std::fill(std::begin(Regions), std::end(Regions), 0);
+	std::fill(std::begin(Ranges), std::end(Ranges), 0);
+	std::fill(std::begin(PlayerHashes), std::end(PlayerHashes), 0);
+}
+
+/**
+**  Update the contribution of a unit, after its action of the cycle.
+*/
+void CSyncHash::UpdateUnit(const CUnit &unit)
+{
+	const unsigned int slot = UnitNumber(unit);
+	if (slot >= Units.size()) {
+		Units.resize(slot + 1);
+	}
+	UnitEntry &entry = Units[slot];
+	const uint32_t hash = SyncHashUnit(unit);
+	const uint8_t region = SyncHashRegion(unit.tilePos);
+
+	if (entry.Hash == 0) {
+		HashedSlots.push_back(slot);
+	} else if (entry.Hash == hash && entry.Region == region) {
+		entry.Cycle = GameCycle;
+		return;
+	} else {
+		Regions[entry.Region] ^= entry.Hash;
+		Ranges[SyncHashRange(slot)] ^= entry.Hash;
+	}
+	entry.Hash = hash;
+	entry.Region = region;
+	entry.Cycle = GameCycle;
+	Regions[region] ^= hash;
+	Ranges[SyncHashRange(slot)] ^= hash;
+}
+
+/**
+**  Remove the units not updated this cycle (dead or released), and hash
+**  the resources of the players.
+*/
+void CSyncHash::EndCycle()
+{
+	HashedSlots.erase(std::remove_if(HashedSlots.begin(), HashedSlots.end(), [this](unsigned int slot) {
+		UnitEntry &entry = Units[slot];
+		if (entry.Cycle == GameCycle) {
+			return false;
+		}
+		Regions[entry.Region] ^= entry.Hash;
+		Ranges[SyncHashRange(slot)] ^= entry.Hash;
+		entry = UnitEntry();
+		return true;
+	}), HashedSlots.end());
+
+	for (int i = 0; i != PlayerMax; ++i) {
+		const CPlayer &player = Players[i];
+		uint32_t hash = SyncHashMix(0, i);
+		for (int res = 0; res != MaxCosts; ++res) {
+			hash = SyncHashMix(hash, player.Resources[res]);
+			hash = SyncHashMix(hash, player.StoredResources[res]);
+		}
+		PlayerHashes[i] = hash;
+	}
+}
+
+/**
+**  Get the hash of the whole state.
+*/
+uint32_t CSyncHash::GetHash() const
+{
+	uint32_t hash = 0;
+	for (uint32_t range : Ranges) {
+		hash = SyncHashMix(hash, range);
+	}
+	for (uint32_t player : PlayerHashes) {
+		hash = SyncHashMix(hash, player);
+	}
+	return hash;
+}
+
+/**
+**  Get the folded hashes of the buckets.
+*/
+void CSyncHash::GetBuckets(SyncHashBuckets &buckets) const
+{
+	buckets.Cycle = GameCycle;
+	std::transform(std::begin(Regions), std::end(Regions), buckets.Regions, SyncHashFold);
+	std::transform(std::begin(Ranges), std::end(Ranges), buckets.Units, SyncHashFold);
+	std::transform(std::begin(PlayerHashes), std::end(PlayerHashes), buckets.Players, SyncHashFold);
+}
+
+/**
+**  Print the buckets which differ from the ones of another peer, and the
+**  units which are in both a differing region and a differing slot range.
+**
+**  @param local   Local buckets, saved when the sync message was sent.
+**  @param remote  Buckets of the other peer for the same cycle.
+*/
+void CSyncHash::PrintDifferences(const SyncHashBuckets &local, const SyncHashBuckets &remote) const
+{
+	bool regions[SyncHashRegionCount];
+	bool ranges[SyncHashUnitRangeCount];
+
+	for (int i = 0; i != PlayerMax; ++i) {
+		if (local.Players[i] != remote.Players[i]) {
+			ErrorPrint("Desync at cycle %lu: resources of player %d\n", local.Cycle, i);
+		}
+	}
+	for (int i = 0; i != SyncHashRegionCount; ++i) {
+		regions[i] = local.Regions[i] != remote.Regions[i];
+		if (regions[i]) {
+			const int x = i % SyncHashRegionSide;
+			const int y = i / SyncHashRegionSide;
+			ErrorPrint("Desync at cycle %lu: map region %d,%d - %d,%d\n", local.Cycle,
+			           x * Map.Info.MapWidth / SyncHashRegionSide, y * Map.Info.MapHeight / SyncHashRegionSide,
+			           (x + 1) * Map.Info.MapWidth / SyncHashRegionSide - 1,
+			           (y + 1) * Map.Info.MapHeight / SyncHashRegionSide - 1);
+		}
+	}
+	for (int i = 0; i != SyncHashUnitRangeCount; ++i) {
+		ranges[i] = local.Units[i] != remote.Units[i];
+		if (ranges[i]) {
+			ErrorPrint("Desync at cycle %lu: unit slots %d - %d (modulo %d)\n", local.Cycle,
+			           i * SyncHashUnitRangeSize, (i + 1) * SyncHashUnitRangeSize - 1,
+			           SyncHashUnitRangeSize * SyncHashUnitRangeCount);
+		}
+	}
+	// The units may have changed since, but they are likely the ones which diverge.
+	for (const CUnit *unit : UnitManager->GetUnits()) {
+		const unsigned int slot = UnitNumber(*unit);
+		if (unit->Destroyed || !ranges[SyncHashRange(slot)] || !regions[SyncHashRegion(unit->tilePos)]) {
+			continue;
+		}
+		ErrorPrint("Desync suspect: unit %d:%s player %d at %d,%d hp %d action %d\n", slot,
+		           unit->Type->Ident.c_str(), unit->Player->Index, unit->tilePos.x, unit->tilePos.y,
+		           unit->Variable[HP_INDEX].Value,
+		           unit->Orders.empty() ? -1 : int(unit->CurrentAction()));
+	}
+}
+
+//@}
@@ -47,14 +47,45 @@
 #include "unit_find.h"
 #include "unittype.h"
 
+#include <memory>
 #include <vector>
 
+/*----------------------------------------------------------------------------
+--  Declarations
+----------------------------------------------------------------------------*/
+
+using UnitValidator = std::function<bool(const CUnit &)>;
+
+/**
+**  Trigger condition declared as data, evaluated without calling Lua.
+**
+**  Its result is kept until a unit which can change it is placed,
+**  removed, killed, built, transformed or captured.
+*/
+class CTriggerCondition
+{
+public:
+	virtual ~CTriggerCondition() = default;
+
+	/// Compute the condition
+	virtual bool Check() const = 0;
+	/// Can a change of the unit change the result
+	virtual bool IsAffectedBy(const CUnit &unit) const = 0;
+	/// Does the result depend on the game timer, which changes each cycle
+	virtual bool IsTimer() const { return false; }
+
+	bool Dirty = true;       /// The result must be computed again
+	bool LastResult = false; /// Last computed result
+};
+
 /*----------------------------------------------------------------------------
 --  Variables
 ----------------------------------------------------------------------------*/
 
 CTimer GameTimer;               /// The game timer
 static std::vector<bool> ActiveTriggers;
+/// Native conditions, by trigger index, nullptr for the Lua conditions
+static std::vector<std::unique_ptr<CTriggerCondition>> NativeConditions;
 
 /// Some data accessible for script during the game.
 TriggerDataType TriggerData;
@@ -150,6 +181,43 @@ static CompareFunction GetCompareFunction(std::string_view op)
 	return nullptr;
 }
 
+/**
+**  Count the alive units of a given unit-type and player in an area.
+*/
+static int CountUnitsAt(const Vec2i &minPos, const Vec2i &maxPos,
+                        const UnitValidator &unitPlayerValidator, const UnitValidator &unitValidator)
+{
+	std::vector<CUnit *> units = Select(minPos, maxPos);
+
+	return ranges::count_if(units, [&](const CUnit *unit) {
+		return unitValidator(*unit) && unitPlayerValidator(*unit) && unit->IsAlive();
+	});
+}
+
+/**
+**  Check if the quantity of units of a given unit-type and player near to
+**  a unit of the center unit-type compares true.
+**
+**  @param rescued  Only count the rescued units.
+*/
+static bool IsNearUnit(const CUnitType &centerType, CompareFunction compare, int q,
+                       const UnitValidator &unitPlayerValidator, const UnitValidator &unitValidator,
+                       bool rescued)
+{
+	for (const CUnit *centerUnit : FindUnitsByType(centerType)) {
+		std::vector<CUnit *> around = SelectAroundUnit(*centerUnit, 1);
+
+		// Count the requested units
+		const int s = ranges::count_if(around, [&](const CUnit *unit) {
+			return (!rescued || unit->RescuedFrom) && unitValidator(*unit) && unitPlayerValidator(*unit);
+		});
+		if (compare(s, q)) {
+			return true;
+		}
+	}
+	return false;
+}
+
 /**
 ** <b>Description</b>
 **
@@ -183,12 +251,7 @@ static int CclGetNumUnitsAt(lua_State *l)
 		std::swap(minPos.y, maxPos.y);
 	}
 
-	std::vector<CUnit *> units = Select(minPos, maxPos);
-
-	const int s = ranges::count_if(units, [&](const CUnit *unit) {
-		return unitValidator(*unit) && unitPlayerValidator(*unit) && unit->IsAlive();
-	});
-	lua_pushnumber(l, s);
+	lua_pushnumber(l, CountUnitsAt(minPos, maxPos, unitPlayerValidator, unitValidator));
 	return 1;
 }
 
@@ -225,25 +288,7 @@ static int CclIfNearUnit(lua_State *l)
 	if (!compare) {
 		LuaError(l, "Illegal comparison operation in if-near-unit: %s", op.data());
 	}
-
-	//
-	// Get all unit types 'near'.
-	//
-
-	std::vector<CUnit *> unitsOfType = FindUnitsByType(*ut2);
-	for (const CUnit *centerUnit : unitsOfType) {
-		std::vector<CUnit *> around = SelectAroundUnit(*centerUnit, 1);
-
-		// Count the requested units
-		const int s = ranges::count_if(around, [&](const CUnit *unit) {
-			return unitValidator(*unit) && unitPlayerValidator(*unit);
-		});
-		if (compare(s, q)) {
-			lua_pushboolean(l, 1);
-			return 1;
-		}
-	}
-	lua_pushboolean(l, 0);
+	lua_pushboolean(l, IsNearUnit(*ut2, compare, q, unitPlayerValidator, unitValidator, false));
 	return 1;
 }
 
@@ -277,21 +322,7 @@ static int CclIfRescuedNearUnit(lua_State *l)
 	if (!compare) {
 		LuaError(l, "Illegal comparison operation in if-rescued-near-unit: %s", op.data());
 	}
-
-	// Get all unit types 'near'.
-	std::vector<CUnit *> table = FindUnitsByType(*ut2);
-	for (CUnit *centerUnit : table) {
-		std::vector<CUnit *> around = SelectAroundUnit(*centerUnit, 1);
-		// Count the requested units
-		const int s = ranges::count_if(around, [&](const CUnit *unit) {
-			return unit->RescuedFrom && unitValidator(*unit) && unitPlayerValidator(*unit);
-		});
-		if (compare(s, q)) {
-			lua_pushboolean(l, 1);
-			return 1;
-		}
-	}
-	lua_pushboolean(l, 0);
+	lua_pushboolean(l, IsNearUnit(*ut2, compare, q, unitPlayerValidator, unitValidator, true));
 	return 1;
 }
 
@@ -324,6 +355,174 @@ int GetTimer()
 	return GameTimer.Cycles;
 }
 
+/*---------------------------------------------------------------------------
+-- Native conditions
+---------------------------------------------------------------------------*/
+
+/// Quantity of units of a given unit-type and player in an area
+class CUnitsAtCondition : public CTriggerCondition
+{
+public:
+	bool Check() const override
+	{
+		return Compare(CountUnitsAt(MinPos, MaxPos, PlayerValidator, TypeValidator), Quantity);
+	}
+
+	bool IsAffectedBy(const CUnit &unit) const override
+	{
+		return unit.tilePos.x <= MaxPos.x && unit.tilePos.x + unit.Type->TileWidth > MinPos.x
+		    && unit.tilePos.y <= MaxPos.y && unit.tilePos.y + unit.Type->TileHeight > MinPos.y
+		    && TypeValidator(unit) && PlayerValidator(unit);
+	}
+
+	UnitValidator PlayerValidator;
+	UnitValidator TypeValidator;
+	Vec2i MinPos;
+	Vec2i MaxPos;
+	CompareFunction Compare = nullptr;
+	int Quantity = 0;
+};
+
+/// Quantity of units of a given unit-type and player near to a unit-type
+class CNearUnitCondition : public CTriggerCondition
+{
+public:
+	bool Check() const override
+	{
+		return IsNearUnit(*CenterType, Compare, Quantity, PlayerValidator, TypeValidator, Rescued);
+	}
+
+	bool IsAffectedBy(const CUnit &unit) const override
+	{
+		return unit.Type == CenterType || (TypeValidator(unit) && PlayerValidator(unit));
+	}
+
+	UnitValidator PlayerValidator;
+	UnitValidator TypeValidator;
+	const CUnitType *CenterType = nullptr;
+	CompareFunction Compare = nullptr;
+	int Quantity = 0;
+	bool Rescued = false; /// Only count the rescued units
+};
+
+/// Value of the game timer
+class CTimerCondition : public CTriggerCondition
+{
+public:
+	bool Check() const override { return Compare(GetTimer(), Cycles); }
+	bool IsAffectedBy(const CUnit &) const override { return false; }
+	bool IsTimer() const override { return true; }
+
+	CompareFunction Compare = nullptr;
+	int Cycles = 0;
+};
+
+/**
+**  Get the comparison function of a native condition.
+**
+**  @param l      Lua state.
+**  @param index  Index of the condition table.
+**  @param field  Index of the operation in the table.
+*/
+static CompareFunction CclGetConditionCompare(lua_State *l, int index, int field)
+{
+	const std::string_view op = LuaToString(l, index, field);
+	CompareFunction compare = GetCompareFunction(op);
+	if (!compare) {
+		LuaError(l, "Illegal comparison operation in trigger condition: %s", op.data());
+	}
+	return compare;
+}
+
+/**
+**  Parse a native trigger condition.
+**
+**  @param l      Lua state.
+**  @param index  Index of the condition table.
+**
+**  @return       The condition.
+*/
+static std::unique_ptr<CTriggerCondition> CclParseTriggerCondition(lua_State *l, int index)
+{
+	const std::string_view kind = LuaToString(l, index, 1);
+	const int args = lua_rawlen(l, index);
+
+	if (kind == "units-at") {
+		if (args != 7) {
+			LuaError(l, "incorrect argument");
+		}
+		auto condition = std::make_unique<CUnitsAtCondition>();
+		lua_rawgeti(l, index, 2);
+		condition->PlayerValidator = TriggerGetPlayer(l);
+		lua_pop(l, 1);
+		lua_rawgeti(l, index, 3);
+		condition->TypeValidator = TriggerGetUnitType(l);
+		lua_pop(l, 1);
+		lua_rawgeti(l, index, 4);
+		CclGetPos(l, &condition->MinPos);
+		lua_pop(l, 1);
+		lua_rawgeti(l, index, 5);
+		CclGetPos(l, &condition->MaxPos);
+		lua_pop(l, 1);
+		if (condition->MinPos.x > condition->MaxPos.x) {
+			std::swap(condition->MinPos.x, condition->MaxPos.x);
+		}
+		if (condition->MinPos.y > condition->MaxPos.y) {
+			std::swap(condition->MinPos.y, condition->MaxPos.y);
+		}
+		condition->Compare = CclGetConditionCompare(l, index, 6);
+		condition->Quantity = LuaToNumber(l, index, 7);
+		return condition;
+	} else if (kind == "near-unit" || kind == "rescued-near-unit") {
+		if (args != 6) {
+			LuaError(l, "incorrect argument");
+		}
+		auto condition = std::make_unique<CNearUnitCondition>();
+		condition->Rescued = kind == "rescued-near-unit";
+		lua_rawgeti(l, index, 2);
+		condition->PlayerValidator = TriggerGetPlayer(l);
+		lua_pop(l, 1);
+		condition->Compare = CclGetConditionCompare(l, index, 3);
+		condition->Quantity = LuaToNumber(l, index, 4);
+		lua_rawgeti(l, index, 5);
+		condition->TypeValidator = TriggerGetUnitType(l);
+		lua_pop(l, 1);
+		lua_rawgeti(l, index, 6);
+		condition->CenterType = CclGetUnitType(l);
+		lua_pop(l, 1);
+		if (!condition->CenterType) {
+			LuaError(l, "%s: not a unit-type valid", kind.data());
+		}
+		return condition;
+	} else if (kind == "timer") {
+		if (args != 3) {
+			LuaError(l, "incorrect argument");
+		}
+		auto condition = std::make_unique<CTimerCondition>();
+		condition->Compare = CclGetConditionCompare(l, index, 2);
+		condition->Cycles = LuaToNumber(l, index, 3);
+		return condition;
+	}
+	LuaError(l, "Unsupported trigger condition: %s", kind.data());
+	return nullptr;
+}
+
+/**
+**  Mark dirty the native conditions whose result a change of the unit can
+**  change. Called when the unit is placed or removed from the map, dies,
+**  is built, transformed or captured.
+**
+**  @param unit  Unit which changes.
+*/
+void TriggerUnitChanged(const CUnit &unit)
+{
+	for (auto &condition : NativeConditions) {
+		if (condition && !condition->Dirty && condition->IsAffectedBy(unit)) {
+			condition->Dirty = true;
+		}
+	}
+}
+
 /*---------------------------------------------------------------------------
 -- Actions
 ---------------------------------------------------------------------------*/
@@ -399,6 +598,9 @@ void ActionStopTimer()
 */
 static void TriggerRemoveTrigger(lua_State *l, int trig)
 {
+	if (trig < static_cast<int>(NativeConditions.size())) {
+		NativeConditions[trig].reset();
+	}
 	lua_pushnumber(l, -1);
 	lua_rawseti(l, -2, trig * 2 + 1);
 	lua_pushnumber(l, -1);
@@ -420,11 +622,27 @@ static void TriggerRemoveTrigger(lua_State *l, int trig)
 **			function() return (GetPlayerData(1,"UnitTypesCount","unit-farm") >= 4) end,
 **			function() return ActionVictory() end
 **		)</code></div>
+**
+**  The condition can also be declared as a table, which is evaluated by the
+**  engine and only checked again when a unit which can change its result
+**  is placed, removed, killed, built, transformed or captured:
+**
+**  <div class="example"><code><strong>AddTrigger</strong>(
+**			{"units-at", 0, "unit-footman", {10, 10}, {20, 20}, ">=", 4},
+**			function() return ActionVictory() end
+**		)</code></div>
+**
+**  The declared conditions are
+**  <code>{"units-at", player, unit-type, {x1, y1}, {x2, y2}, op, quantity}</code>,
+**  <code>{"near-unit", player, op, quantity, unit-type, center-unit-type}</code>,
+**  <code>{"rescued-near-unit", player, op, quantity, unit-type, center-unit-type}</code>
+**  and <code>{"timer", op, cycles}</code>, with the arguments of
+**  GetNumUnitsAt, IfNearUnit, IfRescuedNearUnit and GetTimer.
 */
 static int CclAddTrigger(lua_State *l)
 {
 	LuaCheckArgs(l, 2);
-	if (!lua_isfunction(l, 1)
+	if ((!lua_isfunction(l, 1) && !lua_istable(l, 1))
 		|| (!lua_isfunction(l, 2) && !lua_istable(l, 2))) {
 		LuaError(l, "incorrect argument");
 	}
@@ -448,6 +666,12 @@ static int CclAddTrigger(lua_State *l)
 		lua_pushnumber(l, -1);
 		lua_rawseti(l, -2, i + 2);
 	} else {
+		if (lua_istable(l, 1)) {
+			if (static_cast<int>(NativeConditions.size()) <= i / 2) {
+				NativeConditions.resize(i / 2 + 1);
+			}
+			NativeConditions[i / 2] = CclParseTriggerCondition(l, 1);
+		}
 		lua_pushvalue(l, 1);
 		lua_rawseti(l, -2, i + 1);
 		lua_newtable(l);
@@ -536,7 +760,22 @@ void TriggersEachCycle()
 		}
 
 		lua_rawgeti(Lua, -1, trigger * 2 + 1);
-		if (!lua_isnumber(Lua, -1)) {
+		if (lua_istable(Lua, -1)) {
+			CTriggerCondition *condition =
+				trigger < static_cast<int>(NativeConditions.size()) ? NativeConditions[trigger].get() : nullptr;
+			if (condition) {
+				if (condition->Dirty || condition->IsTimer()) {
+					condition->LastResult = condition->Check();
+					condition->Dirty = false;
+				}
+				if (condition->LastResult) {
+					lua_settop(Lua, base + 1);
+					if (TriggerExecuteAction(Lua, trigger)) {
+						TriggerRemoveTrigger(Lua, trigger);
+					}
+				}
+			}
+		} else if (!lua_isnumber(Lua, -1)) {
 			LuaCall(0, 0);
 			// If condition is true execute action
 			if (lua_gettop(Lua) > base + 1 && lua_toboolean(Lua, -1)) {
@@ -633,6 +872,7 @@ void CleanTriggers()
 	lua_setglobal(Lua, "Triggers");
 
 	ActiveTriggers.clear();
+	NativeConditions.clear();
 
 	GameTimer.Reset();
 }
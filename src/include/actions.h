@@ -196,6 +196,8 @@ extern void AnimateActionAttack(CUnit &unit, COrder &order);
 /// Parse order
 extern std::unique_ptr<COrder> CclParseOrder(lua_State *l, CUnit &unit);
 
+/// Call the batched callbacks of the unit-types for the locked units
+extern void UnitActionsBatchedCallback(size_t count, bool eachSecond);
 /// Handle the actions of all units each game cycle
 extern void UnitActions();
 
@@ -92,6 +92,8 @@ extern void AiTrainingComplete(CUnit &unit, CUnit &what);
 extern void AiUpgradeToComplete(CUnit &unit, const CUnitType &what);
 /// Called if AI unit has completed research
 extern void AiResearchComplete(CUnit &unit, const CUpgrade *what);
+/// Called if a unit was placed, moved, removed or changed, for the influence map
+extern void AiInfluenceUnitChanged(const CUnit &unit, bool removed = false);
 
 //@}
 
@@ -33,6 +33,7 @@
 //@{
 
 #include <map>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -71,6 +72,57 @@ enum class SetVar_ModifyTypes {
 SetVar_ModifyTypes toSetVar_ModifyTypes(std::string_view s);
 void modifyValue(SetVar_ModifyTypes mod, int &value, int rop);
 
+/**
+**  Integer operand of an animation, like "v.HitPoints.Value" or "p.this.Score".
+**
+**  The string is parsed once when the animation is defined, with the
+**  variable names resolved, so evaluating it has no string handling.
+*/
+class CAnimInt
+{
+public:
+	CAnimInt() = default;
+	CAnimInt(std::string_view s, lua_State *l);
+
+	/// Value of the operand for the unit running the animation
+	int Eval(const CUnit &unit) const;
+	/// Value of the operand without unit, only valid for numbers
+	int GetNumber() const;
+
+private:
+	enum class EKind : unsigned char {
+		Zero,            /// empty operand
+		Number,          /// number
+		Variable,        /// v.UnitVar.Field or t.UnitVar.Field
+		ResourcesHeld,   /// v.ResourcesHeld.*
+		ResourceActive,  /// v.ResourceActive.*
+		Distance,        /// t._Distance.*
+		BoolFlag,        /// b.BoolVar or g.BoolVar
+		Spell,           /// s.SpellName
+		AutoCast,        /// S.SpellName
+		PlayerData,      /// p.player.prop[.arg]
+		Player,          /// l.player
+		Random,          /// r.max or r.min.max
+		UnitSelf,        /// U
+		Goal,            /// G
+		Rotate,          /// R
+		RemainingWay     /// W
+	};
+	enum class EField : unsigned char {Value, Max, Increase, Enable, Percent};
+
+	const CUnit *GetUnit(const CUnit &unit) const;
+	int GetPlayer(const CUnit &unit) const;
+
+	EKind Kind = EKind::Zero;
+	EField Field = EField::Value;
+	bool OnGoal = false;         /// Read the goal of the current order instead of the unit
+	int Index = 0;               /// Variable or bool flag index, number, random minimum
+	int Max = 0;                 /// Random maximum
+	std::string Name;            /// Spell ident or player property
+	std::string Arg;             /// Player property argument
+	std::unique_ptr<CAnimInt> PlayerOperand; /// Player of PlayerData and Player, "this" if null
+};
+
 class CAnimation
 {
 public:
@@ -127,8 +179,6 @@ extern int UnitShowAnimationScaled(CUnit &unit,
 extern int UnitShowAnimation(CUnit &unit, const std::vector<std::unique_ptr<CAnimation>> *anims);
 
 
-extern int ParseAnimInt(const CUnit &unit, std::string_view parseint);
-
 extern void FindLabelLater(std::size_t *labelIndex, std::string name);
 
 extern void FreeAnimations();
@@ -42,10 +42,8 @@ class CAnimation_ExactFrame : public CAnimation
 	void Init(std::string_view s, lua_State *l) override;
 	std::optional<int> GetStillFrame(const CUnitType &type) override;
 
-	int ParseAnimInt(const CUnit *unit) const;
-
 private:
-	std::string frame;
+	CAnimInt frame;
 };
 
 //@}
@@ -42,7 +42,7 @@ class CAnimation_Move : public CAnimation
 	void Init(std::string_view s, lua_State *l) override;
 
 private:
-	std::string moveStr;
+	CAnimInt moveValue;
 };
 
 //@}
@@ -42,7 +42,7 @@ class CAnimation_RandomRotate : public CAnimation
 	void Init(std::string_view s, lua_State *l) override;
 
 private:
-	std::string rotateStr;
+	CAnimInt rotate;
 };
 
 //@}
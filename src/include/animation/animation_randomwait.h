@@ -42,8 +42,8 @@ class CAnimation_RandomWait : public CAnimation
 	void Init(std::string_view s, lua_State *l) override;
 
 private:
-	std::string minWait;
-	std::string maxWait;
+	CAnimInt minWait;
+	CAnimInt maxWait;
 };
 
 //@}
@@ -42,7 +42,8 @@ class CAnimation_Rotate : public CAnimation
 	void Init(std::string_view s, lua_State *l) override;
 
 private:
-	std::string rotateStr;
+	bool toTarget = false;
+	CAnimInt rotate;
 };
 
 extern void UnitRotate(CUnit &unit, int rotate);
@@ -43,10 +43,10 @@ class CAnimation_SetPlayerVar : public CAnimation
 
 private:
 	SetVar_ModifyTypes mod;
-	std::string playerStr;
+	CAnimInt player;
 	std::string varStr;
 	std::string argStr;
-	std::string valueStr;
+	CAnimInt value;
 };
 
 extern int GetPlayerData(int player, std::string_view prop, std::string_view arg);
@@ -45,6 +45,7 @@ class CAnimation_SetVar : public CAnimation
 	SetVar_ModifyTypes mod;
 	std::string varStr;
 	std::string valueStr;
+	CAnimInt value; /// valueStr, parsed when varStr has a tag
 	std::string unitSlotStr;
 };
 
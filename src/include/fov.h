@@ -35,6 +35,8 @@
 #include <functional>
 #include <queue>
 #include <set>
+#include <unordered_map>
+#include <vector>
 #include "vec2i.h"
 #include "map.h"
 #include "tileset.h"
@@ -48,11 +50,23 @@ class CFieldOfView
 	void Clean()
 	{
 		MarkedTilesCache.clear();
+		VisibleSets.clear();
 	}
 
 	/// Refresh field of view
 	void Refresh(const CPlayer &player, const CUnit &unit, const Vec2i &pos, const uint16_t width,
 				 const uint16_t height, const uint16_t range, MapMarkerFunc *marker);
+	/// Check if the fields of view may be moved instead of refreshed
+	bool CanMove() const;
+	/// Move field of view, only (un)marking the tiles which leave or enter it
+	void Move(const CPlayer &player, const CUnit &unit, const Vec2i &oldPos, const Vec2i &newPos,
+			  const uint16_t width, const uint16_t height, const uint16_t range,
+			  MapMarkerFunc *marker, MapMarkerFunc *unmarker,
+			  MapMarkerFunc *marker2 = nullptr, MapMarkerFunc *unmarker2 = nullptr);
+	/// Forget the visible sets kept for a unit
+	void ForgetUnit(const CUnit &unit);
+	/// Opacity or elevation of some tiles has changed
+	void TerrainChanged() { ++TerrainGeneration; }
 
 	bool SetType(const FieldOfViewTypes fov_type);
 	FieldOfViewTypes GetType() const;
@@ -73,9 +87,33 @@ class CFieldOfView
 		Vec2i BottomVector;
 	};
 
+	/// Tiles seen by shadow casting from a position, kept to be diffed when the unit moves
+	struct SVisibleSet {
+		Vec2i Pos {-1, -1};
+		uint16_t Width {0};
+		uint16_t Height {0};
+		uint16_t Range {0};
+		uint16_t OpaqueFields {0};
+		unsigned long TerrainGeneration {0};
+		std::vector<unsigned int> Tiles; /// Sorted tile indexes
+	};
+
 	/// Calc whole simple radial field of view
 	void ProceedSimpleRadial(const CPlayer &player, const Vec2i &pos, const int16_t w, const int16_t h,
 							 int16_t range, MapMarkerFunc *marker) const;
+	/// Calc the tiles leaving and entering a simple radial field of view
+	void ProceedSimpleRadialMove(const Vec2i &oldPos, const Vec2i &newPos, const int16_t w, const int16_t h,
+								 const int16_t range);
+	/// Calc the tiles leaving and entering a shadow casting field of view
+	void ProceedShadowCastingMove(const CUnit &unit, const Vec2i &oldPos, const Vec2i &newPos,
+								  const uint16_t width, const uint16_t height, const uint16_t range);
+	/// Collect the tiles seen by shadow casting
+	void CollectShadowCasting(const CUnit &unit, const Vec2i &pos, const uint16_t width,
+							  const uint16_t height, const uint16_t range, std::vector<unsigned int> &tiles);
+	/// Check if the unit sees with the shadow casting
+	bool UseShadowCasting(const CUnit &unit) const;
+	/// Opaque fields for the shadow casting of the unit
+	uint16_t GetUnitOpaqueFields(const CUnit &unit) const;
 	/// Calc whole chadow casting field of view
 	void ProceedShadowCasting(const Vec2i &spectatorPos, const uint16_t width, const uint16_t height, const uint16_t range);
 	/// Calc field of view for set of lines along x or y.
@@ -126,6 +164,13 @@ class CFieldOfView
 	std::vector<uint8_t> MarkedTilesCache;	/// To prevent multiple calls of map_setFoV for single tile (for tiles on the vertical,
 											/// horizontal and diagonal lines it calls twise) we use cache table to
 											/// count already marked tiles
+	std::vector<unsigned int> *CollectedTiles {nullptr}; /// When set, marked tiles are collected instead
+
+	std::unordered_map<const CUnit *, std::vector<SVisibleSet>> VisibleSets; /// Last visible sets of the moving units, by range
+	unsigned long TerrainGeneration {0};	/// Incremented when the visible sets are no longer valid
+	std::vector<unsigned int> PreviousTiles;/// Visible set before the move
+	std::vector<unsigned int> LeavingTiles;	/// Tiles leaving the field of view on Move
+	std::vector<unsigned int> EnteringTiles;/// Tiles entering the field of view on Move
 };
 
 /*----------------------------------------------------------------------------
@@ -163,7 +208,11 @@ inline void CFieldOfView::MarkTile()
 {
 	const size_t index = Map.getIndex(currTilePos.x, currTilePos.y);
 	if (!MarkedTilesCache[index]) {
-		map_setFoV(*Player, index);
+		if (CollectedTiles) {
+			CollectedTiles->push_back(index);
+		} else {
+			map_setFoV(*Player, index);
+		}
 		MarkedTilesCache[index] = 1;
 	}
 }
@@ -37,6 +37,8 @@ class CFile;
 
 extern void LoadGame(const fs::path &filename); /// Load saved game
 extern int SaveGame(const std::string &filename); /// Save game
+extern bool SaveGameAsync(const std::string &filename); /// Save game, written by a worker thread
+extern int WaitSaveGame(); /// Wait for the save game written by a worker thread
 extern void DeleteSaveGame(const std::string &filename); /// Delete save game
 extern bool SaveGameLoading;                 /// Save game is in progress of loading
 
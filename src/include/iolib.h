@@ -40,6 +40,7 @@
 
 #include <SDL.h>
 #include <memory>
+#include <string>
 #include <vector>
 
 /*----------------------------------------------------------------------------
@@ -114,6 +115,8 @@ class CFile
 	int close();
 	void flush();
 	int read(void *buf, size_t len);
+	int write(const void *buf, size_t len);
+	std::string takeBuffer();
 	int seek(long offset, int whence);
 	long tell();
 	static SDL_RWops *to_SDL_RWops(std::unique_ptr<CFile> file);
@@ -128,6 +131,7 @@ class CFile
 #define CL_OPEN_WRITE 0x2
 #define CL_WRITE_GZ 0x4
 #define CL_WRITE_BZ2 0x8
+#define CL_WRITE_MEMORY 0x10 /// kept in memory, see CFile::takeBuffer
 
 /*----------------------------------------------------------------------------
 --  Functions
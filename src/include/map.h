@@ -83,6 +83,7 @@
 ----------------------------------------------------------------------------*/
 
 #include <string>
+#include <vector>
 
 #ifndef __MAP_TILE_H__
 #include "tile.h"
@@ -149,6 +150,93 @@ class CMapInfo
 	bool HighgroundsEnabled = false;	/// Map has highgrounds
 };
 
+/*----------------------------------------------------------------------------
+--  Unit buckets
+----------------------------------------------------------------------------*/
+
+/**
+**  Coarse grid of the units on the map, by cells of CellSize x CellSize tiles.
+**
+**  A unit is in each cell its tiles overlap. Used to find the units of a
+**  large area without looking at each tile (see ForEachUnitInArea).
+*/
+class CUnitBucketGrid
+{
+public:
+	static constexpr int CellSize = 8;
+
+	void Clear();
+	void Insert(CUnit &unit);
+	void Remove(CUnit &unit);
+
+	bool empty() const { return Cells.empty(); }
+	int GetWidth() const { return Width; }
+	int GetHeight() const { return Height; }
+	const std::vector<CUnit *> &GetCell(int x, int y) const { return Cells[x + y * Width]; }
+
+private:
+	int Width = 0;   /// Number of cells by row
+	int Height = 0;  /// Number of cells by column
+	std::vector<std::vector<CUnit *>> Cells; /// Units of each cell
+};
+
+/**
+**  Visibility counters of the players, one dense plane by player.
+**
+**  Visible counts how many units of the player can see a field: 0 the
+**  field is not explored, 1 explored, n-1 units see it. The explored
+**  (Visible != 0) and visible (Visible >= 2) states are also kept as
+**  bitsets, so the fog of war can be computed 64 fields at a time.
+*/
+class CMapVisibility
+{
+public:
+	void Resize(unsigned int size);
+	void Clear();
+
+	unsigned short GetVisible(int player, unsigned int index) const { return VisiblePlanes[player][index]; }
+	void SetVisible(int player, unsigned int index, unsigned short value)
+	{
+		VisiblePlanes[player][index] = value;
+		SetBit(ExploredBits[player], index, value != 0);
+		SetBit(VisibleBits[player], index, value >= 2);
+	}
+	/// Check if the field is explored by the player
+	bool IsExplored(int player, unsigned int index) const { return GetBit(ExploredBits[player], index); }
+	/// Check if units of the player see the field (ignoring Map.NoFogOfWar)
+	bool IsVisible(int player, unsigned int index) const { return GetBit(VisibleBits[player], index); }
+	/// Explored bits of the fields [64 * word, 64 * word + 63]
+	uint64_t GetExploredWord(int player, unsigned int word) const { return ExploredBits[player][word]; }
+	/// Visible bits of the fields [64 * word, 64 * word + 63]
+	uint64_t GetVisibleWord(int player, unsigned int word) const { return VisibleBits[player][word]; }
+
+	unsigned char &VisCloak(int player, unsigned int index) { return VisCloakPlanes[player][index]; }
+	unsigned char VisCloak(int player, unsigned int index) const { return VisCloakPlanes[player][index]; }
+	unsigned char &Radar(int player, unsigned int index) { return RadarPlanes[player][index]; }
+	unsigned char Radar(int player, unsigned int index) const { return RadarPlanes[player][index]; }
+	unsigned char &RadarJammer(int player, unsigned int index) { return RadarJammerPlanes[player][index]; }
+	unsigned char RadarJammer(int player, unsigned int index) const { return RadarJammerPlanes[player][index]; }
+
+private:
+	static bool GetBit(const std::vector<uint64_t> &bits, unsigned int index)
+	{
+		return (bits[index / 64] >> (index % 64)) & 1;
+	}
+	static void SetBit(std::vector<uint64_t> &bits, unsigned int index, bool value)
+	{
+		const uint64_t mask = uint64_t(1) << (index % 64);
+		bits[index / 64] = value ? bits[index / 64] | mask : bits[index / 64] & ~mask;
+	}
+
+private:
+	std::vector<unsigned short> VisiblePlanes[PlayerMax];    /// Seen counter 0 unexplored
+	std::vector<unsigned char> VisCloakPlanes[PlayerMax];    /// Visiblity for cloaking
+	std::vector<unsigned char> RadarPlanes[PlayerMax];       /// Visiblity for radar
+	std::vector<unsigned char> RadarJammerPlanes[PlayerMax]; /// Jamming capabilities
+	std::vector<uint64_t> ExploredBits[PlayerMax];           /// Visible != 0, 64 fields by word
+	std::vector<uint64_t> VisibleBits[PlayerMax];            /// Visible >= 2, 64 fields by word
+};
+
 /*----------------------------------------------------------------------------
 --  Map itself
 ----------------------------------------------------------------------------*/
@@ -201,7 +289,12 @@ class CMap
 	/// Set map reveal mode: hidden/known/fully explored.
 	void Reveal(MapRevealModes mode = MapRevealModes::cKnown);
 	/// Save the map.
-	void Save(CFile &file) const;
+	void Save(CFile &file, CFile *fieldsFile = nullptr, const std::string &fieldsFileName = {}) const;
+	/// Save the fields in a binary file.
+	bool SaveFields(CFile &file) const;
+	bool SaveFields(const fs::path &fieldsFile) const;
+	/// Load the fields from a binary file.
+	bool LoadFields(const fs::path &fieldsFile);
 
 	//
 	// Wall
@@ -256,6 +349,8 @@ class CMap
 
 public:
 	std::vector<CMapField> Fields; /// fields on map
+	CUnitBucketGrid UnitBuckets;   /// units on map, by cells of tiles
+	CMapVisibility Visibility;     /// visibility of the fields by player
 	bool NoFogOfWar = false;     /// fog of war disabled
 
 	CTileset *Tileset = nullptr; /// tileset data
@@ -307,6 +402,15 @@ extern MapMarkerFunc MapUnmarkTileDetectCloak;
 /// Mark sight changes
 extern void MapSight(const CPlayer &player, const CUnit &unit, const Vec2i &pos, int w,
 					 int h, int range, MapMarkerFunc *marker);
+/// Check if the sight of a moving unit may be moved instead of unmarked and marked again
+extern bool MapCanMoveSight();
+/// Move sight, only (un)marking the tiles which leave or enter it
+extern void MapSightMove(const CPlayer &player, const CUnit &unit, const Vec2i &oldPos,
+						 const Vec2i &newPos, int w, int h, int range,
+						 MapMarkerFunc *marker, MapMarkerFunc *unmarker,
+						 MapMarkerFunc *marker2 = nullptr, MapMarkerFunc *unmarker2 = nullptr);
+/// Forget what is kept of the sight of a unit
+extern void MapSightForget(const CUnit &unit);
 /// Update fog of war
 extern void UpdateFogOfWarChange();
 
@@ -374,6 +478,8 @@ extern bool UnitCanBeAt(const CUnit &unit, const Vec2i &pos);
 
 /// Preprocess map, for internal use.
 extern void PreprocessMap();
+/// Terrain of an area has changed
+extern void MapTerrainChanged(const Vec2i &pos, const Vec2i &size);
 
 // in unit.c
 //using MapClearField = void(const Vec2i &tilePos);
@@ -35,6 +35,7 @@
 #include <vector>
 
 #include "settings.h"
+#include "synchash.h"
 
 /*----------------------------------------------------------------------------
 --  Declarations
@@ -403,6 +404,7 @@ enum _message_type_ {
 	MessageCommandCancelResearch,  /// Unit command cancel research
 
 	MessageExtendedCommand,        /// Command is the next byte
+	MessageSyncBuckets,            /// Strong sync hash buckets, sent after a desync
 
 	// ATTN: __MUST__ be last due to spellid encoding!!!
 	MessageCommandSpellCast        /// Unit command spell cast
@@ -480,14 +482,30 @@ class CNetworkChat
 class CNetworkCommandSync
 {
 public:
-	CNetworkCommandSync() : syncSeed(0), syncHash(0) {}
+	CNetworkCommandSync() : syncSeed(0), syncHash(0), strongHash(0) {}
 	size_t Serialize(unsigned char *buf) const;
 	size_t Deserialize(const unsigned char *buf);
-	static size_t Size() { return 4 + 4; };
+	static size_t Size() { return 4 + 4 + 4; };
 
 public:
 	uint32_t syncSeed;
 	uint32_t syncHash;
+	uint32_t strongHash;  /// Strong sync hash, 0 if not computed
+};
+
+/**
+**  Network strong sync hash buckets message.
+*/
+class CNetworkSyncBuckets
+{
+public:
+	size_t Serialize(unsigned char *buf) const;
+	size_t Deserialize(const unsigned char *buf);
+	static size_t Size() { return 1 + 4 + 2 * (SyncHashRegionCount + SyncHashUnitRangeCount + PlayerMax); }
+
+public:
+	uint8_t player = 0;        /// Sender
+	SyncHashBuckets Buckets;   /// Buckets of the cycle of the desync
 };
 
 /**
@@ -59,6 +59,7 @@ class Parameters
 	std::string luaScriptArguments;
 	std::string LocalPlayerName;        /// Name of local player
 	bool benchmark = false;             /// If true, run as fast as possible and report fps at the end of a game
+	fs::path headlessReplay;            /// If set, run this replay without display as fast as possible and report timings
 private:
 	fs::path userDirectory;          /// Directory containing user settings and data
 public:
@@ -42,8 +42,11 @@
 --  Declarations
 ----------------------------------------------------------------------------*/
 
-#include <queue>
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <sys/types.h>
+#include <vector>
 #include "vec2i.h"
 
 class CUnit;
@@ -77,9 +80,12 @@ class PathFinderInput
 	int GetMinRange() const { return minRange; }
 	int GetMaxRange() const { return maxRange; }
 	bool IsRecalculateNeeded() const { return isRecalculatePathNeeded; }
+	const CUnit *GetHarvestMine() const { return harvestMine; }
+	const CUnit *GetHarvestDepot() const { return harvestDepot; }
 
 	void SetUnit(CUnit &_unit);
 	void SetGoal(const Vec2i &pos, const Vec2i &size);
+	void SetHarvestRoute(const CUnit *mine, const CUnit *depot);
 	void SetMinRange(int range);
 	void SetMaxRange(int range);
 
@@ -96,6 +102,8 @@ class PathFinderInput
 	int minRange;
 	int maxRange;
 	bool isRecalculatePathNeeded;
+	const CUnit *harvestMine = nullptr;  /// Mine of the harvest trip, the goal is it or the depot
+	const CUnit *harvestDepot = nullptr; /// Depot of the harvest trip
 };
 
 class PathFinderOutput
@@ -118,11 +126,43 @@ class PathFinderOutput
 	char Path[MAX_PATH_LENGTH];     /// directions of stored path
 };
 
+/**
+**  Path found ahead by PathfinderPrefetchPaths, used by the next
+**  NextPathElement of the same cycle if the request is still the same.
+*/
+class PathFinderPrefetch
+{
+public:
+	bool Valid = false;             /// Whether a path was searched
+	unsigned long Cycle = 0;        /// Game cycle of the search
+	Vec2i StartPos;                 /// Unit position
+	Vec2i GoalPos;                  /// Goal position
+	Vec2i GoalSize;                 /// Goal size
+	int MinRange = 0;               /// Minimal range to the goal
+	int MaxRange = 0;               /// Maximal range to the goal
+	int Result = PF_FAILED;         /// Result of AStarFindPath
+	char Path[PathFinderOutput::MAX_PATH_LENGTH]; /// Path found
+};
+
 class PathFinderData
 {
 public:
 	PathFinderInput input;
 	PathFinderOutput output;
+	PathFinderPrefetch prefetch; /// not saved, only valid during one cycle
+};
+
+/// A path request solved by AStarFindPathBatch
+struct AStarRequest {
+	const CUnit *Unit = nullptr;    /// Unit to move
+	Vec2i StartPos;                 /// Unit position
+	Vec2i UnitSize;                 /// Unit size
+	Vec2i GoalPos;                  /// Goal position
+	Vec2i GoalSize;                 /// Goal size
+	int MinRange = 0;               /// Minimal range to the goal
+	int MaxRange = 0;               /// Maximal range to the goal
+	int Result = PF_FAILED;         /// Output: same as AStarFindPath
+	char Path[PathFinderOutput::MAX_PATH_LENGTH]; /// Output: the path
 };
 
 
@@ -142,6 +182,11 @@ class TerrainTraversal
 public:
 	using dataType = short int;
 public:
+	TerrainTraversal();
+	TerrainTraversal(const TerrainTraversal &) = delete;
+	TerrainTraversal &operator=(const TerrainTraversal &) = delete;
+	~TerrainTraversal();
+
 	void SetSize(unsigned int width, unsigned int height);
 	void Init();
 
@@ -163,24 +208,31 @@ class TerrainTraversal
 	void Set(const Vec2i &pos, dataType value);
 
 	struct PosNode {
+		PosNode() = default;
 		PosNode(const Vec2i &pos, const Vec2i &from) : pos(pos), from(from) {}
 		Vec2i pos;
 		Vec2i from;
 	};
+	struct Storage;
+
+	void PushNode(const Vec2i &pos, const Vec2i &from);
+	bool PopNode(PosNode &node);
 
 private:
-	std::vector<dataType> m_values;
-	std::queue<PosNode> m_queue;
-	unsigned int m_extented_width;
-	unsigned int m_height;
+	std::unique_ptr<Storage> m_storage; /// values and queue, reused by the next traversals
+	unsigned int m_extented_width = 0;
+	unsigned int m_height = 0;
+
+	/// storages of the destroyed traversals
+	static thread_local std::vector<std::unique_ptr<Storage>> s_storagePool;
 };
 
 template <typename T>
 bool TerrainTraversal::Run(T &context)
 {
-	for (; m_queue.empty() == false; m_queue.pop()) {
-		const PosNode &posNode = m_queue.front();
+	PosNode posNode;
 
+	while (PopNode(posNode)) {
 		switch (context.Visit(*this, posNode.pos, posNode.from)) {
 			case VisitResult::Finished: return true;
 			case VisitResult::DeadEnd: Set(posNode.pos, -1); break;
@@ -207,6 +259,20 @@ extern bool AStarKnowUnseenTerrain;
 extern int AStarUnknownTerrainCost;
 /// Maximum number of iterations of A* before giving up.
 extern int AStarMaxSearchIterations;
+/// Whether long paths are planned on the hierarchical (cluster) graph first
+extern bool AStarHierarchical;
+/// Minimal distance (in tiles) to the goal to use the hierarchical graph
+extern int AStarHierarchicalMinDistance;
+/// Whether units moving to the same tile share a flow field
+extern bool AStarFlowField;
+/// Whether the harvesters share the routes between their mine and their depot
+extern bool AStarHarvestRoutes;
+/// Whether the depots and the forest are found on distance fields
+extern bool AStarDistanceFields;
+/// Whether the paths needed in a cycle are searched together before the unit actions
+extern bool AStarBatch;
+/// Number of threads searching the batched paths (local setting, doesn't change the results)
+extern int AStarThreads;
 
 //
 //  Convert heading into direction.
@@ -234,6 +300,10 @@ extern int CalcPathLengthToUnit(const CUnit &src, const CUnit &dst,
 /// Can the unit 'src' reach the place x,y
 extern int PlaceReachable(const CUnit &src, const Vec2i &pos, int w, int h,
 						  int minrange, int maxrange, bool from_outside_container);
+/// Static obstacles (terrain, walls, buildings) of an area have changed
+extern void PathfinderTerrainChanged(const Vec2i &pos, const Vec2i &size);
+/// Search ahead the paths the units will ask for in this cycle
+extern void PathfinderPrefetchPaths(const std::vector<CUnit *> &units);
 
 //
 // in astar.cpp
@@ -251,8 +321,87 @@ extern int GetAStarUnknownTerrainCost();
 extern void SetAStarFixedEnemyUnitsUnpassable(const bool value);
 extern bool GetAStarFixedEnemyUnitsUnpassable();
 
+/// Solve several path requests at once on the worker threads
+extern void AStarFindPathBatch(std::vector<AStarRequest> &requests);
+
 extern void PathfinderCclRegister();
 
+//
+// in hierarchical.cpp
+//
+
+/// Init the hierarchical pathfinder
+extern void InitHierarchicalPathfinder(int mapWidth, int mapHeight);
+/// Free the hierarchical pathfinder
+extern void FreeHierarchicalPathfinder();
+/// Mark the clusters of an area as dirty
+extern void HierarchicalPathfinderAreaChanged(const Vec2i &pos, const Vec2i &size);
+/// Plan a long path on the cluster graph, returns the waypoints to go through
+extern bool HierarchicalFindPath(const Vec2i &startPos, const Vec2i &goalPos, int movementMask,
+								 std::vector<Vec2i> &waypoints);
+
+//
+// in flowfield.cpp
+//
+
+/// Init the flow fields
+extern void InitFlowFields(int mapWidth, int mapHeight);
+/// Free the flow fields
+extern void FreeFlowFields();
+/// Drop the flow fields after a change of the static obstacles
+extern void FlowFieldsTerrainChanged();
+/// Read a path from the flow field shared by the units moving to goalPos
+extern int FlowFieldFindPath(const Vec2i &startPos, const Vec2i &goalPos, int movementMask,
+							 char *path, int pathLen);
+/// Check if units moving to goalPos will use a flow field
+extern bool FlowFieldHasGoal(const Vec2i &goalPos, int movementMask);
+
+//
+// in harvestroutes.cpp
+//
+
+/// Free the harvest routes
+extern void FreeHarvestRoutes();
+/// Drop the harvest routes around an area whose static obstacles have changed
+extern void HarvestRoutesTerrainChanged(const Vec2i &pos, const Vec2i &size);
+/// Check if the harvesters of a mine and a depot have a route
+extern bool HarvestRouteHasRoute(const CUnit &mine, const CUnit &depot, int movementMask);
+/// Read a path from the route between the mine and the depot of a harvester
+extern int HarvestRouteFindPath(const CUnit &unit, const CUnit &mine, const CUnit &depot, bool toDepot,
+								char *path, int pathLen);
+
+//
+// in distancefields.cpp
+//
+
+/// Init the distance fields
+extern void InitDistanceFields(int mapWidth, int mapHeight);
+/// Free the distance fields
+extern void FreeDistanceFields();
+/// Update the distance fields around an area whose static obstacles have changed
+extern void DistanceFieldsTerrainChanged(const Vec2i &pos, const Vec2i &size);
+/// Update the distance fields where a unit is a depot
+extern void DistanceFieldsUnitChanged(const CUnit &unit, bool removed = false);
+/// Find the nearest depot of a worker, nothing if the fields can't be used
+extern std::optional<CUnit *> DistanceFieldFindDeposit(const CUnit &worker, int range, int resource);
+/// Find the nearest forest tile, nothing if the fields can't be used
+extern std::optional<bool> DistanceFieldFindForest(const Vec2i &startPos, int movementMask, int range,
+												   Vec2i *forestPos);
+
+//
+// in reachability.cpp
+//
+
+/// Init the connected components
+extern void InitReachability(int mapWidth, int mapHeight);
+/// Free the connected components
+extern void FreeReachability();
+/// Update the connected components of an area
+extern void ReachabilityAreaChanged(const Vec2i &pos, const Vec2i &size);
+/// Return false if no tile of the area is in the same component as startPos
+extern bool ReachabilityMayReach(const Vec2i &startPos, const Vec2i &topLeft,
+								 const Vec2i &bottomRight, int movementMask);
+
 //@}
 
 #endif // !__PATH_FINDER_H__
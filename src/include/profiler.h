@@ -0,0 +1,99 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name profiler.h - The game loop profiler header file. */
+//
+//      (c) Copyright 2026 by the Stratagus Team
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#ifndef __PROFILER_H__
+#define __PROFILER_H__
+
+//@{
+
+/*----------------------------------------------------------------------------
+--  Includes
+----------------------------------------------------------------------------*/
+
+#include "filesystem.h"
+
+#include <cstdint>
+
+/*----------------------------------------------------------------------------
+--  Declarations
+----------------------------------------------------------------------------*/
+
+/**
+**  The profiler records the time spent in scoped zones into a ring
+**  buffer, which can be saved as a Chrome trace (chrome://tracing or
+**  https://ui.perfetto.dev) to look at the stalls offline.
+**
+**  It is only compiled with USE_PROFILER (cmake -DENABLE_PROFILER=ON),
+**  otherwise PROFILE_ZONE and PROFILE_ZONE_ARG expand to nothing.
+**
+**  The zone names must be string literals, only the pointer is kept.
+*/
+#ifdef USE_PROFILER
+
+/// Record the time spent in the enclosing scope
+class CProfileZone
+{
+public:
+	explicit CProfileZone(const char *name, long arg = -1);
+	~CProfileZone();
+
+	CProfileZone(const CProfileZone &) = delete;
+	CProfileZone &operator=(const CProfileZone &) = delete;
+
+private:
+	const char *Name; /// Name of the zone
+	long Arg;         /// Argument shown with the zone (player, cycle...), -1 if none
+	int64_t Start;    /// Start time in ns since the profiler start
+};
+
+#define PROFILE_ZONE_CONCAT_(a, b) a##b
+#define PROFILE_ZONE_CONCAT(a, b) PROFILE_ZONE_CONCAT_(a, b)
+/// Profile the enclosing scope
+#define PROFILE_ZONE(name) CProfileZone PROFILE_ZONE_CONCAT(profileZone, __LINE__)(name)
+/// Profile the enclosing scope, with an argument (player index, cycle...)
+#define PROFILE_ZONE_ARG(name, arg) CProfileZone PROFILE_ZONE_CONCAT(profileZone, __LINE__)(name, long(arg))
+
+#else
+
+#define PROFILE_ZONE(name)
+#define PROFILE_ZONE_ARG(name, arg)
+
+#endif
+
+/*----------------------------------------------------------------------------
+--  Functions
+----------------------------------------------------------------------------*/
+
+/// Save the recorded zones as a Chrome trace, in the logs directory when no file is given
+extern bool SaveProfile(fs::path filename = {});
+/// Register ccl functions related to the profiler
+extern void ProfilerCclRegister();
+
+//@}
+
+#endif // !__PROFILER_H__
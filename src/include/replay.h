@@ -35,7 +35,12 @@
 --  Includes
 ----------------------------------------------------------------------------*/
 
+#include "vec2i.h"
+
+#include <cstdint>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 /*----------------------------------------------------------------------------
 --  Declarations
@@ -50,6 +55,61 @@ enum class EReplayType {
 class CFile;
 class CUnit;
 
+/**
+**  LogEntry structure.
+*/
+class LogEntry
+{
+public:
+	LogEntry() = default;
+
+	unsigned long GameCycle = 0;
+	int UnitNumber = 0;
+	std::string UnitIdent;
+	std::string Action;
+	int Flush = 0;
+	Vec2i Pos{0, 0};
+	int DestUnitNumber = 0;
+	std::string Value;
+	int Num = 0;
+	unsigned SyncRandSeed = 0;
+};
+
+/**
+**  Binary form of the replay commands.
+**
+**  Each command is: the cycle delta to the previous command, a mask of
+**  the optional fields, then the fields as (zigzag) varints. The strings
+**  (action, unit ident, value) are interned: their first use is followed
+**  by their content, the next ones only give their number.
+*/
+class CReplayCommandWriter
+{
+public:
+	void Write(const LogEntry &log, std::string &out);
+
+private:
+	void WriteString(const std::string &s, std::string &out);
+
+private:
+	std::unordered_map<std::string, uint64_t> Strings; /// Number of the strings already written
+	unsigned long LastCycle = 0;                       /// Cycle of the previous command
+};
+
+/// Reader of the commands written by CReplayCommandWriter
+class CReplayCommandReader
+{
+public:
+	bool Read(const unsigned char *&p, const unsigned char *end, LogEntry &log);
+
+private:
+	bool ReadString(const unsigned char *&p, const unsigned char *end, std::string &s);
+
+private:
+	std::vector<std::string> Strings; /// Strings already read
+	unsigned long LastCycle = 0;      /// Cycle of the previous command
+};
+
 /*----------------------------------------------------------------------------
 --  Variables
 ----------------------------------------------------------------------------*/
@@ -68,6 +128,8 @@ extern void CommandLog(const char *action, const CUnit *unit, int flush,
 extern void SinglePlayerReplayEachCycle();
 /// Replay user commands from log each cycle, multiplayer games
 extern void MultiPlayerReplayEachCycle();
+/// Write the buffered commands to the log
+extern void FlushReplayLog();
 /// End logging
 extern void EndReplayLog();
 /// Clean replay
@@ -78,6 +140,10 @@ extern void SaveReplayList(CFile &file);
 extern void ReplayCclRegister();
 
 extern bool IsReplayGame();
+/// Check if all the commands of the replay have been run
+extern bool IsReplayFinished();
+/// Load a replay and start its game
+extern void StartReplay(const std::string &filename, bool reveal);
 
 //@}
 
@@ -0,0 +1,113 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name synchash.h - The strong sync hash header file. */
+//
+//      (c) Copyright 2026 by the Stratagus Team
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#ifndef __SYNCHASH_H__
+#define __SYNCHASH_H__
+
+//@{
+
+/*----------------------------------------------------------------------------
+--  Includes
+----------------------------------------------------------------------------*/
+
+#include "settings.h"
+
+#include <cstdint>
+#include <vector>
+
+/*----------------------------------------------------------------------------
+--  Declarations
+----------------------------------------------------------------------------*/
+
+class CUnit;
+
+/// Number of map regions on each axis
+constexpr int SyncHashRegionSide = 8;
+/// Number of map region buckets
+constexpr int SyncHashRegionCount = SyncHashRegionSide * SyncHashRegionSide;
+/// Number of unit slot range buckets
+constexpr int SyncHashUnitRangeCount = 64;
+/// Number of unit slots in each range, the ranges wrap around
+constexpr int SyncHashUnitRangeSize = 16;
+
+/**
+**  Folded hashes of the buckets, exchanged between the peers to find
+**  where their games differ.
+*/
+struct SyncHashBuckets {
+	unsigned long Cycle = 0;                   /// Game cycle of the hashes
+	uint16_t Regions[SyncHashRegionCount]{};   /// Hash of the units in each map region
+	uint16_t Units[SyncHashUnitRangeCount]{};  /// Hash of the units in each slot range
+	uint16_t Players[PlayerMax]{};             /// Hash of the resources of each player
+};
+
+/**
+**  Hash of the state of the units (position, hit points, orders...) and
+**  of the player resources.
+**
+**  Each unit contributes an hash of its state to the bucket of its map
+**  region and to the one of its slot range. The buckets are xors of the
+**  contributions, so only the units which have changed are updated and
+**  the hash only depends on the current state of the game.
+*/
+class CSyncHash
+{
+public:
+	void Clear();
+	void UpdateUnit(const CUnit &unit);
+	void EndCycle();
+
+	uint32_t GetHash() const;
+	void GetBuckets(SyncHashBuckets &buckets) const;
+	void PrintDifferences(const SyncHashBuckets &local, const SyncHashBuckets &remote) const;
+
+private:
+	/// Contribution of a unit slot
+	struct UnitEntry {
+		uint32_t Hash = 0;          /// Hash of the unit state, 0 if the slot is not hashed
+		uint8_t Region = 0;         /// Map region of the unit
+		unsigned long Cycle = 0;    /// Last game cycle the unit was updated
+	};
+
+	std::vector<UnitEntry> Units;             /// Contributions, by unit slot
+	std::vector<unsigned int> HashedSlots;    /// Slots with a contribution
+	uint32_t Regions[SyncHashRegionCount]{};  /// Hash of each map region
+	uint32_t Ranges[SyncHashUnitRangeCount]{}; /// Hash of each slot range
+	uint32_t PlayerHashes[PlayerMax]{};       /// Hash of the resources of each player
+};
+
+/*----------------------------------------------------------------------------
+--  Variables
+----------------------------------------------------------------------------*/
+
+extern bool StrongSyncHashEnabled;  /// Send the strong hash with the network sync messages
+extern CSyncHash StrongSyncHash;    /// Strong hash of the current game cycle
+
+//@}
+
+#endif // !__SYNCHASH_H__
@@ -47,23 +47,12 @@
 **    This is the tile number, that the player sitting on the computer
 **    currently knows. Idea: Can be uses for illusions.
 **
-**  CMapFieldPlayerInfo::Visible[]
+**  CMapFieldPlayerInfo::GetVisible()
 **
 **    Counter how many units of the player can see this field. 0 the
-**    field is not explored, 1 explored, n-1 unit see it. Currently
-**    no more than 253 units can see a field.
-**
-**  CMapFieldPlayerInfo::VisCloak[]
-**
-**    Visiblity for cloaking.
-**
-**  CMapFieldPlayerInfo::Radar[]
-**
-**    Visiblity for radar.
-**
-**  CMapFieldPlayerInfo::RadarJammer[]
-**
-**    Jamming capabilities.
+**    field is not explored, 1 explored, n-1 unit see it.
+**    The counters, with the visibility for cloaking, the radar and the
+**    jamming, are kept by player in Map.Visibility (see CMapVisibility).
 */
 
 /**
@@ -168,12 +157,20 @@ class CMapFieldPlayerInfo
 	*/
 	unsigned char TeamVisibilityState(const CPlayer &player) const;
 
+	/// Seen counter of the player, 0 unexplored
+	unsigned short GetVisible(int player) const;
+	void SetVisible(int player, unsigned short value);
+
+private:
+	/// Index of the field, in the planes of Map.Visibility
+	unsigned int GetIndex() const { return Index; }
+
 public:
 	unsigned short SeenTile = 0;            /// last seen tile (FOW)
-	unsigned short Visible[PlayerMax]{};    /// Seen counter 0 unexplored
-	unsigned char VisCloak[PlayerMax]{};    /// Visiblity for cloaking.
-	unsigned char Radar[PlayerMax]{};       /// Visiblity for radar.
-	unsigned char RadarJammer[PlayerMax]{}; /// Jamming capabilities.
+private:
+	unsigned int Index = 0;                 /// index of the field, set by CMap::Create
+
+	friend class CMap;
 };
 
 /// Describes a field of the map
@@ -185,6 +182,11 @@ class CMapField
 	void Save(CFile &file) const;
 	void parse(lua_State *l);
 
+	/// Size of a field in the binary map-fields section of the save games
+	static constexpr size_t SerializedSize = 15;
+	size_t Serialize(unsigned char *buf) const;
+	size_t Deserialize(const unsigned char *buf);
+
 	void setTileIndex(const CTileset &tileset, const tile_index tileIndex, const int value, const uint8_t elevation, const int subtile = -1);
 
 	graphic_index getGraphicTile() const { return tile; }
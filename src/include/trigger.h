@@ -84,6 +84,7 @@ extern TriggerDataType TriggerData;
 std::function<bool(const CUnit &)> TriggerGetPlayer(lua_State *l); /// get the unit-player validator
 std::function<bool(const CUnit &)> TriggerGetUnitType(lua_State *l); /// get the unit-type validator
 void TriggersEachCycle();    /// test triggers
+void TriggerUnitChanged(const CUnit &unit); /// mark the native conditions affected by a unit
 
 void TriggerCclRegister();   /// Register ccl features
 void SaveTriggers(CFile &file); /// Save the trigger module
@@ -228,12 +228,74 @@ class UnitFinder
 	CUnit **unitP;
 };
 
+/**
+**  Call f once for each unit with a tile in the area, using Map.UnitBuckets.
+**
+**  The units are visited by cell, not in the order of the tiles.
+*/
+template <typename F>
+void ForEachUnitInArea(const Vec2i &ltPos, const Vec2i &rbPos, F f)
+{
+	const CUnitBucketGrid &buckets = Map.UnitBuckets;
+	constexpr int cellSize = CUnitBucketGrid::CellSize;
+
+	if (buckets.empty()) {
+		return;
+	}
+	for (int y = ltPos.y / cellSize; y <= rbPos.y / cellSize; ++y) {
+		for (int x = ltPos.x / cellSize; x <= rbPos.x / cellSize; ++x) {
+			for (CUnit *unit : buckets.GetCell(x, y)) {
+				const Vec2i &unitLtPos = unit->tilePos;
+				const Vec2i unitRbPos(unitLtPos.x + unit->Type->TileWidth - 1,
+				                      unitLtPos.y + unit->Type->TileHeight - 1);
+
+				if (unitRbPos.x < ltPos.x || unitLtPos.x > rbPos.x
+				    || unitRbPos.y < ltPos.y || unitLtPos.y > rbPos.y) {
+					continue;
+				}
+				// Only visit a unit in the cell of its first tile in the area.
+				if (std::max(unitLtPos.x, ltPos.x) / cellSize != x
+				    || std::max(unitLtPos.y, ltPos.y) / cellSize != y) {
+					continue;
+				}
+				f(unit);
+			}
+		}
+	}
+}
+
+/**
+**  Call f once for each unit within range of pos.
+*/
+template <typename F>
+void ForEachUnitInRadius(const Vec2i &pos, int range, F f)
+{
+	Vec2i minPos = pos - Vec2i(range, range);
+	Vec2i maxPos = pos + Vec2i(range, range);
+
+	Map.FixSelectionArea(minPos, maxPos);
+	ForEachUnitInArea(minPos, maxPos, [&](CUnit *unit) {
+		if (unit->MapDistanceTo(pos) <= range) {
+			f(unit);
+		}
+	});
+}
+
+/// Areas of at least this number of tiles are searched with Map.UnitBuckets
+constexpr int UnitBucketMinArea = 16 * 16;
+
+/// Units of an area, in the order of a scan of its tiles
+std::vector<CUnit *> FindUnitsInTileOrder(const Vec2i &ltPos, const Vec2i &rbPos);
+
 std::vector<CUnit *> Select(const Vec2i &ltPos, const Vec2i &rbPos);
 std::vector<CUnit *> SelectFixed(const Vec2i &ltPos, const Vec2i &rbPos);
 std::vector<CUnit *> SelectAroundUnit(const CUnit &unit, int range);
 
+/**
+**  Select the units of an area, looking at each tile.
+*/
 template <int selectMax = 0, typename Pred>
-std::vector<CUnit *> SelectFixed(const Vec2i &ltPos, const Vec2i &rbPos, Pred pred)
+std::vector<CUnit *> SelectFixedByTile(const Vec2i &ltPos, const Vec2i &rbPos, Pred pred)
 {
 	Assert(Map.Info.IsPointOnMap(ltPos));
 	Assert(Map.Info.IsPointOnMap(rbPos));
@@ -267,6 +329,31 @@ std::vector<CUnit *> SelectFixed(const Vec2i &ltPos, const Vec2i &rbPos, Pred pr
 	return units;
 }
 
+template <int selectMax = 0, typename Pred>
+std::vector<CUnit *> SelectFixed(const Vec2i &ltPos, const Vec2i &rbPos, Pred pred)
+{
+	static_assert(selectMax == 0 || selectMax == 1);
+
+	if ((rbPos.x - ltPos.x + 1) * (rbPos.y - ltPos.y + 1) < UnitBucketMinArea) {
+		return SelectFixedByTile<selectMax>(ltPos, rbPos, pred);
+	}
+	Assert(Map.Info.IsPointOnMap(ltPos));
+	Assert(Map.Info.IsPointOnMap(rbPos));
+
+	std::vector<CUnit *> units = FindUnitsInTileOrder(ltPos, rbPos);
+	if constexpr (selectMax == 1) {
+		const auto it = ranges::find_if(units, pred);
+		if (it != units.end()) {
+			return {*it};
+		}
+		return {};
+	} else {
+		units.erase(std::remove_if(units.begin(), units.end(), [&](CUnit *unit) { return !pred(unit); }),
+		            units.end());
+		return units;
+	}
+}
+
 template <int selectMax = 0, typename Pred>
 std::vector<CUnit *> Select(const Vec2i &ltPos, const Vec2i &rbPos, Pred pred)
 {
@@ -294,6 +381,11 @@ CUnit *FindUnit_IfFixed(const Vec2i &ltPos, const Vec2i &rbPos, Pred pred)
 	Assert(Map.Info.IsPointOnMap(ltPos));
 	Assert(Map.Info.IsPointOnMap(rbPos));
 
+	if ((rbPos.x - ltPos.x + 1) * (rbPos.y - ltPos.y + 1) >= UnitBucketMinArea) {
+		const std::vector<CUnit *> units = FindUnitsInTileOrder(ltPos, rbPos);
+		const auto it = ranges::find_if(units, pred);
+		return it != units.end() ? *it : nullptr;
+	}
 	for (Vec2i posIt = ltPos; posIt.y != rbPos.y + 1; ++posIt.y) {
 		for (posIt.x = ltPos.x; posIt.x != rbPos.x + 1; ++posIt.x) {
 			const CMapField &mf = *Map.Field(posIt);
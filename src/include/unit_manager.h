@@ -35,8 +35,10 @@
 --  Includes
 ----------------------------------------------------------------------------*/
 
+#include <cstddef>
+#include <deque>
+#include <memory>
 #include <vector>
-#include <list>
 
 
 /*----------------------------------------------------------------------------
@@ -44,13 +46,15 @@
 ----------------------------------------------------------------------------*/
 
 class CUnit;
+class CUnitSlab;
 class CFile;
 struct lua_State;
 
 class CUnitManager
 {
 public:
-	CUnitManager() = default;
+	CUnitManager();
+	~CUnitManager();
 	void Init();
 
 	CUnit *AllocUnit();
@@ -62,6 +66,12 @@ class CUnitManager
 	void Add(CUnit *unit);
 	const std::vector<CUnit *> &GetUnits() const { return units; }
 
+	// Walk the units table as it was when locked, until UnlockUnits
+	void LockUnits();
+	size_t GetLockedCount() const { return lockedCount; }
+	CUnit &GetLockedUnit(size_t index) const;
+	void UnlockUnits();
+
 	bool empty() const;
 
 	CUnit *lastCreatedUnit();
@@ -70,11 +80,20 @@ class CUnitManager
 	CUnit &GetSlotUnit(int index) const;
 	unsigned int GetUsedSlotCount() const;
 
+private:
+	CUnit *NewSlotUnit();
+	void RemoveFromUnits(CUnit &unit);
+
 private:
 	std::vector<CUnit *> units;
 	std::vector<CUnit *> unitSlots;
-	std::list<CUnit *> releasedUnits;
+	std::vector<std::unique_ptr<CUnitSlab>> unitSlabs; /// storage of unitSlots
+	std::deque<CUnit *> releasedUnits;
 	CUnit *lastCreated = nullptr;
+	bool clearing = false;         /// Init is destroying all the units
+	bool locked = false;           /// the table as it was when locked is walked
+	size_t lockedCount = 0;        /// size of units when locked
+	std::vector<CUnit *> lockedUnits; /// units when locked, only copied on the first release
 };
 
 
@@ -614,6 +614,10 @@ class CUnitType
 	mutable LuaCallback<void(int targetId, int attacker, int damage)> OnHit; /// called when unit is hit
 	mutable LuaCallback<void(int unitId)> OnEachCycle;  /// called every cycle
 	mutable LuaCallback<void(int unitId)> OnEachSecond; /// called every second
+	/// called every cycle once with the ids of all the units of the type
+	mutable LuaCallback<void(const std::vector<int> &unitIds)> OnEachCycleBatch;
+	/// called every second once with the ids of all the units of the type
+	mutable LuaCallback<void(const std::vector<int> &unitIds)> OnEachSecondBatch;
 	mutable LuaCallback<void(int unitId)> OnInit;       /// called on unit init
 	mutable LuaCallback<void(int unitId)> OnReady;      /// called when unit ready/built
 
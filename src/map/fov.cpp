@@ -29,6 +29,8 @@
 //      02111-1307, USA.
 //
 
+#include <algorithm>
+#include <iterator>
 #include <queue>
 #include "stratagus.h"
 
@@ -47,6 +49,37 @@
 --  Functions
 ----------------------------------------------------------------------------*/
 
+/**
+**  Get the tiles of a map row seen with the simple radial field of view.
+**
+**  @param pos    location of the spectator
+**  @param w      width of the spectator
+**  @param h      height of the spectator
+**  @param range  sight range
+**  @param y      map row
+**  @param minx   Output: first tile seen on the row
+**  @param maxx   Output: tile after the last one seen (minx if none)
+*/
+static void GetSimpleRadialSpan(const Vec2i &pos, const int w, const int h, const int range, const int y,
+								int &minx, int &maxx)
+{
+	const int offsety = y - pos.y;
+	int offsetx;
+
+	minx = maxx = 0;
+	if (y < 0 || y >= Map.Info.MapHeight || offsety < -range || offsety >= h + range) {
+		return;
+	} else if (offsety < 0) {
+		offsetx = isqrt(square(range + 1) - square(offsety) - 1);
+	} else if (offsety < h) {
+		offsetx = range;
+	} else {
+		offsetx = isqrt(square(range + 1) - square(offsety - h + 1) - 1);
+	}
+	minx = std::max(0, pos.x - offsetx);
+	maxx = std::max(minx, std::min<int>(Map.Info.MapWidth, pos.x + w + offsetx));
+}
+
 /**
 ** Select which type of Field of View to use
 **
@@ -137,12 +170,9 @@ void CFieldOfView::Refresh(const CPlayer &player, const CUnit &unit, const Vec2i
 	if (!range) {
 		return;
 	}
-	if (GameSettings.FoV == FieldOfViewTypes::cShadowCasting && !unit.Type->AirUnit) {
+	if (UseShadowCasting(unit)) {
 
-		OpaqueFields = unit.Type->BoolFlag[ELEVATED_INDEX].value ? 0 : this->Settings.OpaqueFields;
-		if (GameSettings.Inside) {
-			OpaqueFields &= ~(MapFieldRocks); /// because of rocks-flag is used as an obstacle for ranged attackers
-		}
+		OpaqueFields = GetUnitOpaqueFields(unit);
 		PrepareShadowCaster(player, unit, pos, marker);
 		PrepareCache(pos, width, height, range);
 		ProceedShadowCasting(pos, width, height, range + 1);
@@ -152,6 +182,96 @@ void CFieldOfView::Refresh(const CPlayer &player, const CUnit &unit, const Vec2i
 	}
 }
 
+/**
+**  Check if the fields of view may be moved instead of refreshed.
+**
+**  The visible sets only depend on the terrain, unless the units
+**  themselves are opaque.
+*/
+bool CFieldOfView::CanMove() const
+{
+	return GameSettings.FoV != FieldOfViewTypes::cShadowCasting
+		   || !(this->Settings.OpaqueFields & (MapFieldLandUnit | MapFieldAirUnit | MapFieldSeaUnit));
+}
+
+/**
+**  Move the field of view of a unit, only (un)marking the tiles which
+**  leave or enter it. The visibility ends up the same as unmarking the
+**  sight at oldPos and marking it at newPos.
+**
+**  @param player     player to mark the sight for
+**  @param unit       unit to mark the sight for
+**  @param oldPos     location the sight was marked at
+**  @param newPos     location to mark
+**  @param width      width to mark, in square
+**  @param height     height to mark, in square
+**  @param range      Radius to mark.
+**  @param marker     Function to mark sight
+**  @param unmarker   Function to unmark sight
+**  @param marker2    Optional second function to mark sight (cloak detection)
+**  @param unmarker2  Optional second function to unmark sight
+*/
+void CFieldOfView::Move(const CPlayer &player, const CUnit &unit, const Vec2i &oldPos, const Vec2i &newPos,
+						const uint16_t width, const uint16_t height, const uint16_t range,
+						MapMarkerFunc *marker, MapMarkerFunc *unmarker,
+						MapMarkerFunc *marker2, MapMarkerFunc *unmarker2)
+{
+	// Same as Refresh
+	if (unit.ReleaseCycle) return;
+	Assert(unit.Type != nullptr);
+	if (!range) {
+		return;
+	}
+	LeavingTiles.clear();
+	EnteringTiles.clear();
+	if (UseShadowCasting(unit)) {
+		ProceedShadowCastingMove(unit, oldPos, newPos, width, height, range);
+	} else {
+		ProceedSimpleRadialMove(oldPos, newPos, width, height, range);
+	}
+
+	for (const unsigned int index : LeavingTiles) {
+		unmarker(player, index);
+		if (unmarker2) {
+			unmarker2(player, index);
+		}
+	}
+	for (const unsigned int index : EnteringTiles) {
+		marker(player, index);
+		if (marker2) {
+			marker2(player, index);
+		}
+	}
+}
+
+/**
+**  Forget the visible sets kept for a unit.
+*/
+void CFieldOfView::ForgetUnit(const CUnit &unit)
+{
+	VisibleSets.erase(&unit);
+}
+
+/**
+**  Check if the unit sees with the shadow casting.
+*/
+bool CFieldOfView::UseShadowCasting(const CUnit &unit) const
+{
+	return GameSettings.FoV == FieldOfViewTypes::cShadowCasting && !unit.Type->AirUnit;
+}
+
+/**
+**  Opaque fields for the shadow casting of the unit.
+*/
+uint16_t CFieldOfView::GetUnitOpaqueFields(const CUnit &unit) const
+{
+	uint16_t opaqueFields = unit.Type->BoolFlag[ELEVATED_INDEX].value ? 0 : this->Settings.OpaqueFields;
+	if (GameSettings.Inside) {
+		opaqueFields &= ~(MapFieldRocks); /// because of rocks-flag is used as an obstacle for ranged attackers
+	}
+	return opaqueFields;
+}
+
 /**
 **  Refresh the whole sight of unit by SimleRadial algorithm. (Explore and make visible.)
 **
@@ -204,6 +324,120 @@ void CFieldOfView::ProceedSimpleRadial(const CPlayer &player, const Vec2i &pos,
 	}
 }
 
+/**
+**  Calc the tiles leaving and entering the SimpleRadial field of view.
+**
+**  Only the ends of the rows change, so it costs O(range) instead of O(range^2).
+**
+**  @param oldPos  previous location of the spectator
+**  @param newPos  new location of the spectator
+**  @param w       width of the spectator
+**  @param h       height of the spectator
+**  @param range   sight range
+*/
+void CFieldOfView::ProceedSimpleRadialMove(const Vec2i &oldPos, const Vec2i &newPos,
+										   const int16_t w, const int16_t h, const int16_t range)
+{
+	const int miny = std::max(0, std::min(oldPos.y, newPos.y) - range);
+	const int maxy = std::min<int>(Map.Info.MapHeight, std::max(oldPos.y, newPos.y) + h + range);
+
+	for (int y = miny; y < maxy; ++y) {
+		int oldMinX;
+		int oldMaxX;
+		int newMinX;
+		int newMaxX;
+		GetSimpleRadialSpan(oldPos, w, h, range, y, oldMinX, oldMaxX);
+		GetSimpleRadialSpan(newPos, w, h, range, y, newMinX, newMaxX);
+		const unsigned int index = y * Map.Info.MapWidth;
+
+		// trailing arc: old span out of the new one
+		for (int x = oldMinX; x < std::min(oldMaxX, newMinX); ++x) {
+			LeavingTiles.push_back(index + x);
+		}
+		for (int x = std::max(oldMinX, newMaxX); x < oldMaxX; ++x) {
+			LeavingTiles.push_back(index + x);
+		}
+		// leading arc: new span out of the old one
+		for (int x = newMinX; x < std::min(newMaxX, oldMinX); ++x) {
+			EnteringTiles.push_back(index + x);
+		}
+		for (int x = std::max(newMinX, oldMaxX); x < newMaxX; ++x) {
+			EnteringTiles.push_back(index + x);
+		}
+	}
+}
+
+/**
+**  Calc the tiles leaving and entering the ShadowCasting field of view.
+**
+**  The visible set of the unit is kept from its previous move, so only the
+**  new one is cast. The kept set is used while the terrain is unchanged.
+**
+**  @param unit    unit to calc the field of view for
+**  @param oldPos  previous location of the spectator
+**  @param newPos  new location of the spectator
+**  @param width   width of the spectator
+**  @param height  height of the spectator
+**  @param range   sight range
+*/
+void CFieldOfView::ProceedShadowCastingMove(const CUnit &unit, const Vec2i &oldPos, const Vec2i &newPos,
+											const uint16_t width, const uint16_t height, const uint16_t range)
+{
+	std::vector<SVisibleSet> &sets = VisibleSets[&unit];
+	auto it = ranges::find_if(sets, [&](const SVisibleSet &set) { return set.Range == range; });
+	if (it == sets.end()) {
+		it = sets.emplace(sets.end());
+		it->Range = range;
+	}
+	SVisibleSet &set = *it;
+	const uint16_t opaqueFields = GetUnitOpaqueFields(unit);
+
+	if (set.Pos == oldPos && set.Width == width && set.Height == height
+		&& set.OpaqueFields == opaqueFields && set.TerrainGeneration == TerrainGeneration) {
+		std::swap(PreviousTiles, set.Tiles);
+	} else {
+		CollectShadowCasting(unit, oldPos, width, height, range, PreviousTiles);
+	}
+	CollectShadowCasting(unit, newPos, width, height, range, set.Tiles);
+	set.Pos = newPos;
+	set.Width = width;
+	set.Height = height;
+	set.OpaqueFields = opaqueFields;
+	set.TerrainGeneration = TerrainGeneration;
+
+	std::set_difference(PreviousTiles.begin(), PreviousTiles.end(), set.Tiles.begin(), set.Tiles.end(),
+						std::back_inserter(LeavingTiles));
+	std::set_difference(set.Tiles.begin(), set.Tiles.end(), PreviousTiles.begin(), PreviousTiles.end(),
+						std::back_inserter(EnteringTiles));
+}
+
+/**
+**  Collect the tiles seen by ShadowCaster algorithm, instead of marking them.
+**
+**  @param unit    unit to calc the field of view for
+**  @param pos     location of the spectator
+**  @param width   width of the spectator
+**  @param height  height of the spectator
+**  @param range   sight range
+**  @param tiles   Output: sorted indexes of the tiles seen
+*/
+void CFieldOfView::CollectShadowCasting(const CUnit &unit, const Vec2i &pos, const uint16_t width,
+										const uint16_t height, const uint16_t range,
+										std::vector<unsigned int> &tiles)
+{
+	tiles.clear();
+	CollectedTiles = &tiles;
+
+	OpaqueFields = GetUnitOpaqueFields(unit);
+	PrepareShadowCaster(*unit.Player, unit, pos, nullptr);
+	PrepareCache(pos, width, height, range);
+	ProceedShadowCasting(pos, width, height, range + 1);
+	ResetShadowCaster();
+
+	CollectedTiles = nullptr;
+	std::sort(tiles.begin(), tiles.end());
+}
+
 /**
 ** Mark the sight of unit by ShadowCaster algorithm. (Explore and make visible.)
 **
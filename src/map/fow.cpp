@@ -42,6 +42,7 @@
 #include "fow.h"
 #include "map.h"
 #include "player.h"
+#include "profiler.h"
 #include "tile.h"
 #include "ui.h"
 #include "viewport.h"
@@ -309,7 +310,8 @@ void CFogOfWar::GenerateFog()
     }
     CurrUpscaleTableExplored = GameSettings.RevealMap != MapRevealModes::cHidden ? UpscaleTableRevealed : UpscaleTableExplored;
 
-    const uint8_t visibleThreshold = Map.NoFogOfWar ? 1 : 2;
+    /// Without fog of war, the explored tiles are visible
+    const uint8_t exploredCell = Map.NoFogOfWar ? 2 : 1;
 
     #pragma omp parallel
     {
@@ -323,18 +325,29 @@ void CFogOfWar::GenerateFog()
             const size_t visIndex = VisTable_Index0 + row * VisTableWidth;
             const size_t mapIndex = size_t(row) * Map.Info.MapWidth;
 
+            /// Visibility of 64 tiles for all the players, merged from their bitsets
+            size_t word = mapIndex / 64;
+            uint64_t explored = 0;
+            uint64_t visible = 0;
+            const auto mergeWord = [&]() {
+                explored = 0;
+                visible = 0;
+                for (const uint8_t player : playersToRenderView) {
+                    explored |= Map.Visibility.GetExploredWord(player, word);
+                    visible |= Map.Visibility.GetVisibleWord(player, word);
+                }
+            };
+            mergeWord();
+
             for (uint16_t col = 0; col < Map.Info.MapWidth; col++) {
 
-                uint8_t &visCell = VisTable[visIndex + col];
-                visCell = 0; /// Clear it before check for players
-                const CMapField *mapField = Map.Field(mapIndex + col);
-                for (const uint8_t player : playersToRenderView) {
-                    visCell = std::max<uint8_t>(visCell, mapField->playerInfo.Visible[player]);
-                    if (visCell >= visibleThreshold) {
-                        visCell = 2;
-                        break;
-                    }
+                const size_t mapCell = mapIndex + col;
+                if (mapCell / 64 != word) {
+                    word = mapCell / 64;
+                    mergeWord();
                 }
+                const uint64_t bit = uint64_t(1) << (mapCell % 64);
+                VisTable[visIndex + col] = (visible & bit) ? 2 : (explored & bit) ? exploredCell : 0;
             }
         }
     }
@@ -348,6 +361,7 @@ void CFogOfWar::GenerateFog()
 */
 void CFogOfWar::Update(bool doAtOnce /*= false*/)
 {
+    PROFILE_ZONE("FogUpdate");
     if (Settings.Type == FogOfWarTypes::cTiled || Settings.Type == FogOfWarTypes::cTiledLegacy) {
         if (doAtOnce || this->State == States::cFirstEntry){
             GenerateFog();
@@ -417,6 +431,7 @@ void CFogOfWar::Update(bool doAtOnce /*= false*/)
 */
 void CFogOfWar::Draw(CViewport &viewport)
 {
+    PROFILE_ZONE("FogDraw");
     if (Settings.Type == FogOfWarTypes::cTiledLegacy) {
         DrawTiledLegacy(viewport);
     } else {
@@ -38,10 +38,14 @@
 
 #include "map.h"
 
+#include "ai.h"
 #include "fov.h"
 #include "iolib.h"
+#include "net_serialization.h"
+#include "pathfinder.h"
 #include "player.h"
 #include "tileset.h"
+#include "trigger.h"
 #include "unit.h"
 #include "unit_manager.h"
 #include "ui.h"
@@ -142,9 +146,8 @@ void CMap::Reveal(MapRevealModes mode /* = MapRevealModes::cKnown */ )
 	if (static_cast<int>(mode) >= static_cast<int>(MapRevealModes::cExplored)) {
 		for (int i = 0; i != this->Info.MapWidth * this->Info.MapHeight; ++i) {
 			CMapField &mf = *this->Field(i);
-			CMapFieldPlayerInfo &playerInfo = mf.playerInfo;
 			for (int p = 0; p < PlayerMax; ++p) {
-				playerInfo.Visible[p] = std::max<unsigned short>(1, playerInfo.Visible[p]);
+				this->Visibility.SetVisible(p, i, std::max<unsigned short>(1, this->Visibility.GetVisible(p, i)));
 			}
 			MarkSeenTile(mf);
 		}
@@ -305,6 +308,18 @@ void PreprocessMap()
 	}
 }
 
+/**
+**  Terrain of an area has changed: obstacles, opacity or elevation.
+**
+**  @param pos   Top left tile of the area.
+**  @param size  Size of the area.
+*/
+void MapTerrainChanged(const Vec2i &pos, const Vec2i &size)
+{
+	PathfinderTerrainChanged(pos, size);
+	FieldOfView.TerrainChanged();
+}
+
 /**
 **  Clear CMapInfo.
 */
@@ -337,6 +352,10 @@ void CMap::AllocateTileset()
 void CMap::Create()
 {
 	this->Fields.resize(this->Info.MapWidth * this->Info.MapHeight);
+	for (unsigned int i = 0; i != this->Fields.size(); ++i) {
+		this->Fields[i].playerInfo.Index = i;
+	}
+	this->Visibility.Resize(this->Fields.size());
 }
 
 /**
@@ -355,6 +374,8 @@ void CMap::Init()
 void CMap::Clean(const bool isHardClean /* = false*/)
 {
 	this->Fields.clear();
+	this->UnitBuckets.Clear();
+	this->Visibility.Clear();
 
 	// Tileset freed by Tileset?
 
@@ -380,12 +401,131 @@ void CMap::Clean(const bool isHardClean /* = false*/)
 	this->isMapInitialized = false;
 }
 
+/// Header of the binary map-fields files
+static constexpr char MapFieldsMagic[4] = {'S', 'M', 'F', '1'};
+static constexpr size_t MapFieldsHeaderSize = sizeof(MapFieldsMagic) + 3 * sizeof(uint32_t);
+
+/**
+** Save the fields in a binary file.
+** The file is referenced by "map-fields-file" in the saved map.
+**
+** @param file  Output file, opened for writing.
+**
+** @return true if the fields are written.
+*/
+bool CMap::SaveFields(CFile &file) const
+{
+	std::vector<unsigned char> buf(std::max<size_t>(MapFieldsHeaderSize,
+	                                                this->Info.MapWidth * CMapField::SerializedSize));
+	unsigned char *p = buf.data();
+	std::copy(std::begin(MapFieldsMagic), std::end(MapFieldsMagic), p);
+	p += sizeof(MapFieldsMagic);
+	p += serialize32(p, uint32_t(this->Info.MapWidth));
+	p += serialize32(p, uint32_t(this->Info.MapHeight));
+	p += serialize32(p, uint32_t(CMapField::SerializedSize));
+	bool ok = file.write(buf.data(), p - buf.data()) > 0;
+
+	// one row at a time
+	for (int h = 0; ok && h < this->Info.MapHeight; ++h) {
+		p = buf.data();
+		for (int w = 0; w < this->Info.MapWidth; ++w) {
+			p += this->Field(w, h)->Serialize(p);
+		}
+		ok = file.write(buf.data(), p - buf.data()) > 0;
+	}
+	return ok;
+}
+
+/**
+** Save the fields in a binary file, compressed when possible.
+**
+** @param fieldsFile  Output file, CFile may add a .gz extension.
+**
+** @return true if the file is written.
+*/
+bool CMap::SaveFields(const fs::path &fieldsFile) const
+{
+	CFile file;
+	if (file.open(fieldsFile.string().c_str(), CL_WRITE_GZ | CL_OPEN_WRITE) == -1) {
+		ErrorPrint("Can't save the map fields to '%s'\n", fieldsFile.u8string().c_str());
+		return false;
+	}
+	const bool ok = SaveFields(file);
+	file.close();
+	if (!ok) {
+		ErrorPrint("Can't write the map fields to '%s'\n", fieldsFile.u8string().c_str());
+	}
+	return ok;
+}
+
+/**
+** Load the fields saved by SaveFields, the map must have its size.
+**
+** @param fieldsFile  Input file, CFile also looks for compressed versions.
+**
+** @return true if the fields are loaded.
+*/
+bool CMap::LoadFields(const fs::path &fieldsFile)
+{
+	CFile file;
+	if (file.open(fieldsFile.string().c_str(), CL_OPEN_READ) == -1) {
+		ErrorPrint("Can't open the map fields '%s'\n", fieldsFile.u8string().c_str());
+		return false;
+	}
+	const auto readAll = [&](unsigned char *data, size_t size) {
+		while (size != 0) {
+			const int n = file.read(data, size);
+			if (n <= 0) {
+				return false;
+			}
+			data += n;
+			size -= n;
+		}
+		return true;
+	};
+	unsigned char header[MapFieldsHeaderSize];
+	if (!readAll(header, sizeof(header))
+	    || !std::equal(std::begin(MapFieldsMagic), std::end(MapFieldsMagic), header)) {
+		ErrorPrint("'%s' is not a map fields file\n", fieldsFile.u8string().c_str());
+		return false;
+	}
+	uint32_t width;
+	uint32_t height;
+	uint32_t fieldSize;
+	const unsigned char *p = header + sizeof(MapFieldsMagic);
+	p += deserialize32(p, &width);
+	p += deserialize32(p, &height);
+	p += deserialize32(p, &fieldSize);
+	if (int(width) != this->Info.MapWidth || int(height) != this->Info.MapHeight
+	    || fieldSize != CMapField::SerializedSize) {
+		ErrorPrint("Wrong map fields size: %ux%u (field of %u bytes)\n", width, height, fieldSize);
+		return false;
+	}
+
+	std::vector<unsigned char> buf(width * CMapField::SerializedSize);
+	for (int h = 0; h < this->Info.MapHeight; ++h) {
+		if (!readAll(buf.data(), buf.size())) {
+			ErrorPrint("'%s' is truncated\n", fieldsFile.u8string().c_str());
+			return false;
+		}
+		p = buf.data();
+		for (int w = 0; w < this->Info.MapWidth; ++w) {
+			p += this->Field(w, h)->Deserialize(p);
+		}
+	}
+	return true;
+}
+
 /**
 ** Save the complete map.
 **
-** @param file Output file.
+** @param file            Output file.
+** @param fieldsFile      If not null, the fields are saved in this binary file
+**                        instead of as a lua table.
+** @param fieldsFileName  Name of fieldsFile, relative to the saved map.
 */
-void CMap::Save(CFile &file) const
+void CMap::Save(CFile &file, CFile *fieldsFile /* = nullptr */,
+                const std::string &fieldsFileName /* = {} */) const
 {
 	file.printf("\n--- -----------------------------------------\n");
 	file.printf("--- MODULE: map\n");
@@ -397,6 +537,10 @@ void CMap::Save(CFile &file) const
 	file.printf("  \"size\", {%d, %d},\n", this->Info.MapWidth, this->Info.MapHeight);
 	file.printf("  \"%s\",\n", this->NoFogOfWar ? "no-fog-of-war" : "fog-of-war");
 	file.printf("  \"filename\", \"%s\",\n", this->Info.Filename.c_str());
+	if (fieldsFile && this->SaveFields(*fieldsFile)) {
+		file.printf("  \"map-fields-file\", \"%s\"})\n", fieldsFileName.c_str());
+		return;
+	}
 	file.printf("  \"map-fields\", {\n");
 	for (int h = 0; h < this->Info.MapHeight; ++h) {
 		file.printf("  -- %d\n", h);
@@ -578,6 +722,7 @@ void CMap::ClearWoodTile(const Vec2i &pos)
 	mf.setGraphicTile(this->Tileset->getRemovedTreeTile());
 	mf.Flags &= ~(MapFieldCost4 | MapFieldCost5 | MapFieldCost6 | MapFieldForest | MapFieldUnpassable);
 	mf.Value = 0;
+	MapTerrainChanged(pos, Vec2i(1, 1));
 
 	UI.Minimap.UpdateXY(pos);
 	FixNeighbors(MapFieldForest, 0, pos);
@@ -597,6 +742,7 @@ void CMap::ClearRockTile(const Vec2i &pos)
 	mf.setGraphicTile(this->Tileset->getRemovedRockTile());
 	mf.Flags &= ~(MapFieldRocks | MapFieldUnpassable);
 	mf.Value = 0;
+	MapTerrainChanged(pos, Vec2i(1, 1));
 
 	UI.Minimap.UpdateXY(pos);
 	FixNeighbors(MapFieldRocks, 0, pos);
@@ -656,6 +802,7 @@ void CMap::RegenerateForestTile(const Vec2i &pos)
 		mf.playerInfo.SeenTile = mf.getGraphicTile();
 		mf.Value = 100; // TODO: Should be DefaultResourceAmounts[WoodCost] once all games are migrated
 		mf.Flags |= MapFieldForest | MapFieldUnpassable;
+		MapTerrainChanged(pos + offset, Vec2i(1, 2));
 		UI.Minimap.UpdateSeenXY(pos);
 		UI.Minimap.UpdateXY(pos);
 		if (mf.playerInfo.IsTeamVisible(*ThisPlayer)) {
@@ -710,6 +857,10 @@ void CMap::Insert(CUnit &unit)
 		} while (--j && unit.tilePos.x + (j - w) < Info.MapWidth);
 		index += Info.MapWidth;
 	} while (--i && unit.tilePos.y + (i - h) < Info.MapHeight);
+	UnitBuckets.Insert(unit);
+	TriggerUnitChanged(unit);
+	DistanceFieldsUnitChanged(unit);
+	AiInfluenceUnitChanged(unit);
 }
 
 /**
@@ -734,6 +885,93 @@ void CMap::Remove(CUnit &unit)
 		} while (--j && unit.tilePos.x + (j - w) < Info.MapWidth);
 		index += Info.MapWidth;
 	} while (--i && unit.tilePos.y + (i - h) < Info.MapHeight);
+	UnitBuckets.Remove(unit);
+	TriggerUnitChanged(unit);
+	DistanceFieldsUnitChanged(unit, true);
+	AiInfluenceUnitChanged(unit, true);
+}
+
+/**
+**  Call f with each cell overlapped by the tiles of the unit.
+*/
+template <typename F>
+static void ForEachBucketOf(const CUnit &unit, F f)
+{
+	constexpr int cellSize = CUnitBucketGrid::CellSize;
+	const int x0 = unit.tilePos.x / cellSize;
+	const int y0 = unit.tilePos.y / cellSize;
+	const int x1 = (std::min(unit.tilePos.x + unit.Type->TileWidth, Map.Info.MapWidth) - 1) / cellSize;
+	const int y1 = (std::min(unit.tilePos.y + unit.Type->TileHeight, Map.Info.MapHeight) - 1) / cellSize;
+
+	for (int y = y0; y <= y1; ++y) {
+		for (int x = x0; x <= x1; ++x) {
+			f(x, y);
+		}
+	}
+}
+
+void CUnitBucketGrid::Clear()
+{
+	Width = 0;
+	Height = 0;
+	Cells.clear();
+}
+
+/**
+**  Insert a unit in the cells it overlaps.
+*/
+void CUnitBucketGrid::Insert(CUnit &unit)
+{
+	if (Cells.empty()) {
+		Width = (Map.Info.MapWidth + CellSize - 1) / CellSize;
+		Height = (Map.Info.MapHeight + CellSize - 1) / CellSize;
+		Cells.resize(Width * Height);
+	}
+	Assert(Width == (Map.Info.MapWidth + CellSize - 1) / CellSize);
+	ForEachBucketOf(unit, [&](int x, int y) { Cells[x + y * Width].push_back(&unit); });
+}
+
+/**
+**  Remove a unit from the cells it overlaps.
+*/
+void CUnitBucketGrid::Remove(CUnit &unit)
+{
+	ForEachBucketOf(unit, [&](int x, int y) {
+		std::vector<CUnit *> &cell = Cells[x + y * Width];
+		// order doesn't matter, ForEachUnitInArea callers sort when needed
+		const auto it = ranges::find(cell, &unit);
+		Assert(it != cell.end());
+		*it = cell.back();
+		cell.pop_back();
+	});
+}
+
+/**
+**  Resize the planes to the number of fields of the map.
+**  Like for CMap::Fields, the fields already there keep their counters.
+*/
+void CMapVisibility::Resize(unsigned int size)
+{
+	for (int p = 0; p != PlayerMax; ++p) {
+		VisiblePlanes[p].resize(size);
+		VisCloakPlanes[p].resize(size);
+		RadarPlanes[p].resize(size);
+		RadarJammerPlanes[p].resize(size);
+		ExploredBits[p].resize((size + 63) / 64);
+		VisibleBits[p].resize((size + 63) / 64);
+	}
+}
+
+void CMapVisibility::Clear()
+{
+	for (int p = 0; p != PlayerMax; ++p) {
+		VisiblePlanes[p].clear();
+		VisCloakPlanes[p].clear();
+		RadarPlanes[p].clear();
+		RadarJammerPlanes[p].clear();
+		ExploredBits[p].clear();
+		VisibleBits[p].clear();
+	}
 }
 
 void CMap::Clamp(Vec2i &pos) const
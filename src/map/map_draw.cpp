@@ -40,6 +40,7 @@
 #include "particle.h"
 #include "pathfinder.h"
 #include "player.h"
+#include "profiler.h"
 #include "tileset.h"
 #include "unit.h"
 #include "unittype.h"
@@ -423,15 +424,19 @@ void CViewport::Draw(const fieldHighlightChecker highlightChecker /* = nullptr *
 	this->SetClipping();
 
 	/* this may take while */
-	if (Map.Tileset->getLogicalToGraphicalTileSizeShift() > 0) {
-		this->DrawMapBackgroundInViewport<false>(highlightChecker);
-	} else {
-		this->DrawMapBackgroundInViewport<true>(highlightChecker);
+	{
+		PROFILE_ZONE("DrawMapBackground");
+		if (Map.Tileset->getLogicalToGraphicalTileSizeShift() > 0) {
+			this->DrawMapBackgroundInViewport<false>(highlightChecker);
+		} else {
+			this->DrawMapBackgroundInViewport<true>(highlightChecker);
+		}
 	}
 
 	Missile *clickMissile = nullptr;
 	CurrentViewport = this;
 	{
+		PROFILE_ZONE("DrawUnitsAndMissiles");
 		// Now we need to sort units, missiles, particles by draw level and draw them
 		const std::vector<CUnit *> unittable = FindAndSortUnits(*this);
 		const std::vector<Missile *> missiletable = FindAndSortMissiles(*this);
@@ -215,20 +215,20 @@ static void UnitsOnTileUnmarkSeen(const CPlayer &player, CMapField &mf, int cloa
 void MapMarkTileSight(const CPlayer &player, const unsigned int index)
 {
 	CMapField &mf = *Map.Field(index);
-	unsigned short *v = &(mf.playerInfo.Visible[player.Index]);
+	const unsigned short v = Map.Visibility.GetVisible(player.Index, index);
 
-	if (*v == 0 || *v == 1) { // Unexplored or unseen
+	if (v == 0 || v == 1) { // Unexplored or unseen
 		// When there is no fog only unexplored tiles are marked.
-		if (!Map.NoFogOfWar || *v == 0) {
+		if (!Map.NoFogOfWar || v == 0) {
 			UnitsOnTileMarkSeen(player, mf, 0);
 		}
-		*v = 2;
+		Map.Visibility.SetVisible(player.Index, index, 2);
 		if (mf.playerInfo.IsTeamVisible(*ThisPlayer)) {
 			Map.MarkSeenTile(mf);
 		}
 	} else {
-		Assert(*v != 65535);
-		++*v;
+		Assert(v != 65535);
+		Map.Visibility.SetVisible(player.Index, index, v + 1);
 	}
 #if 0
 	if (EnableDebugPrint) {
@@ -236,10 +236,10 @@ void MapMarkTileSight(const CPlayer &player, const unsigned int index)
 	}
 	// Calculate some hash.
 	SyncHash = (SyncHash << 5) | (SyncHash >> 27);
-	SyncHash ^= (*v << 16) | *v;
+	SyncHash ^= (v << 16) | v;
 
 	if (EnableDebugPrint) {
-		ErrorPrint(", after: %x (mapfield: %d, player: %d, sight: %d)\n", SyncHash, index, player.Index, *v);
+		ErrorPrint(", after: %x (mapfield: %d, player: %d, sight: %d)\n", SyncHash, index, player.Index, v);
 		print_backtrace(8);
 		fflush(stderr);
 	}
@@ -261,8 +261,8 @@ void MapMarkTileSight(const CPlayer &player, const Vec2i &pos)
 void MapUnmarkTileSight(const CPlayer &player, const unsigned int index)
 {
 	CMapField &mf = *Map.Field(index);
-	unsigned short *v = &mf.playerInfo.Visible[player.Index];
-	switch (*v) {
+	const unsigned short v = Map.Visibility.GetVisible(player.Index, index);
+	switch (v) {
 		case 0:  // Unexplored
 		case 1:
 			// This happens when we unmark everything in CommandSharedVision
@@ -278,7 +278,7 @@ void MapUnmarkTileSight(const CPlayer &player, const unsigned int index)
 				Map.MarkSeenTile(mf);
 			}
 		default:  // seen -> seen
-			--*v;
+			Map.Visibility.SetVisible(player.Index, index, v - 1);
 			break;
 	}
 }
@@ -298,7 +298,7 @@ void MapUnmarkTileSight(const CPlayer &player, const Vec2i &pos)
 void MapMarkTileDetectCloak(const CPlayer &player, const unsigned int index)
 {
 	CMapField &mf = *Map.Field(index);
-	unsigned char *v = &mf.playerInfo.VisCloak[player.Index];
+	unsigned char *v = &Map.Visibility.VisCloak(player.Index, index);
 	if (*v == 0) {
 		UnitsOnTileMarkSeen(player, mf, 1);
 	}
@@ -320,7 +320,7 @@ void MapMarkTileDetectCloak(const CPlayer &player, const Vec2i &pos)
 void MapUnmarkTileDetectCloak(const CPlayer &player, const unsigned int index)
 {
 	CMapField &mf = *Map.Field(index);
-	unsigned char *v = &mf.playerInfo.VisCloak[player.Index];
+	unsigned char *v = &Map.Visibility.VisCloak(player.Index, index);
 	///Assert(*v != 0);
 	/// This could happen if shadow caster type of field of view is enabled,
 	/// because of multiple calls for tiles in vertical/horizontal/diagonal lines
@@ -353,6 +353,46 @@ void MapSight(const CPlayer &player, const CUnit &unit, const Vec2i &pos, int w,
 	FieldOfView.Refresh(player, unit, pos, w, h, range, marker);
 }
 
+/**
+**  Check if the sight of a moving unit may be moved instead of unmarked
+**  and marked again.
+*/
+bool MapCanMoveSight()
+{
+	return FieldOfView.CanMove();
+}
+
+/**
+**  Move the sight of unit, only (un)marking the tiles which leave or
+**  enter it.
+**
+**  @param player     player to mark the sight for (not unit owner)
+**  @param unit       unit to mark the sight for
+**  @param oldPos     location the sight was marked at
+**  @param newPos     location to mark
+**  @param w          width to mark, in square
+**  @param h          height to mark, in square
+**  @param range      Radius to mark.
+**  @param marker     Function to mark sight
+**  @param unmarker   Function to unmark sight
+**  @param marker2    Optional second function to mark sight
+**  @param unmarker2  Optional second function to unmark sight
+*/
+void MapSightMove(const CPlayer &player, const CUnit &unit, const Vec2i &oldPos, const Vec2i &newPos,
+				  int w, int h, int range, MapMarkerFunc *marker, MapMarkerFunc *unmarker,
+				  MapMarkerFunc *marker2, MapMarkerFunc *unmarker2)
+{
+	FieldOfView.Move(player, unit, oldPos, newPos, w, h, range, marker, unmarker, marker2, unmarker2);
+}
+
+/**
+**  Forget what is kept of the sight of a unit.
+*/
+void MapSightForget(const CUnit &unit)
+{
+	FieldOfView.ForgetUnit(unit);
+}
+
 /**
 **  Update fog of war.
 */
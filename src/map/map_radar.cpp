@@ -47,22 +47,21 @@
 ----------------------------------------------------------------------------*/
 
 static inline unsigned char
-IsTileRadarVisible(const CPlayer &pradar, const CPlayer &punit, const CMapFieldPlayerInfo &mfp)
+IsTileRadarVisible(const CPlayer &pradar, const CPlayer &punit, const unsigned int index)
 {
-	if (mfp.RadarJammer[punit.Index]) {
+	const CMapVisibility &visibility = Map.Visibility;
+	if (visibility.RadarJammer(punit.Index, index)) {
 		return 0;
 	}
 
 	if (pradar.IsVisionSharing()) {
-		const uint8_t *const radar = mfp.Radar;
-		const uint8_t *const jamming = mfp.RadarJammer;
 		uint8_t radarvision = 0;
 		// Check jamming first, if we are jammed, exit
 		for (const uint8_t p : punit.GetSharedVision()) {
 			if (p == pradar.Index) {
 				continue;
 			}
-			if (jamming[p] > 0) {
+			if (visibility.RadarJammer(p, index) > 0) {
 				return 0;
 			}
 		}
@@ -71,15 +70,13 @@ IsTileRadarVisible(const CPlayer &pradar, const CPlayer &punit, const CMapFieldP
 			if (p == pradar.Index) {
 				continue;
 			}
-			if (radar[p] > 0) {
-				radarvision |= radar[p];
-			}
+			radarvision |= visibility.Radar(p, index);
 		}
 
 		// Can't exit until the end, as we might be jammed
-		return (radarvision | mfp.Radar[pradar.Index]);
+		return (radarvision | visibility.Radar(pradar.Index, index));
 	}
-	return mfp.Radar[pradar.Index];
+	return visibility.Radar(pradar.Index, index);
 }
 
 
@@ -89,14 +86,11 @@ bool CUnit::IsVisibleOnRadar(const CPlayer &pradar) const
 	unsigned int index = Offset;
 	int j = Type->TileHeight;
 	do {
-		const CMapField *mf = Map.Field(index);
-		int i = x_max;
-		do {
-			if (IsTileRadarVisible(pradar, *Player, mf->playerInfo) != 0) {
+		for (int i = 0; i != x_max; ++i) {
+			if (IsTileRadarVisible(pradar, *Player, index + i) != 0) {
 				return true;
 			}
-			++mf;
-		} while (--i);
+		}
 		index += Map.Info.MapWidth;
 	} while (--j);
 
@@ -114,8 +108,8 @@ bool CUnit::IsVisibleOnRadar(const CPlayer &pradar) const
 */
 void MapMarkTileRadar(const CPlayer &player, const unsigned int index)
 {
-	Assert(Map.Field(index)->playerInfo.Radar[player.Index] != 255);
-	Map.Field(index)->playerInfo.Radar[player.Index]++;
+	Assert(Map.Visibility.Radar(player.Index, index) != 255);
+	Map.Visibility.Radar(player.Index, index)++;
 }
 
 void MapMarkTileRadar(const CPlayer &player, int x, int y)
@@ -135,7 +129,7 @@ void MapMarkTileRadar(const CPlayer &player, int x, int y)
 void MapUnmarkTileRadar(const CPlayer &player, const unsigned int index)
 {
 	// Reduce radar coverage if it exists.
-	unsigned char *v = &(Map.Field(index)->playerInfo.Radar[player.Index]);
+	unsigned char *v = &Map.Visibility.Radar(player.Index, index);
 	if (*v) {
 		--*v;
 	}
@@ -157,8 +151,8 @@ void MapUnmarkTileRadar(const CPlayer &player, int x, int y)
 */
 void MapMarkTileRadarJammer(const CPlayer &player, const unsigned int index)
 {
-	Assert(Map.Field(index)->playerInfo.RadarJammer[player.Index] != 255);
-	Map.Field(index)->playerInfo.RadarJammer[player.Index]++;
+	Assert(Map.Visibility.RadarJammer(player.Index, index) != 255);
+	Map.Visibility.RadarJammer(player.Index, index)++;
 }
 
 void MapMarkTileRadarJammer(const CPlayer &player, int x, int y)
@@ -177,7 +171,7 @@ void MapMarkTileRadarJammer(const CPlayer &player, int x, int y)
 void MapUnmarkTileRadarJammer(const CPlayer &player, const unsigned int index)
 {
 	// Reduce radar coverage if it exists.
-	unsigned char *v = &(Map.Field(index)->playerInfo.RadarJammer[player.Index]);
+	unsigned char *v = &Map.Visibility.RadarJammer(player.Index, index);
 	if (*v) {
 		--*v;
 	}
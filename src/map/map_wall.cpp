@@ -38,6 +38,7 @@
 #include "stratagus.h"
 #include "map.h"
 #include "fov.h"
+#include "pathfinder.h"
 #include "tileset.h"
 #include "ui.h"
 #include "player.h"
@@ -221,6 +222,7 @@ void CMap::RemoveWall(const Vec2i &pos)
 	MapFixWallTile(pos);
 	mf.Flags &= ~(MapFieldHuman | MapFieldWall | MapFieldUnpassable | MapFieldOpaque);
 	MapFixWallNeighbors(pos);
+	MapTerrainChanged(pos, Vec2i(1, 1));
 	UI.Minimap.UpdateXY(pos);
 
 	if (mf.playerInfo.IsTeamVisible(*ThisPlayer)) {
@@ -258,6 +260,7 @@ void CMap::SetWall(const Vec2i &pos, bool humanwall)
 	UI.Minimap.UpdateXY(pos);
 	MapFixWallTile(pos);
 	MapFixWallNeighbors(pos);
+	MapTerrainChanged(pos, Vec2i(1, 1));
 
 	/// Refresh vision of nearby units in case is walls are set as opaque field
 	if (isOpaque) {
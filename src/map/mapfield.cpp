@@ -40,6 +40,7 @@
 #include "fov.h"
 #include "iolib.h"
 #include "map.h"
+#include "net_serialization.h"
 #include "player.h"
 #include "script.h"
 #include "tileset.h"
@@ -131,7 +132,7 @@ void CMapField::Save(CFile &file) const
 {
 	file.printf("  {%3d, %3d, %2d, %2d", tile, playerInfo.SeenTile, Value, cost);
 	for (int i = 0; i != PlayerMax; ++i) {
-		if (playerInfo.Visible[i] == 1) {
+		if (playerInfo.GetVisible(i) == 1) {
 			file.printf(", \"explored\", %d", i);
 		}
 	}
@@ -194,6 +195,76 @@ void CMapField::Save(CFile &file) const
 	file.printf("}");
 }
 
+/// Flags kept in the save games, like the ones written by CMapField::Save
+static constexpr tile_flags MapFieldSavedFlags = MapFieldOpaque | MapFieldHuman | MapFieldLandAllowed
+	| MapFieldCoastAllowed | MapFieldWaterAllowed | MapFieldNoBuilding | MapFieldUnpassable
+	| MapFieldWall | MapFieldRocks | MapFieldCost4 | MapFieldCost5 | MapFieldCost6
+	| MapFieldLandUnit | MapFieldAirUnit | MapFieldSeaUnit | MapFieldBuilding;
+static_assert(MapFieldSavedFlags <= 0xFFFF'FFFF, "saved flags must fit into 32 bits");
+static_assert(PlayerMax <= 16, "explored players must fit into 16 bits");
+
+/**
+**  Write the field for the binary map-fields section of the save games.
+**
+**  @param buf  Output buffer of at least SerializedSize bytes.
+**
+**  @return     Number of bytes written.
+*/
+size_t CMapField::Serialize(unsigned char *buf) const
+{
+	uint16_t explored = 0;
+	for (int i = 0; i != PlayerMax; ++i) {
+		if (playerInfo.GetVisible(i) == 1) {
+			explored |= 1 << i;
+		}
+	}
+	unsigned char *p = buf;
+	p += serialize16(p, uint16_t(tile));
+	p += serialize16(p, uint16_t(playerInfo.SeenTile));
+	p += serialize32(p, uint32_t(Value));
+	p += serialize8(p, uint8_t(cost));
+	p += serialize32(p, uint32_t(Flags & MapFieldSavedFlags));
+	p += serialize16(p, explored);
+	Assert(size_t(p - buf) == SerializedSize);
+	return p - buf;
+}
+
+/**
+**  Read the field from the binary map-fields section of the save games.
+**  Same as parse for the field saved by Save.
+**
+**  @param buf  Input buffer of at least SerializedSize bytes.
+**
+**  @return     Number of bytes read.
+*/
+size_t CMapField::Deserialize(const unsigned char *buf)
+{
+	uint16_t tile16;
+	uint16_t seenTile;
+	uint32_t value;
+	uint8_t cost8;
+	uint32_t flags;
+	uint16_t explored;
+	const unsigned char *p = buf;
+	p += deserialize16(p, &tile16);
+	p += deserialize16(p, &seenTile);
+	p += deserialize32(p, &value);
+	p += deserialize8(p, &cost8);
+	p += deserialize32(p, &flags);
+	p += deserialize16(p, &explored);
+
+	this->tile = tile16;
+	this->playerInfo.SeenTile = seenTile;
+	this->Value = value;
+	this->cost = cost8;
+	this->Flags |= flags & MapFieldSavedFlags;
+	for (int i = 0; i != PlayerMax; ++i) {
+		if (explored & (1 << i)) {
+			this->playerInfo.SetVisible(i, 1);
+		}
+	}
+	return p - buf;
+}
 
 void CMapField::parse(lua_State *l)
 {
@@ -215,7 +286,7 @@ void CMapField::parse(lua_State *l)
 
 		if (value == "explored") {
 			++j;
-			this->playerInfo.Visible[LuaToNumber(l, -1, j + 1)] = 1;
+			this->playerInfo.SetVisible(LuaToNumber(l, -1, j + 1), 1);
 		} else if (value == "opaque") {
 			this->Flags |= MapFieldOpaque;
 		} else if (value == "human") {
@@ -348,20 +419,32 @@ bool CMapField::isAOrcWall() const
 //  CMapFieldPlayerInfo
 //
 
+unsigned short CMapFieldPlayerInfo::GetVisible(int player) const
+{
+	return Map.Visibility.GetVisible(player, GetIndex());
+}
+
+void CMapFieldPlayerInfo::SetVisible(int player, unsigned short value)
+{
+	Map.Visibility.SetVisible(player, GetIndex(), value);
+}
+
 unsigned char CMapFieldPlayerInfo::TeamVisibilityState(const CPlayer &player) const
 {
-	if (this->IsVisible(player)) {
+	const unsigned int index = GetIndex();
+	if (Map.Visibility.IsVisible(player.Index, index) || (Map.NoFogOfWar && Map.Visibility.IsExplored(player.Index, index))) {
 		return 2;
 	}
 	unsigned char maxVision = 0;
-	if (this->IsExplored(player)) {
+	if (Map.Visibility.IsExplored(player.Index, index)) {
 		maxVision = 1;
 	}
 
 	for (const uint8_t p : player.GetSharedVision()) {
-		maxVision = std::max<uint8_t>(maxVision, this->Visible[p]);
-		if (maxVision >= 2) {
+		if (Map.Visibility.IsVisible(p, index)) {
 			return 2;
+		} else if (Map.Visibility.IsExplored(p, index)) {
+			maxVision = 1;
 		}
 	}
 
@@ -373,13 +456,14 @@ unsigned char CMapFieldPlayerInfo::TeamVisibilityState(const CPlayer &player) co
 
 bool CMapFieldPlayerInfo::IsExplored(const CPlayer &player) const
 {
-	return this->Visible[player.Index] != 0;
+	return Map.Visibility.IsExplored(player.Index, GetIndex());
 }
 
 bool CMapFieldPlayerInfo::IsVisible(const CPlayer &player) const
 {
-	const bool fogOfWar = !Map.NoFogOfWar;
-	return this->Visible[player.Index] >= 2 || (!fogOfWar && IsExplored(player));
+	const unsigned int index = GetIndex();
+	return Map.Visibility.IsVisible(player.Index, index)
+	       || (Map.NoFogOfWar && Map.Visibility.IsExplored(player.Index, index));
 }
 
 bool CMapFieldPlayerInfo::IsTeamVisible(const CPlayer &player) const
@@ -41,6 +41,7 @@
 #include "iolib.h"
 #include "netconnect.h"
 #include "network.h"
+#include "pathfinder.h"
 #include "script.h"
 #include "tileset.h"
 #include "translate.h"
@@ -92,8 +93,7 @@ static int CclStratagusMap(lua_State *l)
 					CclGetPos(l, &Map.Info.MapWidth, &Map.Info.MapHeight);
 					lua_pop(l, 1);
 
-					Map.Fields.resize(Map.Info.MapWidth * Map.Info.MapHeight);
-					// FIXME: this should be CreateMap or InitMap?
+					Map.Create();
 				} else if (value == "fog-of-war") {
 					Map.NoFogOfWar = false;
 					--k;
@@ -120,6 +120,15 @@ static int CclStratagusMap(lua_State *l)
 						lua_pop(l, 1);
 					}
 					lua_pop(l, 1);
+				} else if (value == "map-fields-file") {
+					// next to the file being loaded
+					lua_getglobal(l, "__file__");
+					const fs::path dir = lua_isstring(l, -1) ? fs::path(lua_tostring(l, -1)).parent_path() : fs::path();
+					lua_pop(l, 1);
+					const fs::path fieldsFile = dir / std::string(LuaToString(l, j + 1, k + 1));
+					if (!Map.LoadFields(fieldsFile)) {
+						LuaError(l, "Can't load the map fields '%s'", fieldsFile.u8string().c_str());
+					}
 				} else {
 					LuaError(l, "Unsupported tag: %s", value.data());
 				}
@@ -834,6 +843,8 @@ void SetTile(const unsigned int tileIndex, const Vec2i &pos, const int value, co
 			CMapField &mf = *Map.Field(pos);
 			mf.setTileIndex(*Map.Tileset, tileIndex, value, uint8_t(elevation));
 		}
+		const int size = Map.Tileset->getLogicalToGraphicalTileSizeMultiplier();
+		MapTerrainChanged(pos, Vec2i(size, size));
 	}
 }
 
@@ -739,6 +739,7 @@ size_t CNetworkCommandSync::Serialize(unsigned char *buf) const
 	unsigned char *p = buf;
 	p += serialize32(p, this->syncSeed);
 	p += serialize32(p, this->syncHash);
+	p += serialize32(p, this->strongHash);
 	return p - buf;
 }
 
@@ -747,6 +748,47 @@ size_t CNetworkCommandSync::Deserialize(const unsigned char *buf)
 	const unsigned char *p = buf;
 	p += deserialize32(p, &this->syncSeed);
 	p += deserialize32(p, &this->syncHash);
+	p += deserialize32(p, &this->strongHash);
+	return p - buf;
+}
+
+//
+// CNetworkSyncBuckets
+//
+
+size_t CNetworkSyncBuckets::Serialize(unsigned char *buf) const
+{
+	unsigned char *p = buf;
+	p += serialize8(p, this->player);
+	p += serialize32(p, uint32_t(this->Buckets.Cycle));
+	for (uint16_t hash : this->Buckets.Regions) {
+		p += serialize16(p, hash);
+	}
+	for (uint16_t hash : this->Buckets.Units) {
+		p += serialize16(p, hash);
+	}
+	for (uint16_t hash : this->Buckets.Players) {
+		p += serialize16(p, hash);
+	}
+	return p - buf;
+}
+
+size_t CNetworkSyncBuckets::Deserialize(const unsigned char *buf)
+{
+	const unsigned char *p = buf;
+	uint32_t cycle;
+	p += deserialize8(p, &this->player);
+	p += deserialize32(p, &cycle);
+	this->Buckets.Cycle = cycle;
+	for (uint16_t &hash : this->Buckets.Regions) {
+		p += deserialize16(p, &hash);
+	}
+	for (uint16_t &hash : this->Buckets.Units) {
+		p += deserialize16(p, &hash);
+	}
+	for (uint16_t &hash : this->Buckets.Players) {
+		p += deserialize16(p, &hash);
+	}
 	return p - buf;
 }
 
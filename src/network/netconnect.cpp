@@ -58,6 +58,7 @@
 #include "player.h"
 #include "script.h"
 #include "settings.h"
+#include "synchash.h"
 #include "version.h"
 #include "video.h"
 
@@ -2070,12 +2071,30 @@ static int CclNetworkDiscoverServers(lua_State *l)
 	return 1;
 }
 
+/**
+**  Enable the strong sync hash, to find the desyncs early and locate them.
+**
+**  @param l  Lua state.
+**
+**  The hash of the state of the units and of the player resources is sent
+**  with the sync messages. It is only compared with the players having it
+**  enabled too. On a mismatch the hashes of the map regions and the unit
+**  slot ranges are exchanged and the differences are printed.
+*/
+static int CclSetStrongSyncHash(lua_State *l)
+{
+	LuaCheckArgs(l, 1);
+	StrongSyncHashEnabled = LuaToBoolean(l, 1);
+	StrongSyncHash.Clear();
+	return 0;
+}
 
 void NetworkCclRegister()
 {
 	lua_register(Lua, "NoRandomPlacementMultiplayer", CclNoRandomPlacementMultiplayer);
 	lua_register(Lua, "UsesRandomPlacementMultiplayer", CclUsesRandomPlacementMultiplayer);
 	lua_register(Lua, "NetworkDiscoverServers", CclNetworkDiscoverServers);
+	lua_register(Lua, "SetStrongSyncHash", CclSetStrongSyncHash);
 }
 
 
@@ -238,6 +238,7 @@
 #include "player.h"
 #include "replay.h"
 #include "sound.h"
+#include "synchash.h"
 #include "translate.h"
 #include "unit.h"
 #include "unit_manager.h"
@@ -302,6 +303,8 @@ static unsigned long NetworkLastCycle[PlayerMax]; /// Last cycle received packet
 
 static unsigned int NetworkSyncSeeds[256];          /// Network sync seeds.
 static unsigned int NetworkSyncHashs[256];          /// Network sync hashs.
+static unsigned int NetworkStrongHashs[256];        /// Network strong sync hashs, 0 if not computed.
+static SyncHashBuckets NetworkSyncHashBuckets[256]; /// Strong sync hash buckets, to find a desync.
 static CNetworkCommandQueue NetworkIn[256][PlayerMax][MaxNetworkCommands]; /// Per-player network packet input queue
 static std::deque<CNetworkCommandQueue> CommandsIn;    /// Network command input queue
 static std::deque<CNetworkCommandQueue> MsgCommandsIn; /// Network message input queue
@@ -516,6 +519,8 @@ void NetworkOnStartGame()
 	}
 	memset(NetworkSyncSeeds, 0, sizeof(NetworkSyncSeeds));
 	memset(NetworkSyncHashs, 0, sizeof(NetworkSyncHashs));
+	memset(NetworkStrongHashs, 0, sizeof(NetworkStrongHashs));
+	std::fill(std::begin(NetworkSyncHashBuckets), std::end(NetworkSyncHashBuckets), SyncHashBuckets());
 	memset(PlayerQuit, 0, sizeof(PlayerQuit));
 	memset(NetworkLastFrame, 0, sizeof(NetworkLastFrame));
 	memset(NetworkLastCycle, 0, sizeof(NetworkLastCycle));
@@ -660,6 +665,35 @@ void NetworkSendChatMessage(const std::string &msg)
 	MsgCommandsIn.push_back(ncq);
 }
 
+/**
+**  Send the strong sync hash buckets of a cycle, so the other players can
+**  find where their game differs.
+**
+**  The packet is sent right away: the game is paused after a desync, so
+**  the command queues are not sent anymore.
+**
+**  @param gameNetCycle  Cycle of the sync message which did not match.
+*/
+static void NetworkSendSyncBuckets(unsigned long gameNetCycle)
+{
+	if (!IsNetworkGame()) {
+		return;
+	}
+	CNetworkSyncBuckets nsb;
+	nsb.player = ThisPlayer->Index;
+	nsb.Buckets = NetworkSyncHashBuckets[gameNetCycle & 0xFF];
+
+	CNetworkPacket packet;
+	packet.Header.Type[0] = MessageSyncBuckets;
+	packet.Header.Type[1] = MessageNone;
+	packet.Header.Cycle = uint8_t(gameNetCycle & 0xFF);
+	packet.Header.OrigPlayer = ThisPlayer->Index;
+	packet.Command[0].resize(nsb.Size());
+	nsb.Serialize(&packet.Command[0][0]);
+
+	NetworkBroadcast(packet, 1);
+}
+
 /**
 **  Remove a player from the game.
 **
@@ -707,6 +741,32 @@ static bool IsNetworkCommandReady(unsigned long gameNetCycle)
 	return true;
 }
 
+/**
+**  Compare the strong sync hash buckets of another player with ours.
+**
+**  @param data  The CNetworkSyncBuckets message.
+*/
+static void ParseSyncBucketsCommand(const std::vector<unsigned char> &data)
+{
+	if (!StrongSyncHashEnabled || data.size() != CNetworkSyncBuckets::Size()) {
+		return;
+	}
+	CNetworkSyncBuckets nsb;
+	nsb.Deserialize(&data[0]);
+	if (nsb.player == ThisPlayer->Index) {
+		return;
+	}
+	const SyncHashBuckets &remote = nsb.Buckets;
+	const SyncHashBuckets &local =
+		NetworkSyncHashBuckets[(remote.Cycle + CNetworkParameter::Instance.NetworkLag) & 0xFF];
+	if (local.Cycle != remote.Cycle) {
+		ErrorPrint("Sync buckets of player %d for cycle %lu are too old\n", nsb.player, remote.Cycle);
+		return;
+	}
+	ErrorPrint("Comparing the sync buckets of player %d\n", nsb.player);
+	StrongSyncHash.PrintDifferences(local, remote);
+}
+
 static void ParseResendCommand(const CNetworkPacket &packet)
 {
 	// Destination cycle (time to execute).
@@ -833,6 +893,11 @@ static void NetworkParseInGameEvent(const unsigned char *buf, int len, const CHo
 			ParseResendCommand(packet);
 			return;
 		}
+		if (packet.Header.Type[i] == MessageSyncBuckets) {
+			// not a command of the game cycles, which are paused after a desync
+			ParseSyncBucketsCommand(packet.Command[i]);
+			return;
+		}
 		// Receive statistic
 		NetworkLastFrame[player] = FrameCounter;
 
@@ -940,9 +1005,14 @@ static void NetworkExecCommand_Sync(const CNetworkCommandQueue &ncq)
 	const unsigned long gameNetCycle = GameCycle;
 	const unsigned int syncSeed = nc.syncSeed;
 	const unsigned int syncHash = nc.syncHash;
+	const unsigned int strongHash = nc.strongHash;
+	// the strong hashes are only compared when both players compute them
+	const bool strongHashDiffers = strongHash && NetworkStrongHashs[gameNetCycle & 0xFF]
+	                               && strongHash != NetworkStrongHashs[gameNetCycle & 0xFF];
 
 	if (syncSeed != NetworkSyncSeeds[gameNetCycle & 0xFF]
-		|| syncHash != NetworkSyncHashs[gameNetCycle & 0xFF]) {
+		|| syncHash != NetworkSyncHashs[gameNetCycle & 0xFF]
+		|| strongHashDiffers) {
 		// if it wasn't already, force enable debug output right now. maybe we get lucky ...
 		EnableDebugPrint = true;
 		EnableUnitDebug = true;
@@ -950,6 +1020,9 @@ static void NetworkExecCommand_Sync(const CNetworkCommandQueue &ncq)
 			// only print this message circa every 5 seconds...
 			SetMessage("%s", _("Network out of sync"));
 			gameInSync = false;
+			if (strongHashDiffers) {
+				NetworkSendSyncBuckets(gameNetCycle);
+			}
 			SetGamePaused(true);
 
 			time_t now;
@@ -961,11 +1034,13 @@ static void NetworkExecCommand_Sync(const CNetworkCommandQueue &ncq)
 			savefile += ".sav";
 			SaveGame(savefile);
 		}
-		ErrorPrint("\nNetwork out of sync seed: %X!=%X , hash: %X!=%X Cycle %lu\n\n",
+		ErrorPrint("\nNetwork out of sync seed: %X!=%X , hash: %X!=%X , strong hash: %X!=%X Cycle %lu\n\n",
 		           syncSeed,
 		           NetworkSyncSeeds[gameNetCycle & 0xFF],
 		           syncHash,
 		           NetworkSyncHashs[gameNetCycle & 0xFF],
+		           strongHash,
+		           NetworkStrongHashs[gameNetCycle & 0xFF],
 		           GameCycle);
 	} else {
 		gameInSync = true;
@@ -1057,6 +1132,7 @@ static void NetworkExecCommand(const CNetworkCommandQueue &ncq)
 */
 static void NetworkSendCommands(unsigned long gameNetCycle)
 {
+	const uint32_t strongHash = StrongSyncHashEnabled ? StrongSyncHash.GetHash() : 0;
 	// No command available, send sync.
 	int numcommands = 0;
 	CNetworkCommandQueue(&ncq)[MaxNetworkCommands] = NetworkIn[gameNetCycle & 0xFF][ThisPlayer->Index];
@@ -1066,6 +1142,7 @@ static void NetworkSendCommands(unsigned long gameNetCycle)
 		ncq[0].Type = MessageSync;
 		nc.syncHash = SyncHash;
 		nc.syncSeed = SyncRandSeed;
+		nc.strongHash = strongHash;
 		ncq[0].Data.resize(nc.Size());
 		nc.Serialize(&ncq[0].Data[0]);
 		ncq[0].Time = gameNetCycle;
@@ -1103,6 +1180,10 @@ static void NetworkSendCommands(unsigned long gameNetCycle)
 	}
 	NetworkSyncSeeds[gameNetCycle & 0xFF] = SyncRandSeed;
 	NetworkSyncHashs[gameNetCycle & 0xFF] = SyncHash;
+	NetworkStrongHashs[gameNetCycle & 0xFF] = strongHash;
+	if (StrongSyncHashEnabled) {
+		StrongSyncHash.GetBuckets(NetworkSyncHashBuckets[gameNetCycle & 0xFF]);
+	}
 	if (IsNetworkGame()) {
 		NetworkSendPacket(ncq);
 	}
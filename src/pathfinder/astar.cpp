@@ -50,6 +50,7 @@
 #include "stratagus.h"
 
 #include "map.h"
+#include "profiler.h"
 #include "settings.h"
 #include "tileset.h"
 #include "unit.h"
@@ -57,7 +58,14 @@
 
 #include "pathfinder.h"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <stdio.h>
+#include <thread>
 
 /*----------------------------------------------------------------------------
 --  Declarations
@@ -72,11 +80,23 @@ struct Node {
 	void SetInGoal();
 	uint8_t GetDirection();
 	void SetDirection(uint8_t dir);
+	int GetOpenIndex() const;
+	void SetOpenIndex(int index);
+	bool IsStale(uint32_t generation) const;
+	void Reset(uint32_t generation);
 private:
 	int32_t CostFromStart;  /// Real costs to reach this point
 	uint16_t CostToGoal;    /// Estimated cost to goal
 	int8_t InGoal;          /// is this point in the goal
 	int8_t Direction;       /// Direction for trace back
+	int32_t OpenIndex;      /// Position in the open set heap + 1, 0 if not in the open set
+	uint32_t Generation;    /// Search which has written this node last
+};
+
+/// Entry of the cost to move cache, only valid for the search it was computed in
+struct CostMoveToCacheEntry {
+	int32_t Cost;           /// Cost to move, -1 for uncrossable tile
+	uint32_t Generation;    /// Search which has computed Cost
 };
 
 struct Open {
@@ -84,10 +104,114 @@ struct Open {
 	void SetCosts(uint64_t costs);
 	uint32_t GetOffset() const;
 	Vec2i pos;
+	int32_t CostToGoal; /// Estimated cost to goal (tie-breaker)
+	int32_t Dist;       /// Manhattan distance to goal (second tie-breaker)
 private:
 	uint32_t Costs; /// complete costs to goal
 };
 
+/**
+**  State of one A* search.
+**
+**  A search only reads the map and the units, so searches using different
+**  contexts can run at the same time in different threads.
+*/
+class AStarContext
+{
+public:
+	explicit AStarContext(bool trace);
+	~AStarContext();
+	AStarContext(const AStarContext &) = delete;
+	AStarContext &operator=(const AStarContext &) = delete;
+
+	int FindPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, int gh,
+	             int tilesizex, int tilesizey, int minrange, int maxrange,
+	             char *path, int pathlen, const CUnit &unit);
+
+	inline Node &GetNode(unsigned int offset);
+	inline int CostMoveTo(unsigned int index, const CUnit &unit);
+
+private:
+	void ClearAll();
+	void CleanUp();
+	inline void HeapSet(int pos, const Open &node);
+	void HeapSiftUp(int pos);
+	void HeapSiftDown(int pos);
+	void RemoveMinimum(int pos);
+	inline int AddNode(const Vec2i &pos, int o, int64_t costs);
+	void ReplaceNode(int pos, int64_t costs);
+	int FindNode(int eo);
+	bool MarkGoal(const Vec2i &goal, int gw, int gh, int tilesizex, int tilesizey,
+	              int minrange, int maxrange, const CUnit &unit);
+	int SavePath(const Vec2i &startPos, const Vec2i &endPos, char *path, int pathLen);
+	int FindSimplePath(const Vec2i &startPos, const Vec2i &goal, int gw, int gh,
+	                   int minrange, int maxrange, char *path, const CUnit &unit);
+
+private:
+	/// cost matrix
+	Node *Matrix = nullptr;
+
+	/**
+	**  The Open set is handled by a binary min-heap.
+	**  The first element of the array holds the item with the smallest cost,
+	**  each Node of the matrix knows its position in the heap (see Node::OpenIndex).
+	*/
+
+	/// The set of Open nodes
+	Open *OpenSet = nullptr;
+	/// The size of the open node set
+	int OpenSetSize = 0;
+
+	CostMoveToCacheEntry *CostMoveToCache = nullptr;
+
+	/**
+	**  Each search has its own generation, nodes of Matrix and entries
+	**  of CostMoveToCache stamped with another generation are left over by
+	**  a previous search and are reset lazily on first access.
+	**  So a search only costs the tiles it touches, not the map size.
+	*/
+	uint32_t Generation = 0;
+
+	int GoalX = 0;
+	int GoalY = 0;
+
+	/// Write the costs in CMapField::lastAStarCost (debug, game thread only)
+	bool Trace;
+};
+
+/**
+**  Worker threads of AStarFindPathBatch, each with its own context.
+**
+**  They are started with the map and sleep between the batches.
+*/
+class AStarWorkerPool
+{
+public:
+	explicit AStarWorkerPool(int count);
+	~AStarWorkerPool();
+	AStarWorkerPool(const AStarWorkerPool &) = delete;
+	AStarWorkerPool &operator=(const AStarWorkerPool &) = delete;
+
+	int Size() const { return Contexts.size(); }
+	void Start(int workerCount, const std::function<void(AStarContext &)> &task);
+	void Wait();
+
+private:
+	void WorkerLoop(int index);
+
+private:
+	std::vector<std::unique_ptr<AStarContext>> Contexts; /// Context of each worker
+	std::vector<std::thread> Threads;                    /// The workers
+	std::mutex Mutex;                                    /// Protects the members below
+	std::condition_variable BatchStarted;                /// Wakes the workers up
+	std::condition_variable BatchFinished;               /// Wakes the game thread up
+	const std::function<void(AStarContext &)> *Task = nullptr; /// Task of the current batch
+	unsigned long Batch = 0;                             /// Number of the current batch
+	int Active = 0;                                      /// Workers taking part in the batch
+	int Running = 0;                                     /// Workers still running the batch
+	bool Quit = false;                                   /// The workers must exit
+};
+
 /// heuristic cost function for a*
 static inline int AStarCosts(const Vec2i &pos, const Vec2i &goalPos)
 {
@@ -111,12 +235,10 @@ const int Heading2Y[9] = { -1, -1, 0, +1, +1, +1, 0, -1, 0 };
 int Heading2O[9];//heading to offset
 const int XY2Heading[3][3] = { {7, 6, 5}, {0, 0, 4}, {1, 2, 3}};
 
-/// cost matrix
-static Node *AStarMatrix;
-
-/// a list of close nodes, helps to speed up the matrix cleaning
+/// size of the open set, the matrix and the cost to move cache of each context
 static int OpenSetMaxSize;
 static int AStarMatrixSize;
+static int CostMoveToCacheSize;
 #define MAX_CLOSE_SET_RATIO 4
 #define MAX_OPEN_SET_RATIO 8 // 10,16 to small
 
@@ -126,6 +248,8 @@ int AStarMovingUnitCrossingCost = 5;
 int AStarMaxSearchIterations = 1024;
 bool AStarKnowUnseenTerrain = false;
 int AStarUnknownTerrainCost = 2;
+bool AStarBatch = false;
+int AStarThreads = std::clamp<int>(std::thread::hardware_concurrency(), 1, 8);
 /// Used to temporary make enemy units unpassable (needs for correct path lenght calculating for automatic targeting alorithm)
 static bool AStarFixedEnemyUnitsUnpassable = false;
 
@@ -133,22 +257,10 @@ static int AStarMapWidth;
 static int AStarMapHeight;
 static int AStarMapMax;
 
-static int AStarGoalX;
-static int AStarGoalY;
-
-/**
-**  The Open set is handled by a stored array
-**  the end of the array holds the item with the smallest cost.
-*/
-
-/// The set of Open nodes
-static Open *OpenSet;
-/// The size of the open node set
-static int OpenSetSize;
-
-static int32_t *CostMoveToCache;
-static int CostMoveToCacheSize;
-static constexpr int CacheNotSet = -1;
+/// Context of the searches run by the game thread
+static std::unique_ptr<AStarContext> AStarMainContext;
+/// Worker threads of AStarFindPathBatch
+static std::unique_ptr<AStarWorkerPool> AStarWorkers;
 
 /*----------------------------------------------------------------------------
 --  Profile
@@ -308,6 +420,31 @@ void Node::SetDirection(uint8_t dir) {
 	this->Direction = dir;
 }
 
+int Node::GetOpenIndex() const {
+	return this->OpenIndex - 1;
+}
+
+void Node::SetOpenIndex(int index) {
+	this->OpenIndex = index + 1;
+}
+
+bool Node::IsStale(uint32_t generation) const {
+	return this->Generation != generation;
+}
+
+void Node::Reset(uint32_t generation) {
+	this->CostFromStart = 0;
+	this->CostToGoal = 0;
+	this->InGoal = 0;
+#ifdef DEBUG
+	this->Direction = -1;
+#else
+	this->Direction = 0;
+#endif
+	this->OpenIndex = 0;
+	this->Generation = generation;
+}
+
 uint32_t Open::GetCosts() const {
 	return this->Costs;
 }
@@ -328,38 +465,59 @@ uint32_t Open::GetOffset() const {
 --  Functions
 ----------------------------------------------------------------------------*/
 
+AStarContext::AStarContext(bool trace) : Trace(trace)
+{
+	// align the matrix, the open set, and the cost to move cache
+	// on 64-byte boundary, so that nodes never straddle cache lines
+	// and the rare full clear (see ClearAll) can use the SIMD
+	// branch of the libc memset
+	Matrix = (Node *)aligned_malloc(64, AStarMatrixSize);
+	OpenSet = (Open *)aligned_malloc(64, OpenSetMaxSize * sizeof(Open));
+	CostMoveToCache = (CostMoveToCacheEntry *)aligned_malloc(64, CostMoveToCacheSize);
+
+	ClearAll();
+}
+
+AStarContext::~AStarContext()
+{
+	aligned_free(Matrix);
+	aligned_free(OpenSet);
+	aligned_free(CostMoveToCache);
+}
+
+/**
+**  Invalidate the whole A* matrix and cost cache.
+**
+**  Only needed at init and when the generation counter wraps around.
+*/
+void AStarContext::ClearAll()
+{
+	// generation 0 is never used by a search, so everything is stale
+	memset(Matrix, 0, AStarMatrixSize);
+	memset(CostMoveToCache, 0, CostMoveToCacheSize);
+	Generation = 0;
+}
+
 /**
 **  Init A* data structures
 */
 void InitAStar(int mapWidth, int mapHeight)
 {
 	// Should only be called once
-	Assert(!AStarMatrix);
+	Assert(!AStarMainContext);
 
 	AStarMapWidth = mapWidth;
 	AStarMapHeight = mapHeight;
 	AStarMapMax =  AStarMapWidth * AStarMapHeight;
 
-	// align the matrix, the open set, and the cost to move cache
-	// on 64-byte boundary, in case the memset/memmove operations
-	// of the libc we're using has a 128/256/512bit SIMD vector
-	// instruction branch, since we might be clearing 8M of
-	// memory for a 2048x2048 map
 	AStarMatrixSize = sizeof(Node) * AStarMapMax;
-	AStarMatrix = (Node *)aligned_malloc(64, AStarMatrixSize);
-	memset(AStarMatrix, 0, AStarMatrixSize);
-#ifdef DEBUG
-	for (int i = 0; i < AStarMapMax; i++) {
-		AStarMatrix[i].SetDirection(-1);
-	}
-#endif
-
 	OpenSetMaxSize = AStarMapMax / MAX_OPEN_SET_RATIO;
-	OpenSet = (Open *)aligned_malloc(64, OpenSetMaxSize * sizeof(Open));
+	CostMoveToCacheSize = sizeof(CostMoveToCacheEntry) * AStarMapMax;
 
-	CostMoveToCacheSize = sizeof(int32_t) * AStarMapMax;
-	CostMoveToCache = (int32_t*)aligned_malloc(64, CostMoveToCacheSize);
-	memset(CostMoveToCache, CacheNotSet, CostMoveToCacheSize);
+	AStarMainContext = std::make_unique<AStarContext>(true);
+	if (AStarBatch && AStarThreads > 1) {
+		AStarWorkers = std::make_unique<AStarWorkerPool>(AStarThreads - 1);
+	}
 
 	for (int i = 0; i < 9; ++i) {
 		Heading2O[i] = Heading2Y[i] * AStarMapWidth;
@@ -373,62 +531,135 @@ void InitAStar(int mapWidth, int mapHeight)
 */
 void FreeAStar()
 {
-	aligned_free(AStarMatrix);
-	AStarMatrix = nullptr;
-	aligned_free(OpenSet);
-	OpenSet = nullptr;
-	OpenSetSize = 0;
-	aligned_free(CostMoveToCache);
-	CostMoveToCache = nullptr;
+	AStarMainContext.reset();
+	AStarWorkers.reset();
 
 	ProfilePrint();
 }
 
 /**
-**  Prepare pathfinder.
+**  Start a new search.
+**
+**  Nothing is cleared here, bumping the generation makes all the data
+**  of the previous search stale.
 */
-static void AStarPrepare()
+void AStarContext::CleanUp()
 {
-	memset(AStarMatrix, 0, AStarMatrixSize);
-#ifdef DEBUG
-	for (int i = 0; i < AStarMapMax; i++) {
-		AStarMatrix[i].SetDirection(-1);
+	ProfileBegin("AStarCleanUp");
+	if (++Generation == 0) {
+		ClearAll();
+		++Generation;
 	}
-#endif
+	ProfileEnd("AStarCleanUp");
 }
 
 /**
-**  Clean up A*
+**  Get the node at offset for the current search.
+**  A stale node left by a previous search is reset first.
 */
-static void CostMoveToCacheCleanUp();
-static void AStarCleanUp()
+inline Node &AStarContext::GetNode(unsigned int offset)
 {
-	ProfileBegin("AStarCleanUp");
-	AStarPrepare();
-	CostMoveToCacheCleanUp();
-	ProfileEnd("AStarCleanUp");
+	Node &node = Matrix[offset];
+	if (node.IsStale(Generation)) {
+		node.Reset(Generation);
+	}
+	return node;
+}
+
+/**
+**  Order of the open set.
+**
+**  @return  true if lhs has to be expanded before rhs.
+**
+**  Ties on the costs are broken by the estimated cost to goal, then by
+**  the distance to goal, then by the offset so that the order is total
+**  and the search stays deterministic.
+*/
+static inline bool AStarOpenBefore(const Open &lhs, const Open &rhs)
+{
+	if (lhs.GetCosts() != rhs.GetCosts()) {
+		return lhs.GetCosts() < rhs.GetCosts();
+	}
+	if (lhs.CostToGoal != rhs.CostToGoal) {
+		return lhs.CostToGoal < rhs.CostToGoal;
+	}
+	if (lhs.Dist != rhs.Dist) {
+		return lhs.Dist < rhs.Dist;
+	}
+	return lhs.GetOffset() < rhs.GetOffset();
+}
+
+/**
+**  Store node at position pos of the heap and update its handle in the matrix.
+*/
+inline void AStarContext::HeapSet(int pos, const Open &node)
+{
+	OpenSet[pos] = node;
+	GetNode(node.GetOffset()).SetOpenIndex(pos);
 }
 
-static void CostMoveToCacheCleanUp()
+/**
+**  Move the node at position pos up the heap until its parent is better.
+*/
+void AStarContext::HeapSiftUp(int pos)
 {
-	memset(CostMoveToCache, CacheNotSet, CostMoveToCacheSize);
+	const Open node = OpenSet[pos];
+
+	while (pos > 0) {
+		const int parent = (pos - 1) >> 1;
+		if (!AStarOpenBefore(node, OpenSet[parent])) {
+			break;
+		}
+		HeapSet(pos, OpenSet[parent]);
+		pos = parent;
+	}
+	HeapSet(pos, node);
+}
+
+/**
+**  Move the node at position pos down the heap until its children are worse.
+*/
+void AStarContext::HeapSiftDown(int pos)
+{
+	const Open node = OpenSet[pos];
+
+	while (true) {
+		int child = 2 * pos + 1;
+		if (child >= OpenSetSize) {
+			break;
+		}
+		if (child + 1 < OpenSetSize && AStarOpenBefore(OpenSet[child + 1], OpenSet[child])) {
+			++child;
+		}
+		if (!AStarOpenBefore(OpenSet[child], node)) {
+			break;
+		}
+		HeapSet(pos, OpenSet[child]);
+		pos = child;
+	}
+	HeapSet(pos, node);
 }
 
 /**
 **  Find the best node in the current open node set
 **  Returns the position of this node in the open node set
 */
-#define AStarFindMinimum() (OpenSetSize - 1)
+#define AStarFindMinimum() (0)
 
 
 /**
 **  Remove the minimum from the open node set
 */
-static void AStarRemoveMinimum(int pos)
+void AStarContext::RemoveMinimum(int pos)
 {
-	Assert(pos == OpenSetSize - 1);
+	Assert(pos == 0 && OpenSetSize > 0);
 
+	GetNode(OpenSet[pos].GetOffset()).SetOpenIndex(-1);
 	OpenSetSize--;
+	if (OpenSetSize > 0) {
+		OpenSet[pos] = OpenSet[OpenSetSize];
+		HeapSiftDown(pos);
+	}
 }
 
 /**
@@ -436,17 +667,10 @@ static void AStarRemoveMinimum(int pos)
 **
 **  @return  0 or PF_FAILED
 */
-static inline int AStarAddNode(const Vec2i &pos, int o, int64_t costs)
+inline int AStarContext::AddNode(const Vec2i &pos, int o, int64_t costs)
 {
 	ProfileBegin("AStarAddNode");
 
-	int32_t bigi = 0, smalli = OpenSetSize;
-	int32_t midi;
-	uint32_t midcost;
-	int32_t midCostToGoal;
-	int32_t midDist;
-	const Open *open;
-
 	if (OpenSetSize + 1 >= OpenSetMaxSize) {
 		ErrorPrint("A* internal error: raise Open Set Max Size (current value %d)\n",
 		           OpenSetMaxSize);
@@ -454,45 +678,16 @@ static inline int AStarAddNode(const Vec2i &pos, int o, int64_t costs)
 		return PF_FAILED;
 	}
 
-	const int costToGoal = AStarMatrix[o].GetCostToGoal();
-	const int dist = std::abs(pos.x - AStarGoalX) + std::abs(pos.y - AStarGoalY);
-
-	// find where we should insert this node.
-	// binary search where to insert the new node
-	while (bigi < smalli) {
-		midi = (smalli + bigi) >> 1;
-		open = &OpenSet[midi];
-		midcost = open->GetCosts();
-		midCostToGoal = AStarMatrix[open->GetOffset()].GetCostToGoal();
-		midDist = std::abs(open->pos.x - AStarGoalX) + std::abs(open->pos.y - AStarGoalY);
-		if (costs > midcost || (costs == midcost
-								&& (costToGoal > midCostToGoal || (costToGoal == midCostToGoal
-																   && dist > midDist)))) {
-			smalli = midi;
-		} else if (costs < midcost || (costs == midcost
-									   && (costToGoal < midCostToGoal || (costToGoal == midCostToGoal
-											   && dist < midDist)))) {
-			if (bigi == midi) {
-				bigi++;
-			} else {
-				bigi = midi;
-			}
-		} else {
-			bigi = midi;
-			smalli = midi;
-		}
-	}
-
-	if (OpenSetSize > bigi) {
-		// free a the slot for our node
-		memmove(&OpenSet[bigi + 1], &OpenSet[bigi], (OpenSetSize - bigi) * sizeof(Open));
-	}
-
-	// fill our new node
-	OpenSet[bigi].pos = pos;
-	OpenSet[bigi].SetCosts(costs);
+	// fill our new node at the bottom of the heap
+	Open &node = OpenSet[OpenSetSize];
+	node.pos = pos;
+	node.SetCosts(costs);
+	node.CostToGoal = GetNode(o).GetCostToGoal();
+	node.Dist = std::abs(pos.x - GoalX) + std::abs(pos.y - GoalY);
 	++OpenSetSize;
 
+	HeapSiftUp(OpenSetSize - 1);
+
 	ProfileEnd("AStarAddNode");
 
 	return 0;
@@ -500,22 +695,17 @@ static inline int AStarAddNode(const Vec2i &pos, int o, int64_t costs)
 
 /**
 **  Change the cost associated to an open node.
-**  Can be further optimised knowing that the new cost MUST BE LOWER
-**  than the old one.
+**  The new cost MUST BE LOWER than the old one,
+**  so the node can only move up in the heap.
 */
-static void AStarReplaceNode(int pos)
+void AStarContext::ReplaceNode(int pos, int64_t costs)
 {
 	ProfileBegin("AStarReplaceNode");
 
-	Open node;
-
-	// Remove the outdated node
-	node = OpenSet[pos];
-	OpenSetSize--;
-	memmove(&OpenSet[pos], &OpenSet[pos+1], sizeof(Open) * (OpenSetSize-pos));
+	Assert(costs <= OpenSet[pos].GetCosts());
+	OpenSet[pos].SetCosts(costs);
+	HeapSiftUp(pos);
 
-	// Re-add the node with the new cost
-	AStarAddNode(node.pos, node.GetOffset(), node.GetCosts());
 	ProfileEnd("AStarReplaceNode");
 }
 
@@ -525,24 +715,24 @@ static void AStarReplaceNode(int pos)
 **
 **  @return  -1 if not found and the position of the node in the table if found.
 */
-static int AStarFindNode(int eo)
+int AStarContext::FindNode(int eo)
 {
-	ProfileBegin("AStarFindNode");
-
-	for (int i = 0; i < OpenSetSize; ++i) {
-		if (OpenSet[i].GetOffset() == eo) {
-			ProfileEnd("AStarFindNode");
-			return i;
-		}
-	}
-	ProfileEnd("AStarFindNode");
-	return -1;
+	return GetNode(eo).GetOpenIndex();
 }
 
 #define GetIndex(x, y) (x) + (y) * AStarMapWidth
 
+#ifdef DEBUG
+static inline void AStarTraceCost(const CMapField *mf, bool trace, int cost)
+{
+	if (trace) {
+		const_cast<CMapField *>(mf)->lastAStarCost = cost;
+	}
+}
+#endif
+
 /* build-in costmoveto code */
-static int CostMoveToCallBack_Default(unsigned int index, const CUnit &unit)
+static int CostMoveToCallBack_Default(unsigned int index, const CUnit &unit, bool trace)
 {
 #ifdef DEBUG
 	{
@@ -568,7 +758,7 @@ static int CostMoveToCallBack_Default(unsigned int index, const CUnit &unit)
 				if (flag & ~(MapFieldLandUnit | MapFieldAirUnit | MapFieldSeaUnit)) {
 					// we can't cross fixed units and other unpassable things
 #ifdef DEBUG
-					const_cast<CMapField *>(mf)->lastAStarCost = -1;
+					AStarTraceCost(mf, trace, -1);
 #endif
 					return -1;
 				}
@@ -578,7 +768,7 @@ static int CostMoveToCallBack_Default(unsigned int index, const CUnit &unit)
 					// Shouldn't happen, mask says there is something on this tile
 					Assert(0);
 #ifdef DEBUG
-					const_cast<CMapField *>(mf)->lastAStarCost = -1;
+					AStarTraceCost(mf, trace, -1);
 #endif
 					return -1;
 				}
@@ -590,7 +780,7 @@ static int CostMoveToCallBack_Default(unsigned int index, const CUnit &unit)
 					if (&unit != goal) {
 						if (GetAStarFixedEnemyUnitsUnpassable() == true) {
 #ifdef DEBUG
-							const_cast<CMapField *>(mf)->lastAStarCost = -1;
+							AStarTraceCost(mf, trace, -1);
 #endif
 							return -1;
 						}
@@ -600,7 +790,7 @@ static int CostMoveToCallBack_Default(unsigned int index, const CUnit &unit)
 						} else {
 						// FIXME: Need support for moving a fixed unit to add cost
 #ifdef DEBUG
-							const_cast<CMapField *>(mf)->lastAStarCost = -1;
+							AStarTraceCost(mf, trace, -1);
 #endif
 							return -1;
 						}
@@ -616,7 +806,7 @@ static int CostMoveToCallBack_Default(unsigned int index, const CUnit &unit)
 			// Add tile movement cost
 			cost += mf->getCost();
 #ifdef DEBUG
-			const_cast<CMapField *>(mf)->lastAStarCost = cost;
+			AStarTraceCost(mf, trace, cost);
 #endif
 			++mf;
 		} while (--i);
@@ -637,38 +827,35 @@ static int CostMoveToCallBack_Default(unsigned int index, const CUnit &unit)
 **                0 -> no induced cost, except move
 **               >0 -> costly tile
 */
-static inline int CostMoveTo(unsigned int index, const CUnit &unit)
+inline int AStarContext::CostMoveTo(unsigned int index, const CUnit &unit)
 {
-	int32_t *c = &CostMoveToCache[index];
-	if (*c != CacheNotSet) {
-		// for performance reasons, CostMoveToCache uses -1 to
-		// indicate it is unset, but the algorithm is simpler
-		// if the range of costs is [-1, INT_MAX]. so we always
-		// store everything +1
-		return *c - 1;
-	}
-	*c = CostMoveToCallBack_Default(index, unit) + 1;
+	CostMoveToCacheEntry &entry = CostMoveToCache[index];
+	if (entry.Generation != Generation) {
+		entry.Cost = CostMoveToCallBack_Default(index, unit, Trace);
+		entry.Generation = Generation;
 #ifdef DEBUG
-	Assert(*c >= 0);
+		Assert(entry.Cost >= -1);
 #endif
-	return *c - 1;
+	}
+	return entry.Cost;
 }
 
 class AStarGoalMarker
 {
 public:
-	AStarGoalMarker(const CUnit &unit, bool *goal_reachable) :
-		unit(unit), goal_reachable(goal_reachable)
+	AStarGoalMarker(AStarContext &context, const CUnit &unit, bool *goal_reachable) :
+		context(context), unit(unit), goal_reachable(goal_reachable)
 	{}
 
 	void operator()(int offset) const
 	{
-		if (CostMoveTo(offset, unit) >= 0) {
-			AStarMatrix[offset].SetInGoal();
+		if (context.CostMoveTo(offset, unit) >= 0) {
+			context.GetNode(offset).SetInGoal();
 			*goal_reachable = true;
 		}
 	}
 private:
+	AStarContext &context;
 	const CUnit &unit;
 	bool *goal_reachable;
 };
@@ -833,14 +1020,14 @@ class MinMaxRangeVisitor
 /**
 **  MarkAStarGoal
 */
-static bool AStarMarkGoal(const Vec2i &goal,
-                          int gw,
-                          int gh,
-                          int tilesizex,
-                          int tilesizey,
-                          int minrange,
-                          int maxrange,
-                          const CUnit &unit)
+bool AStarContext::MarkGoal(const Vec2i &goal,
+                            int gw,
+                            int gh,
+                            int tilesizex,
+                            int tilesizey,
+                            int minrange,
+                            int maxrange,
+                            const CUnit &unit)
 {
 	ProfileBegin("AStarMarkGoal");
 
@@ -851,7 +1038,7 @@ static bool AStarMarkGoal(const Vec2i &goal,
 		}
 		unsigned int offset = GetIndex(goal.x, goal.y);
 		if (CostMoveTo(offset, unit) >= 0) {
-			AStarMatrix[offset].SetInGoal();
+			GetNode(offset).SetInGoal();
 			ProfileEnd("AStarMarkGoal");
 			return true;
 		} else {
@@ -865,7 +1052,7 @@ static bool AStarMarkGoal(const Vec2i &goal,
 	gw = std::max(gw, 1);
 	gh = std::max(gh, 1);
 
-	AStarGoalMarker aStarGoalMarker(unit, &goal_reachable);
+	AStarGoalMarker aStarGoalMarker(*this, unit, &goal_reachable);
 	MinMaxRangeVisitor<AStarGoalMarker> visitor(aStarGoalMarker);
 
 	const Vec2i goalBottomRigth(goal.x + gw - 1, goal.y + gh - 1);
@@ -887,7 +1074,7 @@ static bool AStarMarkGoal(const Vec2i &goal,
 **
 **  @return  The length of the path
 */
-static int AStarSavePath(const Vec2i &startPos, const Vec2i &endPos, char *path, int pathLen)
+int AStarContext::SavePath(const Vec2i &startPos, const Vec2i &endPos, char *path, int pathLen)
 {
 	ProfileBegin("AStarSavePath");
 
@@ -900,7 +1087,7 @@ static int AStarSavePath(const Vec2i &startPos, const Vec2i &endPos, char *path,
 	Vec2i curr = endPos;
 	int currO = curr.y * AStarMapWidth;
 	while (curr != startPos) {
-		direction = AStarMatrix[currO + curr.x].GetDirection();
+		direction = GetNode(currO + curr.x).GetDirection();
 #ifdef DEBUG
 		Assert(direction >= 0 && direction < 8);
 #endif
@@ -917,7 +1104,7 @@ static int AStarSavePath(const Vec2i &startPos, const Vec2i &endPos, char *path,
 		curr = endPos;
 		currO = curr.y * AStarMapWidth;
 		while (curr != startPos) {
-			direction = AStarMatrix[currO + curr.x].GetDirection();
+			direction = GetNode(currO + curr.x).GetDirection();
 #ifdef DEBUG
 			Assert(direction >= 0 && direction < 8);
 #endif
@@ -939,9 +1126,8 @@ static int AStarSavePath(const Vec2i &startPos, const Vec2i &endPos, char *path,
 **  Optimization to find a simple path
 **  Check if we're at the goal or if it's 1 tile away
 */
-static int AStarFindSimplePath(const Vec2i &startPos, const Vec2i &goal, int gw, int gh,
-							   int, int, int minrange, int maxrange,
-							   char *path, const CUnit &unit)
+int AStarContext::FindSimplePath(const Vec2i &startPos, const Vec2i &goal, int gw, int gh,
+								 int minrange, int maxrange, char *path, const CUnit &unit)
 {
 	ProfileBegin("AStarFindSimplePath");
 	// At exact destination point already
@@ -985,18 +1171,19 @@ static int AStarFindSimplePath(const Vec2i &startPos, const Vec2i &goal, int gw,
 
 #ifdef DEBUG
 extern bool DumpNextAStar;
-void AStarDumpStats();
+static void AStarDumpStats(AStarContext &context);
 #endif
 
 /**
 **  Find path.
 */
-int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPosIn, int gw, int gh,
-				  int tilesizex, int tilesizey, int minrange, int maxrange,
-				  char *path, int pathlen, const CUnit &unit)
+int AStarContext::FindPath(const Vec2i &startPos, const Vec2i &goalPosIn, int gw, int gh,
+						   int tilesizex, int tilesizey, int minrange, int maxrange,
+						   char *path, int pathlen, const CUnit &unit)
 {
 	Assert(Map.Info.IsPointOnMap(startPos));
 
+	PROFILE_ZONE("AStarFindPath");
 	ProfileBegin("AStarFindPath");
 
 	Vec2i goalPos = goalPosIn;
@@ -1016,23 +1203,22 @@ int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPosIn, int gw, int gh,
 	const int maxMapX = AStarMapWidth + 1 - tilesizex;
 	const int maxMapY = AStarMapHeight + 1 - tilesizey;
 
-	AStarGoalX = goalPos.x;
-	AStarGoalY = goalPos.y;
+	GoalX = goalPos.x;
+	GoalY = goalPos.y;
+
+	//  Initialize
+	CleanUp();
 
 	//  Check for simple cases first
-	int ret = AStarFindSimplePath(startPos, goalPos, gw, gh, tilesizex, tilesizey,
-								  minrange, maxrange, path, unit);
+	int ret = FindSimplePath(startPos, goalPos, gw, gh, minrange, maxrange, path, unit);
 	if (ret != PF_FAILED) {
 		ProfileEnd("AStarFindPath");
 		return ret;
 	}
 
-	//  Initialize
-	AStarCleanUp();
-
 	OpenSetSize = 0;
 
-	if (!AStarMarkGoal(goalPos, gw, gh, tilesizex, tilesizey, minrange, maxrange, unit)) {
+	if (!MarkGoal(goalPos, gw, gh, tilesizex, tilesizey, minrange, maxrange, unit)) {
 		// goal is not reachable
 		ret = PF_UNREACHABLE;
 		ProfileEnd("AStarFindPath");
@@ -1042,19 +1228,19 @@ int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPosIn, int gw, int gh,
 	int eo = startPos.y * AStarMapWidth + startPos.x;
 	// it is quite important to start from 1 rather than 0, because we use
 	// 0 as a way to represent nodes that we have not visited yet.
-	AStarMatrix[eo].SetCostFromStart(1);
+	GetNode(eo).SetCostFromStart(1);
 	// 8 to say we are came from nowhere.
-	AStarMatrix[eo].SetDirection(8);
+	GetNode(eo).SetDirection(8);
 
 	// place start point in open, it that failed, try another pathfinder
 	int costToGoal = AStarCosts(startPos, goalPos);
-	AStarMatrix[eo].SetCostToGoal(costToGoal);
-	if (AStarAddNode(startPos, eo, 1 + costToGoal) == PF_FAILED) {
+	GetNode(eo).SetCostToGoal(costToGoal);
+	if (AddNode(startPos, eo, 1 + costToGoal) == PF_FAILED) {
 		ret = PF_FAILED;
 		ProfileEnd("AStarFindPath");
 		return ret;
 	}
-	if (AStarMatrix[eo].IsInGoal()) {
+	if (GetNode(eo).IsInGoal()) {
 		ret = PF_REACHED;
 		ProfileEnd("AStarFindPath");
 		return ret;
@@ -1067,8 +1253,8 @@ int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPosIn, int gw, int gh,
 	while (1) {
 		// Find the best node of from the open set
 #ifdef DEBUG
-		if (DumpNextAStar) {
-			AStarDumpStats();
+		if (DumpNextAStar && Trace) {
+			AStarDumpStats(*this);
 		}
 #endif
 		const int shortest = AStarFindMinimum();
@@ -1076,10 +1262,10 @@ int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPosIn, int gw, int gh,
 		const int y = OpenSet[shortest].pos.y;
 		const int o = OpenSet[shortest].GetOffset();
 
-		AStarRemoveMinimum(shortest);
+		RemoveMinimum(shortest);
 
 		// If we have reached the goal, then exit.
-		if (AStarMatrix[o].IsInGoal()) {
+		if (GetNode(o).IsInGoal()) {
 			endPos.x = x;
 			endPos.y = y;
 			break;
@@ -1100,10 +1286,10 @@ int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPosIn, int gw, int gh,
 
 		// Node that this node was generated from.
 #ifdef DEBUG
-		Assert(AStarMatrix[o].GetDirection() >= 0 && (AStarMatrix[o].GetDirection() < 8 || (x == startPos.x && y == startPos.y)));
+		Assert(GetNode(o).GetDirection() >= 0 && (GetNode(o).GetDirection() < 8 || (x == startPos.x && y == startPos.y)));
 #endif
-		const int px = x - Heading2X[(int)AStarMatrix[o].GetDirection()];
-		const int py = y - Heading2Y[(int)AStarMatrix[o].GetDirection()];
+		const int px = x - Heading2X[(int)GetNode(o).GetDirection()];
+		const int py = y - Heading2Y[(int)GetNode(o).GetDirection()];
 
 		for (int i = 0; i < 8; ++i) {
 			endPos.x = x + Heading2X[i];
@@ -1125,7 +1311,7 @@ int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPosIn, int gw, int gh,
 			//eo = GetIndex(ex, ey);
 			eo = o + Heading2X[i] + Heading2O[i];
 
-			if (eo < 0 || eo >= CostMoveToCacheSize) {
+			if (eo < 0 || eo >= AStarMapMax) {
 				// unaccessible tile
 				continue;
 			}
@@ -1141,39 +1327,39 @@ int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPosIn, int gw, int gh,
 
 			// Add a cost for walking to make paths more realistic for the user.
 			new_cost++;
-			new_cost += AStarMatrix[o].GetCostFromStart();
-			if (AStarMatrix[eo].GetCostFromStart() == 0) {
+			new_cost += GetNode(o).GetCostFromStart();
+			if (GetNode(eo).GetCostFromStart() == 0) {
 				--counter;
 				// we are sure the current node has not been already visited
-				AStarMatrix[eo].SetCostFromStart(new_cost);
-				AStarMatrix[eo].SetDirection(i);
+				GetNode(eo).SetCostFromStart(new_cost);
+				GetNode(eo).SetDirection(i);
 				costToGoal = AStarCosts(endPos, goalPos);
-				AStarMatrix[eo].SetCostToGoal(costToGoal);
-				if (AStarAddNode(endPos, eo, new_cost + costToGoal) == PF_FAILED) {
+				GetNode(eo).SetCostToGoal(costToGoal);
+				if (AddNode(endPos, eo, new_cost + costToGoal) == PF_FAILED) {
 					ret = PF_FAILED;
 					ProfileEnd("AStarFindPath");
 					return ret;
 				}
-			} else if (new_cost < AStarMatrix[eo].GetCostFromStart()) {
+			} else if (new_cost < GetNode(eo).GetCostFromStart()) {
 				--counter;
 				// Already visited node, but we have here a better path
 				// I know, it's redundant (but simpler like this)
-				AStarMatrix[eo].SetCostFromStart(new_cost);
-				AStarMatrix[eo].SetDirection(i);
+				GetNode(eo).SetCostFromStart(new_cost);
+				GetNode(eo).SetDirection(i);
 				// this point might be already in the OpenSet
-				const int j = AStarFindNode(eo);
+				const int j = FindNode(eo);
 				if (j == -1) {
 					costToGoal = AStarCosts(endPos, goalPos);
-					AStarMatrix[eo].SetCostToGoal(costToGoal);
-					if (AStarAddNode(endPos, eo, new_cost + costToGoal) == PF_FAILED) {
+					GetNode(eo).SetCostToGoal(costToGoal);
+					if (AddNode(endPos, eo, new_cost + costToGoal) == PF_FAILED) {
 						ret = PF_FAILED;
 						ProfileEnd("AStarFindPath");
 						return ret;
 					}
 				} else {
 					costToGoal = AStarCosts(endPos, goalPos);
-					AStarMatrix[eo].SetCostToGoal(costToGoal);
-					AStarReplaceNode(j);
+					GetNode(eo).SetCostToGoal(costToGoal);
+					ReplaceNode(j, new_cost + costToGoal);
 				}
 				// we don't have to add this point to the close set
 			}
@@ -1186,10 +1372,12 @@ int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPosIn, int gw, int gh,
 	}
 
 #ifdef DEBUG
-	DumpNextAStar = false;
+	if (Trace) {
+		DumpNextAStar = false;
+	}
 #endif
 	AstarDebugPrint("AStar counter %d/%d\n", counter, AStarMaxSearchIterations);
-	const int path_length = AStarSavePath(startPos, endPos, path, pathlen);
+	const int path_length = SavePath(startPos, endPos, path, pathlen);
 
 	ret = path_length;
 
@@ -1197,7 +1385,135 @@ int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPosIn, int gw, int gh,
 	return ret;
 }
 
-void AStarDumpStats()
+/**
+**  Find path.
+**
+**  Searches of the game thread.
+*/
+int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, int gh,
+				  int tilesizex, int tilesizey, int minrange, int maxrange,
+				  char *path, int pathlen, const CUnit &unit)
+{
+	return AStarMainContext->FindPath(startPos, goalPos, gw, gh, tilesizex, tilesizey,
+									  minrange, maxrange, path, pathlen, unit);
+}
+
+AStarWorkerPool::AStarWorkerPool(int count)
+{
+	for (int i = 0; i != count; ++i) {
+		Contexts.push_back(std::make_unique<AStarContext>(false));
+	}
+	for (int i = 0; i != count; ++i) {
+		Threads.emplace_back(&AStarWorkerPool::WorkerLoop, this, i);
+	}
+}
+
+AStarWorkerPool::~AStarWorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(Mutex);
+		Quit = true;
+	}
+	BatchStarted.notify_all();
+	for (std::thread &thread : Threads) {
+		thread.join();
+	}
+}
+
+/**
+**  Wait for the batches and run the task on the context of the worker.
+*/
+void AStarWorkerPool::WorkerLoop(int index)
+{
+	unsigned long lastBatch = 0;
+	std::unique_lock<std::mutex> lock(Mutex);
+
+	while (true) {
+		BatchStarted.wait(lock, [&]() { return Quit || Batch != lastBatch; });
+		if (Quit) {
+			return;
+		}
+		lastBatch = Batch;
+		if (index >= Active) {
+			continue;
+		}
+		const std::function<void(AStarContext &)> &task = *Task;
+		lock.unlock();
+		task(*Contexts[index]);
+		lock.lock();
+		if (--Running == 0) {
+			BatchFinished.notify_one();
+		}
+	}
+}
+
+/**
+**  Start a task on some workers, Wait must be called before the next one.
+**
+**  @param workerCount  Number of workers running the task, at most Size().
+**  @param task         Task, must live until Wait returns.
+*/
+void AStarWorkerPool::Start(int workerCount, const std::function<void(AStarContext &)> &task)
+{
+	Assert(workerCount <= Size());
+	{
+		std::lock_guard<std::mutex> lock(Mutex);
+		Task = &task;
+		Active = workerCount;
+		Running = workerCount;
+		++Batch;
+	}
+	BatchStarted.notify_all();
+}
+
+/**
+**  Wait for the workers to finish the task.
+*/
+void AStarWorkerPool::Wait()
+{
+	std::unique_lock<std::mutex> lock(Mutex);
+
+	BatchFinished.wait(lock, [this]() { return Running == 0; });
+	Task = nullptr;
+}
+
+/**
+**  Find the paths of several requests, using several threads.
+**
+**  Each search is independent from the others and from the thread running
+**  it, so the results are the same as when solved one by one, in any order.
+**  The map and the units must not be modified meanwhile.
+**
+**  @param requests  The requests, AStarRequest::Result and Path are filled.
+*/
+void AStarFindPathBatch(std::vector<AStarRequest> &requests)
+{
+	PROFILE_ZONE_ARG("AStarFindPathBatch", requests.size());
+	std::atomic<size_t> next = 0;
+	const std::function<void(AStarContext &)> solve = [&requests, &next](AStarContext &context) {
+		for (size_t i = next++; i < requests.size(); i = next++) {
+			AStarRequest &request = requests[i];
+			request.Result = context.FindPath(request.StartPos, request.GoalPos,
+											  request.GoalSize.x, request.GoalSize.y,
+											  request.UnitSize.x, request.UnitSize.y,
+											  request.MinRange, request.MaxRange,
+											  request.Path, PathFinderOutput::MAX_PATH_LENGTH,
+											  *request.Unit);
+		}
+	};
+	const int workerCount = AStarWorkers ? std::min<int>(AStarWorkers->Size(), int(requests.size()) - 1) : 0;
+
+	if (workerCount <= 0) {
+		solve(*AStarMainContext);
+		return;
+	}
+	AStarWorkers->Start(workerCount, solve);
+	solve(*AStarMainContext);
+	AStarWorkers->Wait();
+}
+
+#ifdef DEBUG
+static void AStarDumpStats(AStarContext &context)
 {
 	int32_t maxCostFromHome = 0;
 	int32_t minCostFromHome = INT_MAX;
@@ -1205,7 +1521,7 @@ void AStarDumpStats()
 	int32_t minCostToGoal = INT_MAX;
 
 	for (int i = 0; i < AStarMapMax; i++) {
-		Node *m = &AStarMatrix[i];
+		Node *m = &context.GetNode(i);
 		maxCostFromHome = std::max(maxCostFromHome, m->GetCostFromStart());
 		maxCostToGoal = std::max(maxCostToGoal, m->GetCostToGoal());
 		minCostFromHome = m->GetCostFromStart() ? std::min(minCostFromHome, m->GetCostFromStart()) : minCostFromHome;
@@ -1217,7 +1533,7 @@ void AStarDumpStats()
 	if (minCostFromHome) minCostFromHome--;
 
 	for (int i = 0; i < AStarMapMax; i++) {
-		Node *m = &AStarMatrix[i];
+		Node *m = &context.GetNode(i);
 		int r = 0;
 		int g = 0;
 		if (m->GetCostFromStart() && maxCostFromHome - minCostFromHome) {
@@ -1268,6 +1584,7 @@ void AStarDumpStats()
 		}
 	}
 }
+#endif
 
 /*----------------------------------------------------------------------------
 --  Configurable costs
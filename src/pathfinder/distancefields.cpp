@@ -0,0 +1,709 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name distancefields.cpp - Distance fields to the depots and the forest. */
+//
+//      (c) Copyright 2026 by the Stratagus Team
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+//@{
+
+/*
+**  A distance field holds, for every tile, the number of steps to the
+**  nearest of a set of source tiles and the label of that source:
+**
+**    - for each player, resource and movement mask, the sources are the
+**      tiles of the finished depots of the player (and of its allies when
+**      the ally deposits are allowed), labelled by their unit slot.
+**    - for each movement mask, the sources are the forest tiles, labelled
+**      by their tile index.
+**
+**  So FindDeposit and FindTerrainType only read the tile of the worker,
+**  instead of running an A* to each depot or a traversal of the map.
+**
+**  On equal distances the smallest label wins, so a field only depends on
+**  the current sources and terrain, not on the order of the updates.
+**  The fields are updated incrementally: when a source is removed or a
+**  tile is blocked, the tiles whose shortest path went through it are
+**  reset and filled again from the tiles around them.
+**
+**  Only static obstacles are taken into account, like the flow fields.
+**
+**  The distances are stored on 16 bits to keep the fields small on large
+**  maps. The tiles farther than that from the sources are left without
+**  source and the field is marked as saturated, so the callers fall back on
+**  the searches for them.
+*/
+
+/*----------------------------------------------------------------------------
+--  Includes
+----------------------------------------------------------------------------*/
+
+#include "stratagus.h"
+
+#include "pathfinder.h"
+
+#include "map.h"
+#include "player.h"
+#include "profiler.h"
+#include "settings.h"
+#include "unit.h"
+#include "unit_manager.h"
+#include "unittype.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+
+/*----------------------------------------------------------------------------
+--  Declarations
+----------------------------------------------------------------------------*/
+
+/// Flags of moving things, they are ignored by the distance fields
+static constexpr tile_flags DistanceFieldUnitFlags = MapFieldLandUnit | MapFieldAirUnit | MapFieldSeaUnit;
+/// Maximum number of depot fields kept at the same time
+static constexpr size_t DepotFieldMaxCount = 16;
+/// Maximum number of forest fields kept at the same time
+static constexpr size_t ForestFieldMaxCount = 4;
+/// Distance of the tiles without source in reach
+static constexpr uint16_t DistanceFieldNone = UINT16_MAX;
+
+namespace
+{
+
+/// Steps from every tile to the nearest source
+class DistanceField
+{
+public:
+	void Clear();
+	void SetSource(unsigned int offset, int label);
+	void Invalidate(const std::vector<unsigned int> &offsets);
+	void Propagate();
+	void AreaChanged(const Vec2i &pos, const Vec2i &size, tile_flags sourceFlags);
+
+	bool IsPassable(unsigned int offset) const { return (Map.Field(offset)->Flags & Mask) == 0; }
+
+	tile_flags Mask = 0;             /// Static obstacles
+	unsigned long LastUsed = 0;      /// Last game cycle the field was read
+	bool Dirty = true;               /// Must be built again before being read
+	bool Saturated = false;          /// Some tiles are too far from the sources for their distance
+	/// Steps to the nearest source, 0 on the sources, DistanceFieldNone if none
+	std::vector<uint16_t> Distance;
+	std::vector<int> Label;          /// Label of the nearest source, -1 if none
+
+private:
+	std::vector<unsigned int> Queue; /// Tiles whose neighbors must be relaxed
+};
+
+/// Distance to the depots of a player for a resource
+class DepotField : public DistanceField
+{
+public:
+	/// A depot used as source
+	struct Source {
+		int Slot;                    /// Unit slot of the depot, label of its tiles
+		Vec2i Pos;                   /// Top left tile of the depot
+		Vec2i Size;                  /// Size of the depot in tiles
+	};
+
+	bool IsSource(const CUnit &unit) const;
+	void Build();
+	void UnitChanged(const CUnit &unit, bool removed);
+
+	int Player = 0;                  /// Player whose workers read the field
+	int Resource = 0;                /// Resource stored in the depots
+	std::bitset<PlayerMax> Players;  /// Players whose depots are sources
+	std::vector<Source> Sources;     /// Depots used as sources
+
+private:
+	void AddSource(const CUnit &unit);
+	void RemoveSource(std::vector<Source>::iterator it);
+};
+
+/// Distance to the forest
+class ForestField : public DistanceField
+{
+public:
+	void Build();
+};
+
+} // namespace
+
+/*----------------------------------------------------------------------------
+--  Variables
+----------------------------------------------------------------------------*/
+
+bool AStarDistanceFields = false;
+
+static int DistanceFieldMapWidth;
+static int DistanceFieldMapHeight;
+static std::vector<DepotField> DepotFields;
+static std::vector<ForestField> ForestFields;
+/// Tiles being reset by DistanceField::Invalidate, shared by all the fields
+static std::vector<char> DistanceFieldInCone;
+
+/*----------------------------------------------------------------------------
+--  Distance field
+----------------------------------------------------------------------------*/
+
+/// Call f with the offset of each neighbor on the map of a tile
+template <typename F>
+static void ForEachNeighbor(unsigned int offset, F f)
+{
+	const Vec2i pos(offset % DistanceFieldMapWidth, offset / DistanceFieldMapWidth);
+
+	for (int i = 0; i < 8; ++i) {
+		const Vec2i next(pos.x + Heading2X[i], pos.y + Heading2Y[i]);
+		if (Map.Info.IsPointOnMap(next)) {
+			f(Map.getIndex(next));
+		}
+	}
+}
+
+/**
+**  Remove all the sources.
+*/
+void DistanceField::Clear()
+{
+	const unsigned int size = DistanceFieldMapWidth * DistanceFieldMapHeight;
+	Distance.assign(size, DistanceFieldNone);
+	Label.assign(size, -1);
+	Queue.clear();
+	Saturated = false;
+	if (DistanceFieldInCone.size() != size) {
+		DistanceFieldInCone.assign(size, 0);
+	}
+}
+
+/**
+**  Make a tile a source, Propagate spreads it.
+*/
+void DistanceField::SetSource(unsigned int offset, int label)
+{
+	Distance[offset] = 0;
+	Label[offset] = label;
+	Queue.push_back(offset);
+}
+
+/**
+**  Reset the tiles whose distance may go through the given ones (the
+**  removed sources and the blocked tiles), Propagate fills them again
+**  from their surroundings.
+**
+**  @param offsets  Tiles with a finite distance.
+*/
+void DistanceField::Invalidate(const std::vector<unsigned int> &offsets)
+{
+	std::vector<char> &inCone = DistanceFieldInCone;
+	std::vector<unsigned int> cone;
+
+	for (unsigned int offset : offsets) {
+		if (!inCone[offset]) {
+			inCone[offset] = 1;
+			cone.push_back(offset);
+		}
+	}
+	// The tiles one step further than a reset tile may have used it.
+	for (size_t i = 0; i != cone.size(); ++i) {
+		const int next = Distance[cone[i]] + 1;
+		ForEachNeighbor(cone[i], [&](unsigned int offset) {
+			if (!inCone[offset] && Distance[offset] == next) {
+				inCone[offset] = 1;
+				cone.push_back(offset);
+			}
+		});
+	}
+	for (unsigned int offset : cone) {
+		Distance[offset] = DistanceFieldNone;
+		Label[offset] = -1;
+	}
+	for (unsigned int offset : cone) {
+		ForEachNeighbor(offset, [&](unsigned int border) {
+			if (!inCone[border] && Distance[border] != DistanceFieldNone) {
+				Queue.push_back(border);
+			}
+		});
+	}
+	for (unsigned int offset : cone) {
+		inCone[offset] = 0;
+	}
+}
+
+/**
+**  Relax the neighbors of the queued tiles until nothing changes.
+*/
+void DistanceField::Propagate()
+{
+	for (size_t head = 0; head != Queue.size(); ++head) {
+		const unsigned int offset = Queue[head];
+		const int next = Distance[offset] + 1;
+		const int label = Label[offset];
+
+		if (next >= DistanceFieldNone) {
+			Saturated = true;
+			continue;
+		}
+		ForEachNeighbor(offset, [&](unsigned int neighbor) {
+			if (std::pair(next, label) < std::pair<int, int>(Distance[neighbor], Label[neighbor])
+			    && IsPassable(neighbor)) {
+				Distance[neighbor] = next;
+				Label[neighbor] = label;
+				Queue.push_back(neighbor);
+			}
+		});
+	}
+	Queue.clear();
+}
+
+/**
+**  Update the field after a change of the static obstacles of an area.
+**
+**  @param pos          Top left tile of the area.
+**  @param size         Size of the area.
+**  @param sourceFlags  Flags of the source tiles (forest), 0 if the sources
+**                      are not defined by the terrain (depots).
+*/
+void DistanceField::AreaChanged(const Vec2i &pos, const Vec2i &size, tile_flags sourceFlags)
+{
+	std::vector<unsigned int> invalid;
+	std::vector<unsigned int> added;
+	std::vector<unsigned int> opened;
+
+	const int endX = std::min(pos.x + size.x, DistanceFieldMapWidth);
+	const int endY = std::min(pos.y + size.y, DistanceFieldMapHeight);
+	for (int y = std::max<int>(pos.y, 0); y < endY; ++y) {
+		for (int x = std::max<int>(pos.x, 0); x < endX; ++x) {
+			const unsigned int offset = Map.getIndex(x, y);
+			const int distance = Distance[offset];
+
+			if (sourceFlags) {
+				const bool source = (Map.Field(offset)->Flags & sourceFlags) != 0;
+				if (source != (distance == 0)) {
+					if (distance != DistanceFieldNone) {
+						invalid.push_back(offset);
+					}
+					if (source) {
+						added.push_back(offset);
+					}
+					continue;
+				}
+			}
+			if (distance == 0) {
+				// the depots are updated with their units
+				continue;
+			}
+			if (!IsPassable(offset)) {
+				if (distance != DistanceFieldNone) {
+					invalid.push_back(offset);
+				}
+			} else if (distance == DistanceFieldNone) {
+				opened.push_back(offset);
+			}
+		}
+	}
+	Invalidate(invalid);
+	for (unsigned int offset : added) {
+		SetSource(offset, offset);
+	}
+	for (unsigned int offset : opened) {
+		ForEachNeighbor(offset, [&](unsigned int neighbor) {
+			if (Distance[neighbor] != DistanceFieldNone) {
+				Queue.push_back(neighbor);
+			}
+		});
+	}
+	Propagate();
+}
+
+/*----------------------------------------------------------------------------
+--  Depot field
+----------------------------------------------------------------------------*/
+
+/**
+**  Check if a unit is a finished depot of the field, on the map.
+*/
+bool DepotField::IsSource(const CUnit &unit) const
+{
+	return unit.Type->CanStore[Resource] && unit.IsAliveOnMap() && !unit.Constructed
+	       && unit.Player && Players.test(unit.Player->Index);
+}
+
+/**
+**  Compute the field from all the depots.
+*/
+void DepotField::Build()
+{
+	PROFILE_ZONE_ARG("DepotFieldBuild", Player);
+	Clear();
+	Sources.clear();
+	for (int i = 0; i != PlayerMax; ++i) {
+		if (!Players.test(i)) {
+			continue;
+		}
+		for (const CUnit *unit : ::Players[i].GetUnits()) {
+			if (IsSource(*unit)) {
+				AddSource(*unit);
+			}
+		}
+	}
+	Propagate();
+	Dirty = false;
+}
+
+/**
+**  Add the tiles of a depot as sources, Propagate spreads them.
+*/
+void DepotField::AddSource(const CUnit &unit)
+{
+	const Source source{int(UnitNumber(unit)), unit.tilePos,
+	                    Vec2i(unit.Type->TileWidth, unit.Type->TileHeight)};
+	std::vector<unsigned int> tiles;
+
+	for (int y = source.Pos.y; y < source.Pos.y + source.Size.y; ++y) {
+		for (int x = source.Pos.x; x < source.Pos.x + source.Size.x; ++x) {
+			if (Map.Info.IsPointOnMap(x, y)) {
+				tiles.push_back(Map.getIndex(x, y));
+			}
+		}
+	}
+	std::vector<unsigned int> reached;
+	std::copy_if(tiles.begin(), tiles.end(), std::back_inserter(reached), [this](unsigned int offset) {
+		return Distance[offset] != DistanceFieldNone;
+	});
+	Invalidate(reached);
+	for (unsigned int offset : tiles) {
+		SetSource(offset, source.Slot);
+	}
+	Sources.push_back(source);
+}
+
+/**
+**  Remove the tiles of a depot from the sources, Propagate fills the
+**  tiles which were nearest to it.
+*/
+void DepotField::RemoveSource(std::vector<Source>::iterator it)
+{
+	std::vector<unsigned int> tiles;
+
+	for (int y = it->Pos.y; y < it->Pos.y + it->Size.y; ++y) {
+		for (int x = it->Pos.x; x < it->Pos.x + it->Size.x; ++x) {
+			if (!Map.Info.IsPointOnMap(x, y)) {
+				continue;
+			}
+			const unsigned int offset = Map.getIndex(x, y);
+			if (Distance[offset] == 0 && Label[offset] == it->Slot) {
+				tiles.push_back(offset);
+			}
+		}
+	}
+	Invalidate(tiles);
+	Sources.erase(it);
+}
+
+/**
+**  Update the field after a unit was placed, removed or changed.
+**
+**  @param unit     The unit.
+**  @param removed  The unit is being removed from the map.
+*/
+void DepotField::UnitChanged(const CUnit &unit, bool removed)
+{
+	const int slot = UnitNumber(unit);
+	const bool source = !removed && IsSource(unit);
+	const auto it = std::find_if(Sources.begin(), Sources.end(), [&](const Source &depot) {
+		return depot.Slot == slot;
+	});
+
+	if (it != Sources.end()) {
+		if (source && it->Pos == unit.tilePos
+		    && it->Size == Vec2i(unit.Type->TileWidth, unit.Type->TileHeight)) {
+			return;
+		}
+		RemoveSource(it);
+	}
+	if (source) {
+		AddSource(unit);
+	}
+	Propagate();
+}
+
+/*----------------------------------------------------------------------------
+--  Forest field
+----------------------------------------------------------------------------*/
+
+/**
+**  Compute the field from all the forest tiles.
+*/
+void ForestField::Build()
+{
+	PROFILE_ZONE("ForestFieldBuild");
+	Clear();
+	const unsigned int size = DistanceFieldMapWidth * DistanceFieldMapHeight;
+	for (unsigned int offset = 0; offset != size; ++offset) {
+		if (Map.Field(offset)->Flags & MapFieldForest) {
+			SetSource(offset, offset);
+		}
+	}
+	Propagate();
+	Dirty = false;
+}
+
+/*----------------------------------------------------------------------------
+--  Functions
+----------------------------------------------------------------------------*/
+
+/// Players whose depots can be used by the workers of a player
+static std::bitset<PlayerMax> DepotFieldPlayers(const CPlayer &player)
+{
+	std::bitset<PlayerMax> players;
+
+	players.set(player.Index);
+	if (GameSettings.AllyDepositsAllowed) {
+		for (int i = 0; i < PlayerMax - 1; ++i) {
+			if (Players[i].IsAllied(player) && player.IsAllied(Players[i])) {
+				players.set(i);
+			}
+		}
+	}
+	return players;
+}
+
+/// Find or create a field, the least recently used one is dropped when there are too many
+template <typename Field, typename Pred>
+static Field &GetDistanceField(std::vector<Field> &fields, size_t maxCount, Pred pred)
+{
+	auto it = std::find_if(fields.begin(), fields.end(), pred);
+	if (it == fields.end()) {
+		if (fields.size() == maxCount) {
+			fields.erase(std::min_element(fields.begin(), fields.end(), [](const Field &lhs, const Field &rhs) {
+				return lhs.LastUsed < rhs.LastUsed;
+			}));
+		}
+		it = fields.emplace(fields.end());
+	}
+	it->LastUsed = GameCycle;
+	return *it;
+}
+
+/// Check if the fields can be used on the current map
+static bool DistanceFieldsAvailable()
+{
+	return AStarDistanceFields && DistanceFieldMapWidth == Map.Info.MapWidth
+	       && DistanceFieldMapHeight == Map.Info.MapHeight && DistanceFieldMapWidth != 0;
+}
+
+/**
+**  Init the distance fields.
+*/
+void InitDistanceFields(int mapWidth, int mapHeight)
+{
+	DistanceFieldMapWidth = mapWidth;
+	DistanceFieldMapHeight = mapHeight;
+	DepotFields.clear();
+	ForestFields.clear();
+}
+
+/**
+**  Free the distance fields.
+*/
+void FreeDistanceFields()
+{
+	DistanceFieldMapWidth = 0;
+	DistanceFieldMapHeight = 0;
+	DepotFields.clear();
+	ForestFields.clear();
+	DistanceFieldInCone.clear();
+}
+
+/**
+**  Static obstacles of an area have changed (wood cut or regrown, walls,
+**  buildings placed or removed).
+*/
+void DistanceFieldsTerrainChanged(const Vec2i &pos, const Vec2i &size)
+{
+	for (DepotField &field : DepotFields) {
+		if (!field.Dirty) {
+			field.AreaChanged(pos, size, 0);
+		}
+	}
+	for (ForestField &field : ForestFields) {
+		if (!field.Dirty) {
+			field.AreaChanged(pos, size, MapFieldForest);
+		}
+	}
+}
+
+/**
+**  A unit was placed, removed, finished, transformed or given to another
+**  player: update the fields where it is a depot.
+**
+**  @param unit     The unit.
+**  @param removed  The unit is being removed from the map.
+*/
+void DistanceFieldsUnitChanged(const CUnit &unit, bool removed)
+{
+	if (DepotFields.empty()
+	    || std::none_of(std::begin(unit.Type->CanStore), std::end(unit.Type->CanStore),
+	                    [](int store) { return store != 0; })) {
+		return;
+	}
+	for (DepotField &field : DepotFields) {
+		if (!field.Dirty) {
+			field.UnitChanged(unit, removed);
+		}
+	}
+}
+
+/**
+**  Find the nearest depot of a worker on the distance field of its player.
+**
+**  @param worker    The worker (only 1x1 workers are supported).
+**  @param range     Maximum distance to the depot.
+**  @param resource  Resource to store.
+**
+**  @return          The depot, nullptr if none can be reached, or nothing if
+**                   the field can't be used or its depot is out of range.
+*/
+std::optional<CUnit *> DistanceFieldFindDeposit(const CUnit &worker, int range, int resource)
+{
+	if (!DistanceFieldsAvailable() || worker.Type->TileWidth != 1 || worker.Type->TileHeight != 1) {
+		return std::nullopt;
+	}
+	const tile_flags mask = tile_flags(worker.Type->MovementMask) & ~DistanceFieldUnitFlags;
+	const std::bitset<PlayerMax> players = DepotFieldPlayers(*worker.Player);
+	DepotField &field = GetDistanceField(DepotFields, DepotFieldMaxCount, [&](const DepotField &other) {
+		return other.Player == worker.Player->Index && other.Resource == resource && other.Mask == mask;
+	});
+	if (field.Players != players || field.Mask != mask) {
+		// new field, or the alliances have changed
+		field.Player = worker.Player->Index;
+		field.Resource = resource;
+		field.Mask = mask;
+		field.Players = players;
+		field.Dirty = true;
+	}
+	if (field.Dirty) {
+		field.Build();
+	}
+
+	// A worker in a container leaves from a tile around it.
+	const CUnit &start = *GetFirstContainer(worker);
+	int distance = DistanceFieldNone;
+	int label = -1;
+	const auto read = [&](const Vec2i &pos) {
+		if (!Map.Info.IsPointOnMap(pos)) {
+			return;
+		}
+		const unsigned int offset = Map.getIndex(pos);
+		if (std::pair<int, int>(field.Distance[offset], field.Label[offset]) < std::pair(distance, label)) {
+			distance = field.Distance[offset];
+			label = field.Label[offset];
+		}
+	};
+	if (worker.Container == nullptr) {
+		read(worker.tilePos);
+	} else {
+		const Vec2i topLeft = start.tilePos - Vec2i(1, 1);
+		const Vec2i bottomRight = start.tilePos + Vec2i(start.Type->TileWidth, start.Type->TileHeight);
+		for (int x = topLeft.x; x <= bottomRight.x; ++x) {
+			read(Vec2i(x, topLeft.y));
+			read(Vec2i(x, bottomRight.y));
+		}
+		for (int y = topLeft.y + 1; y < bottomRight.y; ++y) {
+			read(Vec2i(topLeft.x, y));
+			read(Vec2i(bottomRight.x, y));
+		}
+	}
+	if (distance == DistanceFieldNone) {
+		if (field.Saturated) {
+			// maybe a depot too far for the field
+			return std::nullopt;
+		}
+		return nullptr;
+	}
+	CUnit &depot = UnitManager->GetSlotUnit(label);
+	if (!field.IsSource(depot)) {
+		// a change was missed, build the field again next time
+		DebugPrint("Distance field of player %d lost depot %d\n", field.Player, label);
+		field.Dirty = true;
+		return std::nullopt;
+	}
+	if (start.MapDistanceTo(depot) > range) {
+		// another depot, farther to walk to, may be in range: let the unit list decide
+		return std::nullopt;
+	}
+	return &depot;
+}
+
+/**
+**  Find the nearest forest tile on the distance field of the forest.
+**
+**  Only for the AI, as the field doesn't care about the explored tiles.
+**
+**  @param startPos      Start tile.
+**  @param movementMask  Movement mask to reach the forest.
+**  @param range         Maximum number of steps to the forest.
+**  @param forestPos     Output: the forest tile, if found.
+**
+**  @return              Whether a forest tile was found, or nothing if the
+**                       field can't be used.
+*/
+std::optional<bool> DistanceFieldFindForest(const Vec2i &startPos, int movementMask, int range, Vec2i *forestPos)
+{
+	if (!DistanceFieldsAvailable()) {
+		return std::nullopt;
+	}
+	const tile_flags mask = tile_flags(movementMask) & ~DistanceFieldUnitFlags;
+	ForestField &field = GetDistanceField(ForestFields, ForestFieldMaxCount, [&](const ForestField &other) {
+		return other.Mask == mask;
+	});
+	if (field.Mask != mask) {
+		field.Mask = mask;
+		field.Dirty = true;
+	}
+	if (field.Dirty) {
+		field.Build();
+	}
+	const unsigned int offset = Map.getIndex(startPos);
+	const int distance = field.Distance[offset];
+	if (distance == 0 || (distance == DistanceFieldNone && !field.IsPassable(offset))) {
+		// FindTerrainType doesn't check the start tile itself
+		return std::nullopt;
+	}
+	if (distance == DistanceFieldNone && field.Saturated) {
+		// maybe a forest too far for the field
+		return std::nullopt;
+	}
+	if (distance > std::max(range, 1)) {
+		return false;
+	}
+	if (forestPos) {
+		*forestPos = Vec2i(field.Label[offset] % DistanceFieldMapWidth, field.Label[offset] / DistanceFieldMapWidth);
+	}
+	return true;
+}
+
+//@}
@@ -0,0 +1,314 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name flowfield.cpp - Shared flow fields for group moves. */
+//
+//      (c) Copyright 2026 by the Stratagus Team
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+//@{
+
+/*
+**  When many units are ordered to the same tile, one integration field
+**  (walking cost to the goal from every tile) is computed with a Dijkstra
+**  from the goal, along with the direction to follow on each tile. Each
+**  unit then only reads its path from the direction field.
+**
+**  Only static obstacles are taken into account, the moving units are
+**  handled by NextPathElement which falls back on A* when blocked.
+**
+**  The field only covers the tiles around the goal up to the distance of
+**  the units which asked for it (plus a margin for detours), the units
+**  farther away use A*.
+*/
+
+/*----------------------------------------------------------------------------
+--  Includes
+----------------------------------------------------------------------------*/
+
+#include "stratagus.h"
+
+#include "pathfinder.h"
+
+#include "map.h"
+#include "profiler.h"
+#include "settings.h"
+#include "tileset.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <queue>
+
+/*----------------------------------------------------------------------------
+--  Declarations
+----------------------------------------------------------------------------*/
+
+/// Flags of moving things, they are ignored by the flow fields
+static constexpr tile_flags FlowFieldUnitFlags = MapFieldLandUnit | MapFieldAirUnit | MapFieldSeaUnit;
+/// Maximum number of flow fields kept at the same time
+static constexpr size_t FlowFieldMaxCount = 8;
+/// Flow fields not used for this number of cycles are freed
+static constexpr unsigned long FlowFieldTimeout = CYCLES_PER_SECOND * 10;
+/// Extra distance around the units covered by a field, for the detours
+static constexpr int FlowFieldMargin = 8;
+/// Maximum distance to the goal covered by a field
+static constexpr int FlowFieldMaxRadius = 64;
+/// Direction of the tiles without path to the goal
+static constexpr int8_t FlowFieldNoHeading = -1;
+
+namespace
+{
+
+/// Flow field towards one goal for one movement mask
+struct FlowField {
+	Vec2i Goal;                      /// Goal tile
+	tile_flags Mask = 0;             /// Static obstacles
+	unsigned long LastUsed = 0;      /// Last game cycle the field was requested
+	int Radius = 0;                  /// Distance to the goal covered by the field
+	/// Cost to the goal of each covered tile, INT_MAX if unreachable
+	std::vector<int> Integration;
+	/// Heading to follow on each covered tile, FlowFieldNoHeading if none
+	std::vector<int8_t> Direction;
+
+	bool IsBuilt() const { return !Direction.empty(); }
+	bool IsPassable(const Vec2i &pos) const { return (Map.Field(pos)->Flags & Mask) == 0; }
+	bool IsCovered(const Vec2i &pos) const
+	{
+		return std::max(std::abs(pos.x - Goal.x), std::abs(pos.y - Goal.y)) <= Radius;
+	}
+	/// Side of the square of covered tiles, centered on the goal
+	int Side() const { return 2 * Radius + 1; }
+	/// Index of a covered tile in Integration and Direction
+	unsigned int Index(const Vec2i &pos) const
+	{
+		return (pos.y - Goal.y + Radius) * Side() + pos.x - Goal.x + Radius;
+	}
+	/// Tile of an index in Integration and Direction
+	Vec2i Pos(unsigned int index) const
+	{
+		return Vec2i(Goal.x - Radius + index % Side(), Goal.y - Radius + index / Side());
+	}
+	void Cover(const Vec2i &startPos);
+	void Build();
+};
+
+} // namespace
+
+/*----------------------------------------------------------------------------
+--  Variables
+----------------------------------------------------------------------------*/
+
+bool AStarFlowField = false;
+
+static int FlowFieldMapWidth;
+static int FlowFieldMapHeight;
+/// Fields (built or only requested once), most recently created last
+static std::vector<FlowField> FlowFields;
+
+/*----------------------------------------------------------------------------
+--  Flow field
+----------------------------------------------------------------------------*/
+
+/**
+**  Extend the area covered by the field (before it is built) to a unit.
+*/
+void FlowField::Cover(const Vec2i &startPos)
+{
+	const int distance = std::max(std::abs(startPos.x - Goal.x), std::abs(startPos.y - Goal.y));
+
+	Radius = std::min(std::max(Radius, distance + FlowFieldMargin), FlowFieldMaxRadius);
+}
+
+/**
+**  Compute the integration and direction fields from the goal, on the
+**  covered tiles only: the fields are stored for the square around the goal.
+*/
+void FlowField::Build()
+{
+	PROFILE_ZONE("FlowFieldBuild");
+	const unsigned int size = Side() * Side();
+	Integration.assign(size, INT_MAX);
+	Direction.assign(size, FlowFieldNoHeading);
+
+	// (cost, index), ties are broken by index (same order as the map offset) to stay deterministic
+	using Entry = std::pair<int, unsigned int>;
+	std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+
+	const unsigned int goalIndex = Index(Goal);
+	Integration[goalIndex] = 0;
+	open.push(Entry(0, goalIndex));
+	while (!open.empty()) {
+		const auto [cost, index] = open.top();
+		open.pop();
+		if (cost != Integration[index]) {
+			continue;
+		}
+		const Vec2i pos = Pos(index);
+		// same as in astar.cpp: 1 for walking plus the tile cost, paid when entering pos
+		const int stepCost = 1 + Map.Field(pos)->getCost();
+
+		for (int i = 0; i < 8; ++i) {
+			const Vec2i prev(pos.x - Heading2X[i], pos.y - Heading2Y[i]);
+			if (!Map.Info.IsPointOnMap(prev) || !IsCovered(prev) || !IsPassable(prev)) {
+				continue;
+			}
+			const unsigned int prevIndex = Index(prev);
+			if (cost + stepCost < Integration[prevIndex]) {
+				Integration[prevIndex] = cost + stepCost;
+				Direction[prevIndex] = i;
+				open.push(Entry(cost + stepCost, prevIndex));
+			}
+		}
+	}
+}
+
+/*----------------------------------------------------------------------------
+--  Functions
+----------------------------------------------------------------------------*/
+
+/**
+**  Init the flow fields.
+*/
+void InitFlowFields(int mapWidth, int mapHeight)
+{
+	FlowFieldMapWidth = mapWidth;
+	FlowFieldMapHeight = mapHeight;
+	FlowFields.clear();
+}
+
+/**
+**  Free the flow fields.
+*/
+void FreeFlowFields()
+{
+	FlowFields.clear();
+}
+
+/**
+**  Static obstacles have changed, the flow fields are no longer valid.
+*/
+void FlowFieldsTerrainChanged()
+{
+	FlowFields.clear();
+}
+
+/**
+**  Check if a goal was already requested, so the next units moving to it
+**  will read their path on its flow field.
+*/
+bool FlowFieldHasGoal(const Vec2i &goalPos, int movementMask)
+{
+	const tile_flags mask = tile_flags(movementMask) & ~FlowFieldUnitFlags;
+
+	return std::any_of(FlowFields.begin(), FlowFields.end(), [&](const FlowField &field) {
+		return field.Goal == goalPos && field.Mask == mask
+		       && field.LastUsed + FlowFieldTimeout >= GameCycle;
+	});
+}
+
+/**
+**  Find a path on a shared flow field.
+**
+**  The first request for a goal only registers it, the field is built
+**  when a second unit asks for the same goal, so single moves keep using A*.
+**
+**  @param startPos      Start tile.
+**  @param goalPos       Goal tile.
+**  @param movementMask  MovementMask of the unit type (only 1x1 units are supported).
+**  @param path          Output: the path, in the same order as AStarFindPath.
+**  @param pathLen       Size of path.
+**
+**  @return              Length of the full path, or PF_FAILED if no field can be used.
+*/
+int FlowFieldFindPath(const Vec2i &startPos, const Vec2i &goalPos, int movementMask,
+                      char *path, int pathLen)
+{
+	Assert(FlowFieldMapWidth == Map.Info.MapWidth && FlowFieldMapHeight == Map.Info.MapHeight);
+
+	if (startPos == goalPos) {
+		return PF_FAILED;
+	}
+	const tile_flags mask = tile_flags(movementMask) & ~FlowFieldUnitFlags;
+
+	// Forget the goals not asked for a while.
+	FlowFields.erase(std::remove_if(FlowFields.begin(), FlowFields.end(), [](const FlowField &field) {
+		return field.LastUsed + FlowFieldTimeout < GameCycle;
+	}), FlowFields.end());
+
+	auto it = std::find_if(FlowFields.begin(), FlowFields.end(), [&](const FlowField &field) {
+		return field.Goal == goalPos && field.Mask == mask;
+	});
+	if (it == FlowFields.end()) {
+		if (FlowFields.size() == FlowFieldMaxCount) {
+			FlowFields.erase(std::min_element(FlowFields.begin(), FlowFields.end(),
+			                                  [](const FlowField &lhs, const FlowField &rhs) {
+				return lhs.LastUsed < rhs.LastUsed;
+			}));
+		}
+		FlowField &field = FlowFields.emplace_back();
+		field.Goal = goalPos;
+		field.Mask = mask;
+		field.LastUsed = GameCycle;
+		field.Cover(startPos);
+		return PF_FAILED;
+	}
+	FlowField &field = *it;
+	field.LastUsed = GameCycle;
+	if (!field.IsPassable(goalPos)) {
+		return PF_FAILED;
+	}
+	if (!field.IsBuilt()) {
+		field.Cover(startPos);
+		field.Build();
+	}
+	if (!field.IsCovered(startPos) || field.Direction[field.Index(startPos)] == FlowFieldNoHeading) {
+		// let A* decide what to do with an unreachable goal
+		return PF_FAILED;
+	}
+
+	// Walk the direction field, keeping the first steps.
+	std::vector<char> steps;
+	steps.reserve(pathLen);
+	int fullPathLength = 0;
+	for (Vec2i pos = startPos; pos != goalPos; ++fullPathLength) {
+		const int direction = field.Direction[field.Index(pos)];
+		Assert(direction != FlowFieldNoHeading);
+		if (fullPathLength < pathLen) {
+			steps.push_back(direction);
+		}
+		pos.x += Heading2X[direction];
+		pos.y += Heading2Y[direction];
+	}
+	if (path) {
+		const int length = steps.size();
+		for (int i = 0; i != length; ++i) {
+			path[length - i - 1] = steps[i];
+		}
+	}
+	return fullPathLength;
+}
+
+//@}
@@ -0,0 +1,273 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name harvestroutes.cpp - Cached routes between mines and depots. */
+//
+//      (c) Copyright 2026 by the Stratagus Team
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+//@{
+
+/*
+**  The harvesters of a mine bringing their goods to the same depot all
+**  walk the same trip. The first one leaving the mine (or the depot)
+**  searches the whole path with A*, and it is kept as a route shared by
+**  the next ones, which only follow it while they stand on it.
+**
+**  A harvester off the route, or blocked by a unit on its next step,
+**  uses the other pathfinders, usually for a short detour. A route is
+**  dropped when the static obstacles change within its bounding box.
+*/
+
+/*----------------------------------------------------------------------------
+--  Includes
+----------------------------------------------------------------------------*/
+
+#include "stratagus.h"
+
+#include "pathfinder.h"
+
+#include "map.h"
+#include "settings.h"
+#include "unit.h"
+#include "unittype.h"
+
+#include <algorithm>
+#include <utility>
+
+/*----------------------------------------------------------------------------
+--  Declarations
+----------------------------------------------------------------------------*/
+
+/// Find and a* path for a unit (astar.cpp)
+extern int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, int gh,
+						 int tilesizex, int tilesizey, int minrange,
+						 int maxrange, char *path, int pathlen, const CUnit &unit);
+
+/// Maximum number of routes kept at the same time
+static constexpr size_t HarvestRouteMaxCount = 64;
+/// Maximum length of a route, the longer trips are not cached
+static constexpr int HarvestRouteMaxLength = 1024;
+/// Routes not used for this number of cycles are freed
+static constexpr unsigned long HarvestRouteTimeout = CYCLES_PER_SECOND * 30;
+
+namespace
+{
+
+/// Route of the harvesters between a mine and a depot
+struct HarvestRoute {
+	int Mine = 0;                    /// Slot of the mine
+	int Depot = 0;                   /// Slot of the depot
+	int MovementMask = 0;            /// MovementMask of the harvesters
+	Vec2i MinePos;                   /// Mine position, the slot may have been reused
+	Vec2i DepotPos;                  /// Depot position, the slot may have been reused
+	std::vector<Vec2i> Tiles;        /// From next to the mine to next to the depot
+	Vec2i TopLeft;                   /// Top left corner of the bounding box of the tiles
+	Vec2i BottomRight;               /// Bottom right corner of the bounding box of the tiles
+	unsigned long LastUsed = 0;      /// Last game cycle the route was followed
+
+	bool IsFor(const CUnit &mine, const CUnit &depot, int movementMask) const
+	{
+		return Mine == UnitNumber(mine) && Depot == UnitNumber(depot) && MovementMask == movementMask
+		       && MinePos == mine.tilePos && DepotPos == depot.tilePos;
+	}
+};
+
+} // namespace
+
+/*----------------------------------------------------------------------------
+--  Variables
+----------------------------------------------------------------------------*/
+
+bool AStarHarvestRoutes = false;
+
+/// Cached routes, most recently created last
+static std::vector<HarvestRoute> HarvestRoutes;
+
+/*----------------------------------------------------------------------------
+--  Functions
+----------------------------------------------------------------------------*/
+
+/**
+**  Search the route of a harvester standing next to the mine or the depot.
+**
+**  @return  The new route, or nullptr if none was found.
+*/
+static HarvestRoute *SearchHarvestRoute(const CUnit &unit, const CUnit &mine, const CUnit &depot, bool toDepot)
+{
+	const CUnit &start = toDepot ? mine : depot;
+	const CUnit &goal = toDepot ? depot : mine;
+
+	if (unit.MapDistanceTo(start) > 1) {
+		return nullptr;
+	}
+	std::vector<char> steps(HarvestRouteMaxLength);
+	const int length = AStarFindPath(unit.tilePos, goal.tilePos, goal.Type->TileWidth, goal.Type->TileHeight,
+	                                 1, 1, 0, 1, steps.data(), HarvestRouteMaxLength, unit);
+	if (length <= 0 || length > HarvestRouteMaxLength) {
+		return nullptr;
+	}
+	// The first step is the last one of the A* path.
+	std::vector<Vec2i> tiles;
+	tiles.reserve(length + 1);
+	Vec2i pos = unit.tilePos;
+	tiles.push_back(pos);
+	for (int i = length - 1; i >= 0; --i) {
+		pos.x += Heading2X[int(steps[i])];
+		pos.y += Heading2Y[int(steps[i])];
+		tiles.push_back(pos);
+	}
+	// A* returns its best path when it looks too long, it doesn't reach the goal.
+	if (goal.MapDistanceTo(pos) > 1) {
+		return nullptr;
+	}
+	if (HarvestRoutes.size() == HarvestRouteMaxCount) {
+		HarvestRoutes.erase(std::min_element(HarvestRoutes.begin(), HarvestRoutes.end(),
+		                                     [](const HarvestRoute &lhs, const HarvestRoute &rhs) {
+			return lhs.LastUsed < rhs.LastUsed;
+		}));
+	}
+	HarvestRoute &route = HarvestRoutes.emplace_back();
+	route.Mine = UnitNumber(mine);
+	route.Depot = UnitNumber(depot);
+	route.MovementMask = unit.Type->MovementMask;
+	route.MinePos = mine.tilePos;
+	route.DepotPos = depot.tilePos;
+	route.LastUsed = GameCycle;
+	route.Tiles = std::move(tiles);
+	if (!toDepot) {
+		std::reverse(route.Tiles.begin(), route.Tiles.end());
+	}
+	route.TopLeft = route.BottomRight = pos;
+	for (const Vec2i &tile : route.Tiles) {
+		route.TopLeft.x = std::min(route.TopLeft.x, tile.x);
+		route.TopLeft.y = std::min(route.TopLeft.y, tile.y);
+		route.BottomRight.x = std::max(route.BottomRight.x, tile.x);
+		route.BottomRight.y = std::max(route.BottomRight.y, tile.y);
+	}
+	return &route;
+}
+
+/**
+**  Free the harvest routes.
+*/
+void FreeHarvestRoutes()
+{
+	HarvestRoutes.clear();
+}
+
+/**
+**  Static obstacles of an area have changed, drop the routes around it.
+**
+**  @param pos   Top left tile of the area.
+**  @param size  Size of the area.
+*/
+void HarvestRoutesTerrainChanged(const Vec2i &pos, const Vec2i &size)
+{
+	const Vec2i end = pos + size - Vec2i(1, 1);
+
+	HarvestRoutes.erase(std::remove_if(HarvestRoutes.begin(), HarvestRoutes.end(), [&](const HarvestRoute &route) {
+		return pos.x <= route.BottomRight.x && route.TopLeft.x <= end.x
+		       && pos.y <= route.BottomRight.y && route.TopLeft.y <= end.y;
+	}), HarvestRoutes.end());
+}
+
+/**
+**  Check if the harvesters of a mine and a depot have a route.
+*/
+bool HarvestRouteHasRoute(const CUnit &mine, const CUnit &depot, int movementMask)
+{
+	return AStarHarvestRoutes
+	       && std::any_of(HarvestRoutes.begin(), HarvestRoutes.end(), [&](const HarvestRoute &route) {
+		return route.IsFor(mine, depot, movementMask);
+	});
+}
+
+/**
+**  Find the path of a harvester on the route between its mine and its depot.
+**
+**  @param unit     Harvester, of size 1x1.
+**  @param mine     Mine of the harvester.
+**  @param depot    Depot of the harvester.
+**  @param toDepot  Whether the harvester goes to the depot, else to the mine.
+**  @param path     Output: the path, in the same order as AStarFindPath.
+**  @param pathLen  Size of path.
+**
+**  @return         Length of the full path, or PF_FAILED if no route can be used.
+*/
+int HarvestRouteFindPath(const CUnit &unit, const CUnit &mine, const CUnit &depot, bool toDepot,
+                         char *path, int pathLen)
+{
+	if (!AStarHarvestRoutes) {
+		return PF_FAILED;
+	}
+	const int movementMask = unit.Type->MovementMask;
+
+	// Forget the routes not followed for a while.
+	HarvestRoutes.erase(std::remove_if(HarvestRoutes.begin(), HarvestRoutes.end(), [](const HarvestRoute &route) {
+		return route.LastUsed + HarvestRouteTimeout < GameCycle;
+	}), HarvestRoutes.end());
+
+	auto it = std::find_if(HarvestRoutes.begin(), HarvestRoutes.end(), [&](const HarvestRoute &route) {
+		return route.IsFor(mine, depot, movementMask);
+	});
+	HarvestRoute *route = it != HarvestRoutes.end() ? &*it : SearchHarvestRoute(unit, mine, depot, toDepot);
+	if (route == nullptr) {
+		return PF_FAILED;
+	}
+	route->LastUsed = GameCycle;
+
+	// The harvesters usually are at the end they start from.
+	const std::vector<Vec2i> &tiles = route->Tiles;
+	size_t index;
+	if (toDepot) {
+		index = std::find(tiles.begin(), tiles.end(), unit.tilePos) - tiles.begin();
+		if (index + 1 >= tiles.size()) {
+			// off the route, or at its end: let A* check the goal
+			return PF_FAILED;
+		}
+	} else {
+		index = tiles.rend() - std::find(tiles.rbegin(), tiles.rend(), unit.tilePos);
+		if (index <= 1) {
+			return PF_FAILED;
+		}
+		--index;
+	}
+	const int step = toDepot ? 1 : -1;
+	if (!UnitCanBeAt(unit, tiles[index + step])) {
+		// let A* go around the unit in the way
+		return PF_FAILED;
+	}
+	const int length = toDepot ? tiles.size() - 1 - index : index;
+	if (path) {
+		const int stored = std::min(length, pathLen);
+		for (int i = 0; i != stored; ++i) {
+			const Vec2i diff = tiles[index + (i + 1) * step] - tiles[index + i * step];
+			path[stored - i - 1] = XY2Heading[diff.x + 1][diff.y + 1];
+		}
+	}
+	return length;
+}
+
+//@}
@@ -0,0 +1,653 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name hierarchical.cpp - The hierarchical (HPA*) path finder routines. */
+//
+//      (c) Copyright 2026 by the Stratagus Team
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+// The map is cut into square clusters of HPAClusterSize tiles. Between two
+// adjacent clusters, each run of tiles passable on both sides of the border
+// (an entrance) gives one or two transitions. The tiles of these transitions
+// are the nodes of an abstract graph: nodes of the same cluster are linked
+// with their walking cost inside the cluster, and the two tiles of each
+// transition are linked together.
+//
+// A long path is first planned on this small graph, the resulting waypoints
+// are then reached one after the other with the usual AStarFindPath, so the
+// local search always stays well below AStarMaxSearchIterations.
+//
+// Only static obstacles (terrain, walls, buildings) are taken into account,
+// units are left to the local search. There is one graph per (static part
+// of) MovementMask, built when first needed. When the terrain changes, the
+// clusters around are only marked dirty and are rebuilt on the next query.
+
+//@{
+
+/*----------------------------------------------------------------------------
+--  Includes
+----------------------------------------------------------------------------*/
+
+#include "stratagus.h"
+
+#include "pathfinder.h"
+
+#include "map.h"
+#include "profiler.h"
+#include "tileset.h"
+
+#include <algorithm>
+#include <climits>
+#include <map>
+#include <memory>
+#include <queue>
+#include <unordered_map>
+
+/*----------------------------------------------------------------------------
+--  Declarations
+----------------------------------------------------------------------------*/
+
+/// Size (in tiles) of a cluster
+static constexpr int HPAClusterSize = 16;
+/// Entrances wider than this get a transition at each end instead of the middle one
+static constexpr int HPAMaxEntranceWidth = 6;
+/// Flags of moving things, they are ignored by the abstract graph
+static constexpr tile_flags HPAUnitFlags = MapFieldLandUnit | MapFieldAirUnit | MapFieldSeaUnit;
+
+namespace
+{
+
+/// Transition between two adjacent clusters
+struct HPATransition {
+	Vec2i From; /// Tile in the cluster owning the transition
+	Vec2i To;   /// Tile in the right/bottom neighbour cluster
+};
+
+/// A cluster of the abstract graph
+struct HPACluster {
+	std::vector<Vec2i> Portals;            /// Border tiles which are nodes of the abstract graph
+	std::vector<std::vector<Vec2i>> Links; /// For each portal, the tiles across the border
+	std::vector<int> Costs;                /// Costs[i * Portals.size() + j], -1 if unreachable
+	bool Dirty = true;                     /// Must be rebuilt before use
+
+	int FindPortal(const Vec2i &pos) const
+	{
+		for (size_t i = 0; i != Portals.size(); ++i) {
+			if (Portals[i] == pos) {
+				return i;
+			}
+		}
+		return -1;
+	}
+};
+
+/**
+**  Abstract graph for one movement mask.
+*/
+class CHierarchicalLayer
+{
+public:
+	CHierarchicalLayer(tile_flags mask, int width, int height);
+
+	void MarkDirty(const Vec2i &pos, const Vec2i &size);
+	bool FindPath(const Vec2i &startPos, const Vec2i &goalPos, std::vector<Vec2i> &waypoints);
+
+private:
+	int ClusterIndex(const Vec2i &pos) const
+	{
+		return (pos.y / HPAClusterSize) * ClustersX + pos.x / HPAClusterSize;
+	}
+	void GetClusterBounds(int index, Vec2i &topLeft, Vec2i &bottomRight) const;
+	bool IsPassable(const Vec2i &pos) const
+	{
+		return (Map.Field(pos)->Flags & Mask) == 0;
+	}
+	int StepCost(const Vec2i &pos) const
+	{
+		// same as in astar.cpp: 1 for walking plus the tile cost
+		return 1 + Map.Field(pos)->getCost();
+	}
+
+	void Update();
+	void BuildBorderTransitions(std::vector<HPATransition> &transitions, const Vec2i &side,
+	                            const Vec2i &across, const Vec2i &step, int length) const;
+	void BuildTransitions(int index);
+	void BuildCluster(int index);
+	void ClusterDistances(int index, const Vec2i &source, const std::vector<Vec2i> &targets,
+	                      std::vector<int> &costs) const;
+
+private:
+	tile_flags Mask;
+	int MapWidth;
+	int MapHeight;
+	int ClustersX;
+	int ClustersY;
+	bool HasDirty = true;
+	std::vector<HPACluster> Clusters;
+	/// Transitions from each cluster to its right and bottom side neighbours
+	std::vector<std::vector<HPATransition>> Transitions;
+};
+
+} // namespace
+
+/*----------------------------------------------------------------------------
+--  Variables
+----------------------------------------------------------------------------*/
+
+/// see pathfinder.h
+bool AStarHierarchical = false;
+int AStarHierarchicalMinDistance = 2 * HPAClusterSize;
+
+static int HPAMapWidth;
+static int HPAMapHeight;
+
+/// One abstract graph per static movement mask
+static std::map<tile_flags, std::unique_ptr<CHierarchicalLayer>> HPALayers;
+
+/*----------------------------------------------------------------------------
+--  Methods
+----------------------------------------------------------------------------*/
+
+CHierarchicalLayer::CHierarchicalLayer(tile_flags mask, int width, int height) :
+	Mask(mask), MapWidth(width), MapHeight(height)
+{
+	ClustersX = (width + HPAClusterSize - 1) / HPAClusterSize;
+	ClustersY = (height + HPAClusterSize - 1) / HPAClusterSize;
+	Clusters.resize(ClustersX * ClustersY);
+	Transitions.resize(ClustersX * ClustersY);
+}
+
+void CHierarchicalLayer::GetClusterBounds(int index, Vec2i &topLeft, Vec2i &bottomRight) const
+{
+	topLeft.x = (index % ClustersX) * HPAClusterSize;
+	topLeft.y = (index / ClustersX) * HPAClusterSize;
+	bottomRight.x = std::min(topLeft.x + HPAClusterSize, MapWidth) - 1;
+	bottomRight.y = std::min(topLeft.y + HPAClusterSize, MapHeight) - 1;
+}
+
+/**
+**  Mark the clusters covering an area as dirty.
+*/
+void CHierarchicalLayer::MarkDirty(const Vec2i &pos, const Vec2i &size)
+{
+	const int minX = std::max(0, (int)pos.x) / HPAClusterSize;
+	const int minY = std::max(0, (int)pos.y) / HPAClusterSize;
+	const int maxX = std::min(MapWidth - 1, pos.x + size.x - 1) / HPAClusterSize;
+	const int maxY = std::min(MapHeight - 1, pos.y + size.y - 1) / HPAClusterSize;
+
+	for (int y = minY; y <= maxY; ++y) {
+		for (int x = minX; x <= maxX; ++x) {
+			Clusters[y * ClustersX + x].Dirty = true;
+		}
+	}
+	HasDirty = true;
+}
+
+/**
+**  Find the transitions across one border.
+**
+**  Tiles along each side of the border are grouped in runs of passable
+**  tiles, all tiles of a run are connected along the border. Each pair of
+**  runs (one on each side) linked by a straight or diagonal move gives one
+**  entrance, with one transition in its middle, or one at each end if it
+**  is wide.
+**
+**  @param transitions  Where to add the transitions.
+**  @param side         First tile of the border in this cluster.
+**  @param across       First tile of the border in the neighbour cluster.
+**  @param step         Direction along the border.
+**  @param length       Length of the border.
+*/
+void CHierarchicalLayer::BuildBorderTransitions(std::vector<HPATransition> &transitions,
+                                                const Vec2i &side, const Vec2i &across,
+                                                const Vec2i &step, int length) const
+{
+	std::vector<int> sideRun(length, -1);
+	std::vector<int> acrossRun(length, -1);
+	int runCount = 0;
+	for (int k = 0; k != length; ++k) {
+		if (IsPassable(side + step * k)) {
+			sideRun[k] = (k > 0 && sideRun[k - 1] != -1) ? sideRun[k - 1] : runCount++;
+		}
+		if (IsPassable(across + step * k)) {
+			acrossRun[k] = (k > 0 && acrossRun[k - 1] != -1) ? acrossRun[k - 1] : runCount++;
+		}
+	}
+
+	// crossings grouped by entrance, in order of first appearance
+	std::vector<std::pair<std::pair<int, int>, std::vector<HPATransition>>> entrances;
+	for (int k = 0; k != length; ++k) {
+		if (sideRun[k] == -1) {
+			continue;
+		}
+		for (int l = std::max(0, k - 1); l <= std::min(length - 1, k + 1); ++l) {
+			if (acrossRun[l] == -1) {
+				continue;
+			}
+			const std::pair<int, int> key(sideRun[k], acrossRun[l]);
+			auto it = std::find_if(entrances.begin(), entrances.end(),
+			                       [&key](const auto &entrance) { return entrance.first == key; });
+			if (it == entrances.end()) {
+				entrances.emplace_back(key, std::vector<HPATransition>());
+				it = entrances.end() - 1;
+			}
+			it->second.push_back({side + step * k, across + step * l});
+		}
+	}
+	for (const auto &[key, crossings] : entrances) {
+		if (crossings.size() > HPAMaxEntranceWidth) {
+			transitions.push_back(crossings.front());
+			transitions.push_back(crossings.back());
+		} else {
+			transitions.push_back(crossings[crossings.size() / 2]);
+		}
+	}
+}
+
+/**
+**  Find the transitions from a cluster to its right, bottom,
+**  bottom right and bottom left neighbours.
+*/
+void CHierarchicalLayer::BuildTransitions(int index)
+{
+	std::vector<HPATransition> &transitions = Transitions[index];
+	transitions.clear();
+
+	const int x = index % ClustersX;
+	const int y = index / ClustersX;
+	Vec2i topLeft;
+	Vec2i bottomRight;
+	GetClusterBounds(index, topLeft, bottomRight);
+
+	if (x < ClustersX - 1) {
+		const Vec2i side(bottomRight.x, topLeft.y);
+		BuildBorderTransitions(transitions, side, side + Vec2i(1, 0), Vec2i(0, 1),
+		                       bottomRight.y - topLeft.y + 1);
+	}
+	if (y < ClustersY - 1) {
+		const Vec2i side(topLeft.x, bottomRight.y);
+		BuildBorderTransitions(transitions, side, side + Vec2i(0, 1), Vec2i(1, 0),
+		                       bottomRight.x - topLeft.x + 1);
+
+		// diagonal moves through the corners
+		if (x < ClustersX - 1) {
+			const Vec2i across = bottomRight + Vec2i(1, 1);
+			if (IsPassable(bottomRight) && IsPassable(across)) {
+				transitions.push_back({bottomRight, across});
+			}
+		}
+		if (x > 0) {
+			const Vec2i across = side + Vec2i(-1, 1);
+			if (IsPassable(side) && IsPassable(across)) {
+				transitions.push_back({side, across});
+			}
+		}
+	}
+}
+
+/**
+**  Walking costs inside a cluster from source to each target.
+**
+**  The source itself may be unpassable (a building as goal for example),
+**  it is then only left towards its passable neighbours.
+**
+**  @param costs  Output, -1 for unreachable targets.
+*/
+void CHierarchicalLayer::ClusterDistances(int index, const Vec2i &source,
+                                          const std::vector<Vec2i> &targets,
+                                          std::vector<int> &costs) const
+{
+	Vec2i topLeft;
+	Vec2i bottomRight;
+	GetClusterBounds(index, topLeft, bottomRight);
+	const int width = bottomRight.x - topLeft.x + 1;
+	const int height = bottomRight.y - topLeft.y + 1;
+
+	std::vector<int> dist(width * height, INT_MAX);
+	// (cost, local offset), ties are broken by offset to stay deterministic
+	using Entry = std::pair<int, int>;
+	std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+
+	const int sourceOffset = (source.y - topLeft.y) * width + source.x - topLeft.x;
+	dist[sourceOffset] = 0;
+	open.push(Entry(0, sourceOffset));
+	while (!open.empty()) {
+		const auto [cost, offset] = open.top();
+		open.pop();
+		if (cost != dist[offset]) {
+			continue;
+		}
+		const Vec2i pos(topLeft.x + offset % width, topLeft.y + offset / width);
+		for (int i = 0; i < 8; ++i) {
+			const Vec2i next(pos.x + Heading2X[i], pos.y + Heading2Y[i]);
+			if (next.x < topLeft.x || next.x > bottomRight.x
+				|| next.y < topLeft.y || next.y > bottomRight.y || !IsPassable(next)) {
+				continue;
+			}
+			const int nextOffset = (next.y - topLeft.y) * width + next.x - topLeft.x;
+			const int nextCost = cost + StepCost(next);
+			if (nextCost < dist[nextOffset]) {
+				dist[nextOffset] = nextCost;
+				open.push(Entry(nextCost, nextOffset));
+			}
+		}
+	}
+
+	costs.resize(targets.size());
+	for (size_t i = 0; i != targets.size(); ++i) {
+		const int d = dist[(targets[i].y - topLeft.y) * width + targets[i].x - topLeft.x];
+		costs[i] = d == INT_MAX ? -1 : d;
+	}
+}
+
+/**
+**  Collect the portals of a cluster from its four borders and compute
+**  the costs between them.
+*/
+void CHierarchicalLayer::BuildCluster(int index)
+{
+	HPACluster &cluster = Clusters[index];
+	cluster.Portals.clear();
+	cluster.Links.clear();
+
+	const auto addLink = [&cluster](const Vec2i &portal, const Vec2i &across) {
+		int i = cluster.FindPortal(portal);
+		if (i == -1) {
+			i = cluster.Portals.size();
+			cluster.Portals.push_back(portal);
+			cluster.Links.emplace_back();
+		}
+		cluster.Links[i].push_back(across);
+	};
+	const int x = index % ClustersX;
+	const int y = index / ClustersX;
+
+	// transitions owned by the left, top left, top and top right neighbours
+	for (int dy = -1; dy <= 0; ++dy) {
+		for (int dx = -1; dx <= 1; ++dx) {
+			if ((dy == 0 && dx >= 0) || y + dy < 0 || x + dx < 0 || x + dx >= ClustersX) {
+				continue;
+			}
+			for (const HPATransition &transition : Transitions[index + dy * ClustersX + dx]) {
+				if (ClusterIndex(transition.To) == index) {
+					addLink(transition.To, transition.From);
+				}
+			}
+		}
+	}
+	for (const HPATransition &transition : Transitions[index]) {
+		addLink(transition.From, transition.To);
+	}
+
+	const size_t n = cluster.Portals.size();
+	cluster.Costs.assign(n * n, -1);
+	std::vector<int> costs;
+	for (size_t i = 0; i != n; ++i) {
+		ClusterDistances(index, cluster.Portals[i], cluster.Portals, costs);
+		std::copy(costs.begin(), costs.end(), cluster.Costs.begin() + i * n);
+	}
+	cluster.Dirty = false;
+}
+
+/**
+**  Rebuild the dirty clusters.
+**
+**  The borders of a dirty cluster are recomputed, so its eight neighbours
+**  may get new portals and have to be rebuilt too.
+*/
+void CHierarchicalLayer::Update()
+{
+	if (!HasDirty) {
+		return;
+	}
+	const int count = ClustersX * ClustersY;
+	std::vector<bool> rebuildTransitions(count, false);
+	std::vector<bool> rebuild(count, false);
+
+	for (int i = 0; i != count; ++i) {
+		if (!Clusters[i].Dirty) {
+			continue;
+		}
+		const int x = i % ClustersX;
+		const int y = i / ClustersX;
+
+		for (int dy = -1; dy <= 1; ++dy) {
+			for (int dx = -1; dx <= 1; ++dx) {
+				if (x + dx < 0 || x + dx >= ClustersX || y + dy < 0 || y + dy >= ClustersY) {
+					continue;
+				}
+				const int neighbour = i + dy * ClustersX + dx;
+				// the transitions of the cluster and the ones pointing to it
+				if (dy < 0 || (dy == 0 && dx <= 0)) {
+					rebuildTransitions[neighbour] = true;
+				}
+				rebuild[neighbour] = true;
+			}
+		}
+	}
+	for (int i = 0; i != count; ++i) {
+		if (rebuildTransitions[i]) {
+			BuildTransitions(i);
+		}
+	}
+	for (int i = 0; i != count; ++i) {
+		if (rebuild[i]) {
+			BuildCluster(i);
+		}
+	}
+	HasDirty = false;
+}
+
+/**
+**  Plan a path on the abstract graph.
+**
+**  @param startPos   Start tile.
+**  @param goalPos    Goal tile (may be unpassable, like a building or a tree).
+**  @param waypoints  Output: the portals to go through, in order.
+**
+**  @return           false if there is no path on the abstract graph.
+*/
+bool CHierarchicalLayer::FindPath(const Vec2i &startPos, const Vec2i &goalPos, std::vector<Vec2i> &waypoints)
+{
+	Update();
+	waypoints.clear();
+
+	const int startCluster = ClusterIndex(startPos);
+	if (startCluster == ClusterIndex(goalPos)) {
+		return true;
+	}
+
+	// An unpassable goal is reached through any of its passable neighbours,
+	// which may be in other clusters.
+	std::vector<Vec2i> goalTiles;
+	if (IsPassable(goalPos)) {
+		goalTiles.push_back(goalPos);
+	} else {
+		for (int i = 0; i < 8; ++i) {
+			const Vec2i pos(goalPos.x + Heading2X[i], goalPos.y + Heading2Y[i]);
+			if (Map.Info.IsPointOnMap(pos) && IsPassable(pos)) {
+				goalTiles.push_back(pos);
+			}
+		}
+	}
+
+	// Temporary edges from the start and to the goal.
+	std::vector<Vec2i> startTargets = Clusters[startCluster].Portals;
+	for (const Vec2i &goalTile : goalTiles) {
+		if (ClusterIndex(goalTile) == startCluster) {
+			startTargets.push_back(goalTile);
+		}
+	}
+	std::vector<int> startCosts;
+	ClusterDistances(startCluster, startPos, startTargets, startCosts);
+	std::vector<std::vector<int>> goalCosts(goalTiles.size());
+	for (size_t i = 0; i != goalTiles.size(); ++i) {
+		const int goalCluster = ClusterIndex(goalTiles[i]);
+		ClusterDistances(goalCluster, goalTiles[i], Clusters[goalCluster].Portals, goalCosts[i]);
+	}
+
+	const unsigned int goalOffset = Map.getIndex(goalPos);
+	const auto heuristic = [&goalPos](const Vec2i &pos) {
+		return std::max(std::abs(pos.x - goalPos.x), std::abs(pos.y - goalPos.y));
+	};
+
+	struct NodeInfo {
+		int Cost;
+		unsigned int Parent;
+	};
+	std::unordered_map<unsigned int, NodeInfo> nodes;
+	// (estimated total cost, offset), ties are broken by offset to stay deterministic
+	using Entry = std::pair<int, unsigned int>;
+	std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+
+	const unsigned int startOffset = Map.getIndex(startPos);
+	const auto relax = [&](unsigned int from, const Vec2i &pos, int cost) {
+		const unsigned int offset = Map.getIndex(pos);
+		auto it = nodes.find(offset);
+		if (it != nodes.end() && it->second.Cost <= cost) {
+			return;
+		}
+		nodes[offset] = {cost, from};
+		open.push(Entry(cost + heuristic(pos), offset));
+	};
+
+	nodes[startOffset] = {0, startOffset};
+	const HPACluster &first = Clusters[startCluster];
+	for (size_t i = 0; i != startTargets.size(); ++i) {
+		if (startCosts[i] < 0) {
+			continue;
+		}
+		if (i < first.Portals.size()) {
+			relax(startOffset, first.Portals[i], startCosts[i]);
+		} else {
+			relax(startOffset, goalPos, startCosts[i]);
+		}
+	}
+	if (first.FindPortal(startPos) != -1) {
+		// also use the transitions of the start itself
+		open.push(Entry(heuristic(startPos), startOffset));
+	}
+
+	bool found = false;
+	while (!open.empty()) {
+		const auto [estimate, offset] = open.top();
+		open.pop();
+		const Vec2i pos(offset % HPAMapWidth, offset / HPAMapWidth);
+		const int cost = nodes[offset].Cost;
+		if (estimate != cost + heuristic(pos)) {
+			continue; // outdated entry
+		}
+		if (offset == goalOffset) {
+			found = true;
+			break;
+		}
+		const int clusterIndex = ClusterIndex(pos);
+		const HPACluster &cluster = Clusters[clusterIndex];
+		const int i = cluster.FindPortal(pos);
+		Assert(i != -1);
+		const size_t n = cluster.Portals.size();
+
+		for (size_t j = 0; j != n; ++j) {
+			const int edge = cluster.Costs[i * n + j];
+			if (edge > 0) {
+				relax(offset, cluster.Portals[j], cost + edge);
+			}
+		}
+		for (const Vec2i &across : cluster.Links[i]) {
+			relax(offset, across, cost + StepCost(across));
+		}
+		for (size_t k = 0; k != goalTiles.size(); ++k) {
+			if (ClusterIndex(goalTiles[k]) == clusterIndex && goalCosts[k][i] >= 0) {
+				relax(offset, goalPos, cost + goalCosts[k][i]);
+			}
+		}
+	}
+	if (!found) {
+		return false;
+	}
+	for (unsigned int offset = nodes[goalOffset].Parent; offset != startOffset; offset = nodes[offset].Parent) {
+		waypoints.emplace_back(offset % HPAMapWidth, offset / HPAMapWidth);
+	}
+	std::reverse(waypoints.begin(), waypoints.end());
+	return true;
+}
+
+/*----------------------------------------------------------------------------
+--  Functions
+----------------------------------------------------------------------------*/
+
+/**
+**  Init the hierarchical pathfinder.
+*/
+void InitHierarchicalPathfinder(int mapWidth, int mapHeight)
+{
+	HPAMapWidth = mapWidth;
+	HPAMapHeight = mapHeight;
+	HPALayers.clear();
+}
+
+/**
+**  Free the hierarchical pathfinder.
+*/
+void FreeHierarchicalPathfinder()
+{
+	HPALayers.clear();
+}
+
+/**
+**  The static obstacles of an area have changed (tree cut, wall destroyed,
+**  building placed...), mark the clusters around as dirty.
+*/
+void HierarchicalPathfinderAreaChanged(const Vec2i &pos, const Vec2i &size)
+{
+	for (auto &[mask, layer] : HPALayers) {
+		layer->MarkDirty(pos, size);
+	}
+}
+
+/**
+**  Plan a long path on the abstract graph.
+**
+**  @param startPos       Start tile.
+**  @param goalPos        Goal tile.
+**  @param movementMask   MovementMask of the unit type (only 1x1 units are supported).
+**  @param waypoints      Output: the tiles to go through before the goal.
+**
+**  @return               false if the goal is unreachable by static obstacles.
+*/
+bool HierarchicalFindPath(const Vec2i &startPos, const Vec2i &goalPos, int movementMask,
+                          std::vector<Vec2i> &waypoints)
+{
+	PROFILE_ZONE("HierarchicalFindPath");
+	Assert(HPAMapWidth == Map.Info.MapWidth && HPAMapHeight == Map.Info.MapHeight);
+
+	const tile_flags mask = tile_flags(movementMask) & ~HPAUnitFlags;
+	auto &layer = HPALayers[mask];
+	if (!layer) {
+		layer = std::make_unique<CHierarchicalLayer>(mask, HPAMapWidth, HPAMapHeight);
+	}
+	return layer->FindPath(startPos, goalPos, waypoints);
+}
+
+//@}
@@ -41,9 +41,12 @@
 
 #include "actions.h"
 #include "map.h"
+#include "player.h"
 #include "unittype.h"
 #include "unit.h"
 
+#include <algorithm>
+
 //astar.cpp
 
 /// Init the a* data structures
@@ -61,32 +64,115 @@ extern int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, in
 --  Variables
 ----------------------------------------------------------------------------*/
 
+/// Set between InitPathfinder and FreePathfinder
+static bool PathfinderInitialized = false;
+
+/**
+**  Values and queue of a traversal.
+**
+**  They are kept when the traversal is destroyed and reused by the next
+**  one, so a small search neither allocates nor clears the whole map:
+**  each value is stamped with the generation of the traversal which set
+**  it, and the values of the older generations read as not visited.
+*/
+struct TerrainTraversal::Storage {
+	std::vector<uint32_t> values; /// generation << 16 | value, by extended tile index
+	uint32_t generation = 0;      /// generation of the current traversal, << 16
+
+	std::vector<PosNode> queue;   /// ring buffer of the nodes to visit, power of 2 size
+	size_t queueHead = 0;         /// index of the first node
+	size_t queueSize = 0;         /// number of nodes
+};
+
+thread_local std::vector<std::unique_ptr<TerrainTraversal::Storage>> TerrainTraversal::s_storagePool;
+
+TerrainTraversal::TerrainTraversal() = default;
+
+TerrainTraversal::~TerrainTraversal()
+{
+	if (m_storage) {
+		s_storagePool.push_back(std::move(m_storage));
+	}
+}
+
 void TerrainTraversal::SetSize(unsigned int width, unsigned int height)
 {
-	m_values.resize((width + 2) * (height + 2));
+	if (!m_storage) {
+		if (s_storagePool.empty()) {
+			m_storage = std::make_unique<Storage>();
+		} else {
+			m_storage = std::move(s_storagePool.back());
+			s_storagePool.pop_back();
+		}
+	}
+	const size_t size = (width + 2) * (height + 2);
+	if (m_storage->values.size() != size) {
+		m_storage->values.assign(size, 0);
+		m_storage->generation = 0;
+	}
 	m_extented_width = width + 2;
 	m_height = height;
 }
 
 void TerrainTraversal::Init()
 {
+	Storage &storage = *m_storage;
 	const unsigned int height = m_height;
-	const unsigned int width = m_extented_width - 2;
 	const unsigned int width_ext = m_extented_width;
 
-	memset(&m_values[0], '\xFF', width_ext * sizeof(dataType));
+	storage.generation += 1 << 16;
+	if (storage.generation == 0) {
+		// Wrapped around, the oldest values would look visited
+		std::fill(storage.values.begin(), storage.values.end(), 0);
+		storage.generation = 1 << 16;
+	}
+	// Only stamp the border, the other tiles are from an older generation
+	const uint32_t border = storage.generation | 0xFFFF;
+	std::fill_n(storage.values.begin(), width_ext, border);
 	for (unsigned i = 1; i < 1 + height; ++i) {
-		m_values[i * width_ext] = -1;
-		memset(&m_values[i * width_ext + 1], '\0', width * sizeof(dataType));
-		m_values[i * width_ext + width + 1] = -1;
+		storage.values[i * width_ext] = border;
+		storage.values[i * width_ext + width_ext - 1] = border;
 	}
-	memset(&m_values[(height + 1) * width_ext], '\xFF', width_ext * sizeof(dataType));
+	std::fill_n(storage.values.begin() + (height + 1) * width_ext, width_ext, border);
+
+	storage.queueHead = 0;
+	storage.queueSize = 0;
+}
+
+void TerrainTraversal::PushNode(const Vec2i &pos, const Vec2i &from)
+{
+	Storage &storage = *m_storage;
+
+	if (storage.queueSize == storage.queue.size()) {
+		// Full, move the nodes at the start of a twice bigger ring
+		std::vector<PosNode> queue(std::max<size_t>(256, 2 * storage.queue.size()));
+		for (size_t i = 0; i != storage.queueSize; ++i) {
+			queue[i] = storage.queue[(storage.queueHead + i) & (storage.queue.size() - 1)];
+		}
+		storage.queue.swap(queue);
+		storage.queueHead = 0;
+	}
+	storage.queue[(storage.queueHead + storage.queueSize) & (storage.queue.size() - 1)] = PosNode(pos, from);
+	++storage.queueSize;
+}
+
+bool TerrainTraversal::PopNode(PosNode &node)
+{
+	Storage &storage = *m_storage;
+
+	if (storage.queueSize == 0) {
+		return false;
+	}
+	node = storage.queue[storage.queueHead];
+	storage.queueHead = (storage.queueHead + 1) & (storage.queue.size() - 1);
+	--storage.queueSize;
+	return true;
 }
 
 void TerrainTraversal::PushPos(const Vec2i &pos)
 {
 	if (IsVisited(pos) == false) {
-		m_queue.push(PosNode(pos, pos));
+		PushNode(pos, pos);
 		Set(pos, 1);
 	}
 }
@@ -101,7 +187,7 @@ void TerrainTraversal::PushNeighboor(const Vec2i &pos)
 		const Vec2i newPos = pos + offsets[i];
 
 		if (IsVisited(newPos) == false) {
-			m_queue.push(PosNode(newPos, pos));
+			PushNode(newPos, pos);
 			Set(newPos, Get(pos) + 1);
 		}
 	}
@@ -139,12 +225,18 @@ bool TerrainTraversal::IsInvalid(const Vec2i &pos) const
 
 TerrainTraversal::dataType TerrainTraversal::Get(const Vec2i &pos) const
 {
-	return m_values[m_extented_width + 1 + pos.y * m_extented_width + pos.x];
+	const uint32_t value = m_storage->values[m_extented_width + 1 + pos.y * m_extented_width + pos.x];
+
+	if ((value & 0xFFFF0000) != m_storage->generation) {
+		return 0;
+	}
+	return static_cast<dataType>(static_cast<uint16_t>(value));
 }
 
 void TerrainTraversal::Set(const Vec2i &pos, TerrainTraversal::dataType value)
 {
-	m_values[m_extented_width + 1 + pos.y * m_extented_width + pos.x] = value;
+	m_storage->values[m_extented_width + 1 + pos.y * m_extented_width + pos.x] =
+		m_storage->generation | static_cast<uint16_t>(value);
 }
 
 /*----------------------------------------------------------------------------
@@ -157,6 +249,11 @@ void TerrainTraversal::Set(const Vec2i &pos, TerrainTraversal::dataType value)
 void InitPathfinder()
 {
 	InitAStar(Map.Info.MapWidth, Map.Info.MapHeight);
+	InitHierarchicalPathfinder(Map.Info.MapWidth, Map.Info.MapHeight);
+	InitFlowFields(Map.Info.MapWidth, Map.Info.MapHeight);
+	InitDistanceFields(Map.Info.MapWidth, Map.Info.MapHeight);
+	InitReachability(Map.Info.MapWidth, Map.Info.MapHeight);
+	PathfinderInitialized = true;
 }
 
 /**
@@ -164,13 +261,75 @@ void InitPathfinder()
 */
 void FreePathfinder()
 {
+	PathfinderInitialized = false;
+	FreeHarvestRoutes();
+	FreeDistanceFields();
+	FreeReachability();
+	FreeFlowFields();
+	FreeHierarchicalPathfinder();
 	FreeAStar();
 }
 
+/**
+**  Static obstacles of an area have changed.
+**
+**  Called when wood or rock is removed or regrown, walls are built or
+**  destroyed and buildings are placed or removed.
+**
+**  @param pos   Top left tile of the area.
+**  @param size  Size of the area.
+*/
+void PathfinderTerrainChanged(const Vec2i &pos, const Vec2i &size)
+{
+	if (!PathfinderInitialized) {
+		return;
+	}
+	HierarchicalPathfinderAreaChanged(pos, size);
+	FlowFieldsTerrainChanged();
+	HarvestRoutesTerrainChanged(pos, size);
+	DistanceFieldsTerrainChanged(pos, size);
+	ReachabilityAreaChanged(pos, size);
+}
+
 /*----------------------------------------------------------------------------
 --  PATH-FINDER USE
 ----------------------------------------------------------------------------*/
 
+/**
+**  Check if the pathfinders working on the real terrain may be used for a
+**  unit: its player knows all the terrain, or is an AI.
+*/
+static bool KnowsAllTerrain(const CUnit &unit)
+{
+	return AStarKnowUnseenTerrain || unit.Player->AiEnabled;
+}
+
+/**
+**  Check with the connected components if the goal is out of reach,
+**  before running a whole A* for nothing.
+**
+**  Unexplored terrain is seen as passable by A*, so only the units which
+**  know all the terrain (or belong to an AI) can use it.
+**
+**  @return  true if the goal surely can't be reached.
+*/
+static bool IsStaticallyUnreachable(const CUnit &src, const Vec2i &goalPos, int w, int h, int range)
+{
+	// Only the tiles close to the goal are checked.
+	constexpr int maxCheckedRange = 16;
+
+	if (src.Type->TileWidth != 1 || src.Type->TileHeight != 1 || range > maxCheckedRange) {
+		return false;
+	}
+	if (!KnowsAllTerrain(src)) {
+		return false;
+	}
+	const int margin = std::max(range, 1);
+	const Vec2i topLeft = goalPos - Vec2i(margin, margin);
+	const Vec2i bottomRight = goalPos + Vec2i(std::max(w, 1) - 1 + margin, std::max(h, 1) - 1 + margin);
+	return !ReachabilityMayReach(src.tilePos, topLeft, bottomRight, src.Type->MovementMask);
+}
+
 /**
 **  Can the unit 'src' reach the place goalPos.
 **
@@ -185,6 +344,10 @@ void FreePathfinder()
 */
 int PlaceReachable(const CUnit &src, const Vec2i &goalPos, int w, int h, int minrange, int range, bool from_outside_container)
 {
+	if ((!from_outside_container || !src.Container)
+		&& IsStaticallyUnreachable(src, goalPos, w, h, range)) {
+		return 0;
+	}
 	SetAStarFixedEnemyUnitsUnpassable(true); /// change Path Finder setting to don't count tiles with enemy units as passable
 	int i;
 	Vec2i srcTilePos = src.tilePos;
@@ -351,6 +514,17 @@ void PathFinderInput::SetGoal(const Vec2i &pos, const Vec2i &size)
 	}
 	goalPos = newPos;
 	goalSize = size;
+	harvestMine = nullptr;
+	harvestDepot = nullptr;
+}
+
+/**
+**  Set the mine and the depot of a harvest trip, after SetGoal.
+*/
+void PathFinderInput::SetHarvestRoute(const CUnit *mine, const CUnit *depot)
+{
+	harvestMine = mine;
+	harvestDepot = depot;
 }
 
 void PathFinderInput::SetMinRange(int range)
@@ -383,6 +557,127 @@ PathFinderOutput::PathFinderOutput()
 	memset(this, 0, sizeof(*this));
 }
 
+/**
+**  Check if a request is far enough to go through the hierarchical graph.
+**
+**  The graph is built on the real terrain, units which don't know it all
+**  use the plain A* so they aren't led through passages they never saw.
+*/
+static bool IsHierarchicalRequest(const PathFinderInput &input)
+{
+	if (!AStarHierarchical || input.GetUnitSize() != Vec2i(1, 1) || !KnowsAllTerrain(*input.GetUnit())) {
+		return false;
+	}
+	const Vec2i diff = input.GetGoalPos() - input.GetUnitPos();
+	return std::max(std::abs(diff.x), std::abs(diff.y)) >= AStarHierarchicalMinDistance;
+}
+
+/**
+**  Check if a request may be solved with a flow field.
+*/
+static bool IsFlowFieldRequest(const PathFinderInput &input)
+{
+	const Vec2i &goalSize = input.GetGoalSize();
+
+	return AStarFlowField && input.GetUnitSize() == Vec2i(1, 1) && KnowsAllTerrain(*input.GetUnit())
+		   && goalSize.x <= 1 && goalSize.y <= 1 && input.GetMinRange() == 0 && input.GetMaxRange() == 0;
+}
+
+/**
+**  Check if a request is a harvest trip between a mine and a depot.
+*/
+static bool IsHarvestRouteRequest(const PathFinderInput &input)
+{
+	return AStarHarvestRoutes && input.GetHarvestMine() && input.GetHarvestDepot()
+		   && input.GetUnitSize() == Vec2i(1, 1) && input.GetMinRange() == 0 && input.GetMaxRange() == 1;
+}
+
+/**
+**  Find a path on the route shared by the harvesters of a mine and a depot.
+**
+**  @return  The path length, or PF_FAILED to use another pathfinder.
+*/
+static int HarvestRouteNewPath(const PathFinderInput &input, char *path)
+{
+	if (!IsHarvestRouteRequest(input)) {
+		return PF_FAILED;
+	}
+	const CUnit &depot = *input.GetHarvestDepot();
+	return HarvestRouteFindPath(*input.GetUnit(), *input.GetHarvestMine(), depot,
+								input.GetGoalPos() == depot.tilePos,
+								path, PathFinderOutput::MAX_PATH_LENGTH);
+}
+
+/**
+**  Find a path towards the next waypoint of the hierarchical graph.
+**
+**  Only used for 1x1 units far away from their goal, the local A* then
+**  only has to reach a waypoint near the unit. When the unit reaches the
+**  end of this path, NewPath is called again and goes on to the next one.
+**
+**  @return  Path length to the waypoint, or PF_FAILED to use a plain A*.
+*/
+static int HierarchicalNewPath(const PathFinderInput &input, char *path)
+{
+	const CUnit &unit = *input.GetUnit();
+	const Vec2i &startPos = input.GetUnitPos();
+	const Vec2i &goalPos = input.GetGoalPos();
+
+	if (!IsHierarchicalRequest(input)) {
+		return PF_FAILED;
+	}
+	std::vector<Vec2i> waypoints;
+	if (!HierarchicalFindPath(startPos, goalPos, unit.Type->MovementMask, waypoints)
+		|| waypoints.empty()) {
+		// let the plain A* handle it, it knows what to do with unexplored terrain
+		return PF_FAILED;
+	}
+	// Aim at the farthest waypoint still close enough to be found quickly.
+	size_t target = 0;
+	for (size_t i = 0; i != waypoints.size(); ++i) {
+		const Vec2i d = waypoints[i] - startPos;
+		if (std::max(std::abs(d.x), std::abs(d.y)) > AStarHierarchicalMinDistance) {
+			break;
+		}
+		target = i;
+	}
+	for (; target != waypoints.size(); ++target) {
+		const int length = AStarFindPath(startPos, waypoints[target], 0, 0, 1, 1, 0, 0,
+										 path, PathFinderOutput::MAX_PATH_LENGTH, unit);
+		if (length > 0) {
+			return length;
+		}
+		if (length != PF_REACHED) {
+			break;
+		}
+	}
+	return PF_FAILED;
+}
+
+/**
+**  Find a path on the flow field shared by all the units moving to the same tile.
+**
+**  @return  The path length, or PF_FAILED to use another pathfinder.
+*/
+static int FlowFieldNewPath(const PathFinderInput &input, char *path)
+{
+	const CUnit &unit = *input.GetUnit();
+
+	if (!IsFlowFieldRequest(input)) {
+		return PF_FAILED;
+	}
+	const int length = FlowFieldFindPath(input.GetUnitPos(), input.GetGoalPos(),
+										 unit.Type->MovementMask, path, PathFinderOutput::MAX_PATH_LENGTH);
+	if (length > 0 && path != nullptr) {
+		// The field ignores the units, let A* go around the one blocking the way.
+		const int first = path[std::min<int>(length, PathFinderOutput::MAX_PATH_LENGTH) - 1];
+		if (!UnitCanBeAt(unit, input.GetUnitPos() + Vec2i(Heading2X[first], Heading2Y[first]))) {
+			return PF_FAILED;
+		}
+	}
+	return length;
+}
+
 /**
 **  Find new path.
 **
@@ -399,13 +694,33 @@ PathFinderOutput::PathFinderOutput()
 static int NewPath(PathFinderInput &input, PathFinderOutput &output)
 {
 	char *path = output.Path;
-	int i = AStarFindPath(input.GetUnitPos(),
+	int i = HarvestRouteNewPath(input, path);
+	if (i == PF_FAILED) {
+		i = FlowFieldNewPath(input, path);
+	}
+	if (i == PF_FAILED) {
+		i = HierarchicalNewPath(input, path);
+	}
+	PathFinderPrefetch &prefetch = input.GetUnit()->pathFinderData->prefetch;
+	if (i == PF_FAILED && prefetch.Valid && prefetch.Cycle == GameCycle
+		&& prefetch.StartPos == input.GetUnitPos()
+		&& prefetch.GoalPos == input.GetGoalPos() && prefetch.GoalSize == input.GetGoalSize()
+		&& prefetch.MinRange == input.GetMinRange() && prefetch.MaxRange == input.GetMaxRange()) {
+		i = prefetch.Result;
+		if (path != nullptr) {
+			std::copy_n(prefetch.Path, PathFinderOutput::MAX_PATH_LENGTH, path);
+		}
+	}
+	prefetch.Valid = false;
+	if (i == PF_FAILED) {
+		i = AStarFindPath(input.GetUnitPos(),
 						  input.GetGoalPos(),
 						  input.GetGoalSize().x, input.GetGoalSize().y,
 						  input.GetUnitSize().x, input.GetUnitSize().y,
 						  input.GetMinRange(), input.GetMaxRange(),
 						  path, PathFinderOutput::MAX_PATH_LENGTH,
 						  *input.GetUnit());
+	}
 	input.PathRecalculated();
 	if (i == PF_FAILED) {
 		i = PF_UNREACHABLE;
@@ -428,6 +743,94 @@ static int NewPath(PathFinderInput &input, PathFinderOutput &output)
 	return i;
 }
 
+/**
+**  Search ahead, on several threads, the paths the units will ask for in
+**  this cycle.
+**
+**  Only the requests known before the unit actions are gathered: units
+**  which reached the end of the part of their path kept in PathFinderOutput,
+**  and moving units whose goal has changed. The searches see the map as it
+**  is at the start of the cycle, which doesn't depend on the number of
+**  threads. NewPath only uses a result if the request is still the same.
+**
+**  @param units  All the units, in the order of UnitActionsEachCycle.
+*/
+void PathfinderPrefetchPaths(const std::vector<CUnit *> &units)
+{
+	if (!AStarBatch || !PathfinderInitialized) {
+		return;
+	}
+	std::vector<AStarRequest> requests;
+	std::vector<CUnit *> requestUnits;
+	// goals of this batch which will be read from a flow field
+	std::vector<std::pair<Vec2i, int>> flowFieldGoals;
+
+	for (CUnit *unit : units) {
+		if (unit->Destroyed || unit->Removed || unit->Moving || unit->Wait
+			|| unit->Orders.empty() || !unit->CanMove()) {
+			continue;
+		}
+		PathFinderInput &input = unit->pathFinderData->input;
+		const PathFinderOutput &output = unit->pathFinderData->output;
+
+		if (unit->CurrentAction() == UnitAction::Move) {
+			unit->CurrentOrder()->UpdatePathFinderData(input);
+			if (output.Length > 0 && !input.IsRecalculateNeeded()) {
+				continue;
+			}
+		} else if (output.Length != 0 || output.OverflowLength == 0
+				   || input.GetUnit() != unit || input.IsRecalculateNeeded()) {
+			// the order may change its goal, don't guess it
+			continue;
+		}
+		if (IsHierarchicalRequest(input)) {
+			continue;
+		}
+		if (IsHarvestRouteRequest(input)
+			&& HarvestRouteHasRoute(*input.GetHarvestMine(), *input.GetHarvestDepot(),
+									unit->Type->MovementMask)) {
+			continue;
+		}
+		if (IsFlowFieldRequest(input)) {
+			// Only the first unit moving to the goal uses A*.
+			const std::pair<Vec2i, int> key(input.GetGoalPos(), unit->Type->MovementMask);
+			if (FlowFieldHasGoal(key.first, key.second)
+				|| std::find(flowFieldGoals.begin(), flowFieldGoals.end(), key) != flowFieldGoals.end()) {
+				continue;
+			}
+			flowFieldGoals.push_back(key);
+		}
+		AStarRequest &request = requests.emplace_back();
+		request.Unit = unit;
+		request.StartPos = input.GetUnitPos();
+		request.UnitSize = input.GetUnitSize();
+		request.GoalPos = input.GetGoalPos();
+		request.GoalSize = input.GetGoalSize();
+		request.MinRange = input.GetMinRange();
+		request.MaxRange = input.GetMaxRange();
+		requestUnits.push_back(unit);
+	}
+	if (requests.empty()) {
+		return;
+	}
+	AStarFindPathBatch(requests);
+
+	for (size_t i = 0; i != requests.size(); ++i) {
+		const AStarRequest &request = requests[i];
+		PathFinderPrefetch &prefetch = requestUnits[i]->pathFinderData->prefetch;
+
+		prefetch.Valid = true;
+		prefetch.Cycle = GameCycle;
+		prefetch.StartPos = request.StartPos;
+		prefetch.GoalPos = request.GoalPos;
+		prefetch.GoalSize = request.GoalSize;
+		prefetch.MinRange = request.MinRange;
+		prefetch.MaxRange = request.MaxRange;
+		prefetch.Result = request.Result;
+		std::copy_n(request.Path, PathFinderOutput::MAX_PATH_LENGTH, prefetch.Path);
+	}
+}
+
 /**
 **  Returns the next element of a path.
 **
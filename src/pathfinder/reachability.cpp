@@ -0,0 +1,360 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name reachability.cpp - Connected components of the map. */
+//
+//      (c) Copyright 2026 by the Stratagus Team
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+//@{
+
+/*
+**  Each movement mask gets a labelling of the passable tiles by connected
+**  component (8-connected, as A* moves). Two tiles with different
+**  components can't be linked by any path, so no search is needed.
+**
+**  Tiles becoming passable (tree cut, wall destroyed...) merge the
+**  components around them with an union-find, which is cheap. Tiles
+**  becoming unpassable (building placed, wall raised...) only split a
+**  component if the tiles around them are no longer linked together
+**  nearby. Then the labels stay valid (only less precise) until the whole
+**  map is labelled again on the next query.
+*/
+
+/*----------------------------------------------------------------------------
+--  Includes
+----------------------------------------------------------------------------*/
+
+#include "stratagus.h"
+
+#include "pathfinder.h"
+
+#include "map.h"
+#include "tileset.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+
+/*----------------------------------------------------------------------------
+--  Declarations
+----------------------------------------------------------------------------*/
+
+/// Flags of moving things, they are ignored by the components
+static constexpr tile_flags ReachabilityUnitFlags = MapFieldLandUnit | MapFieldAirUnit | MapFieldSeaUnit;
+/// Distance around a blocked area searched for a way around it
+static constexpr int ReachabilityBypassMargin = 3;
+
+namespace
+{
+
+/**
+**  Connected components for one movement mask.
+*/
+class CReachabilityLayer
+{
+public:
+	CReachabilityLayer(tile_flags mask, int width, int height) :
+		Mask(mask), Width(width), Height(height), Labels(width * height, 0)
+	{}
+
+	void AreaChanged(const Vec2i &pos, const Vec2i &size);
+	int GetComponent(const Vec2i &pos);
+
+private:
+	bool IsPassable(const Vec2i &pos) const { return (Map.Field(pos)->Flags & Mask) == 0; }
+	int Find(int label);
+	int NewLabel();
+	void Relabel();
+	bool IsBypassable(const Vec2i &pos, const Vec2i &size, const std::vector<Vec2i> &blocked) const;
+
+private:
+	tile_flags Mask;          /// Static obstacles
+	int Width;                /// Map width
+	int Height;               /// Map height
+	std::vector<int> Labels;  /// Label of each tile, 0 if unpassable
+	std::vector<int> Parents; /// Union-find of the labels, Parents[0] is unused
+	bool NeedRelabel = true;  /// Labels must be computed again before use
+};
+
+} // namespace
+
+/*----------------------------------------------------------------------------
+--  Variables
+----------------------------------------------------------------------------*/
+
+static int ReachabilityMapWidth;
+static int ReachabilityMapHeight;
+/// One layer by movement mask (without the unit flags), built on demand
+static std::map<tile_flags, std::unique_ptr<CReachabilityLayer>> ReachabilityLayers;
+
+/*----------------------------------------------------------------------------
+--  Reachability layer
+----------------------------------------------------------------------------*/
+
+int CReachabilityLayer::Find(int label)
+{
+	while (Parents[label] != label) {
+		Parents[label] = Parents[Parents[label]];
+		label = Parents[label];
+	}
+	return label;
+}
+
+int CReachabilityLayer::NewLabel()
+{
+	Parents.push_back(Parents.size());
+	return Parents.size() - 1;
+}
+
+/**
+**  Flood fill all the passable tiles.
+*/
+void CReachabilityLayer::Relabel()
+{
+	std::fill(Labels.begin(), Labels.end(), 0);
+	Parents.assign(1, 0);
+
+	std::vector<unsigned int> stack;
+	for (unsigned int offset = 0; offset != Labels.size(); ++offset) {
+		if (Labels[offset] != 0 || !IsPassable(Vec2i(offset % Width, offset / Width))) {
+			continue;
+		}
+		const int label = NewLabel();
+		Labels[offset] = label;
+		stack.push_back(offset);
+		while (!stack.empty()) {
+			const Vec2i pos(stack.back() % Width, stack.back() / Width);
+			stack.pop_back();
+			for (int i = 0; i < 8; ++i) {
+				const Vec2i next(pos.x + Heading2X[i], pos.y + Heading2Y[i]);
+				if (!Map.Info.IsPointOnMap(next)) {
+					continue;
+				}
+				const unsigned int nextOffset = Map.getIndex(next);
+				if (Labels[nextOffset] == 0 && IsPassable(next)) {
+					Labels[nextOffset] = label;
+					stack.push_back(nextOffset);
+				}
+			}
+		}
+	}
+	NeedRelabel = false;
+}
+
+/**
+**  Check if the passable tiles next to newly blocked tiles are still
+**  linked together, only looking at the tiles close to the area.
+**
+**  If so, any path which went through the blocked tiles can go around
+**  them, so no component was split.
+**
+**  @param pos      Top left tile of the changed area.
+**  @param size     Size of the changed area.
+**  @param blocked  Tiles of the area which became unpassable.
+*/
+bool CReachabilityLayer::IsBypassable(const Vec2i &pos, const Vec2i &size,
+                                      const std::vector<Vec2i> &blocked) const
+{
+	const Vec2i minPos(std::max(0, pos.x - ReachabilityBypassMargin),
+	                   std::max(0, pos.y - ReachabilityBypassMargin));
+	const Vec2i maxPos(std::min(Width - 1, pos.x + size.x - 1 + ReachabilityBypassMargin),
+	                   std::min(Height - 1, pos.y + size.y - 1 + ReachabilityBypassMargin));
+	const int windowWidth = maxPos.x - minPos.x + 1;
+	const auto windowIndex = [&](const Vec2i &tilePos) {
+		return (tilePos.y - minPos.y) * windowWidth + tilePos.x - minPos.x;
+	};
+	const auto isInWindow = [&](const Vec2i &tilePos) {
+		return minPos.x <= tilePos.x && tilePos.x <= maxPos.x && minPos.y <= tilePos.y && tilePos.y <= maxPos.y;
+	};
+	// 1 for the passable tiles next to a blocked one, 2 once reached
+	std::vector<char> marks(windowWidth * (maxPos.y - minPos.y + 1), 0);
+	std::vector<Vec2i> stack;
+	int remaining = 0;
+
+	for (const Vec2i &tilePos : blocked) {
+		for (int i = 0; i < 8; ++i) {
+			const Vec2i next(tilePos.x + Heading2X[i], tilePos.y + Heading2Y[i]);
+			if (isInWindow(next) && marks[windowIndex(next)] == 0 && IsPassable(next)) {
+				marks[windowIndex(next)] = 1;
+				++remaining;
+				if (stack.empty()) {
+					stack.push_back(next);
+				}
+			}
+		}
+	}
+	if (stack.empty()) {
+		return true;
+	}
+	marks[windowIndex(stack.back())] = 2;
+	--remaining;
+	while (!stack.empty() && remaining != 0) {
+		const Vec2i tilePos = stack.back();
+		stack.pop_back();
+		for (int i = 0; i < 8; ++i) {
+			const Vec2i next(tilePos.x + Heading2X[i], tilePos.y + Heading2Y[i]);
+			if (isInWindow(next) && marks[windowIndex(next)] != 2 && IsPassable(next)) {
+				if (marks[windowIndex(next)] == 1) {
+					--remaining;
+				}
+				marks[windowIndex(next)] = 2;
+				stack.push_back(next);
+			}
+		}
+	}
+	return remaining == 0;
+}
+
+/**
+**  Update the labels of an area whose static obstacles have changed.
+*/
+void CReachabilityLayer::AreaChanged(const Vec2i &pos, const Vec2i &size)
+{
+	if (NeedRelabel) {
+		return;
+	}
+	const Vec2i minPos(std::max<int>(0, pos.x), std::max<int>(0, pos.y));
+	const Vec2i endPos(std::min<int>(Width, pos.x + size.x), std::min<int>(Height, pos.y + size.y));
+	std::vector<Vec2i> blocked;
+
+	// Remove the blocked tiles first, so the new tiles don't join through them.
+	for (int y = minPos.y; y < endPos.y; ++y) {
+		for (int x = minPos.x; x < endPos.x; ++x) {
+			const Vec2i tilePos(x, y);
+			int &label = Labels[Map.getIndex(tilePos)];
+
+			if (label != 0 && !IsPassable(tilePos)) {
+				label = 0;
+				blocked.push_back(tilePos);
+			}
+		}
+	}
+	for (int y = minPos.y; y < endPos.y; ++y) {
+		for (int x = minPos.x; x < endPos.x; ++x) {
+			const Vec2i tilePos(x, y);
+			int &label = Labels[Map.getIndex(tilePos)];
+
+			if (label == 0 && IsPassable(tilePos)) {
+				// join all the components around
+				label = NewLabel();
+				for (int i = 0; i < 8; ++i) {
+					const Vec2i next(x + Heading2X[i], y + Heading2Y[i]);
+					if (!Map.Info.IsPointOnMap(next)) {
+						continue;
+					}
+					const int nextLabel = Labels[Map.getIndex(next)];
+					if (nextLabel != 0) {
+						Parents[Find(nextLabel)] = Find(label);
+					}
+				}
+			}
+		}
+	}
+	if (!blocked.empty() && !IsBypassable(pos, size, blocked)) {
+		// the component may be split now
+		NeedRelabel = true;
+	}
+}
+
+/**
+**  Get the component of a tile, 0 if the tile is unpassable.
+*/
+int CReachabilityLayer::GetComponent(const Vec2i &pos)
+{
+	if (NeedRelabel) {
+		Relabel();
+	}
+	const int label = Labels[Map.getIndex(pos)];
+	return label == 0 ? 0 : Find(label);
+}
+
+/*----------------------------------------------------------------------------
+--  Functions
+----------------------------------------------------------------------------*/
+
+/**
+**  Init the connected components.
+*/
+void InitReachability(int mapWidth, int mapHeight)
+{
+	ReachabilityMapWidth = mapWidth;
+	ReachabilityMapHeight = mapHeight;
+	ReachabilityLayers.clear();
+}
+
+/**
+**  Free the connected components.
+*/
+void FreeReachability()
+{
+	ReachabilityLayers.clear();
+}
+
+/**
+**  The static obstacles of an area have changed.
+*/
+void ReachabilityAreaChanged(const Vec2i &pos, const Vec2i &size)
+{
+	for (auto &[mask, layer] : ReachabilityLayers) {
+		layer->AreaChanged(pos, size);
+	}
+}
+
+/**
+**  Check if a unit may reach a goal area, only looking at static obstacles.
+**
+**  @param startPos      Tile of the unit.
+**  @param topLeft       Top left tile of the goal area.
+**  @param bottomRight   Bottom right tile of the goal area.
+**  @param movementMask  MovementMask of the unit type.
+**
+**  @return              false if no tile of the goal area is in the component of startPos.
+**                       true if one is, or if startPos itself is unpassable.
+*/
+bool ReachabilityMayReach(const Vec2i &startPos, const Vec2i &topLeft, const Vec2i &bottomRight,
+                          int movementMask)
+{
+	Assert(ReachabilityMapWidth == Map.Info.MapWidth && ReachabilityMapHeight == Map.Info.MapHeight);
+
+	const tile_flags mask = tile_flags(movementMask) & ~ReachabilityUnitFlags;
+	auto &layer = ReachabilityLayers[mask];
+	if (!layer) {
+		layer = std::make_unique<CReachabilityLayer>(mask, ReachabilityMapWidth, ReachabilityMapHeight);
+	}
+	const int component = layer->GetComponent(startPos);
+	if (component == 0) {
+		return true;
+	}
+	for (int y = std::max<int>(0, topLeft.y); y <= std::min<int>(ReachabilityMapHeight - 1, bottomRight.y); ++y) {
+		for (int x = std::max<int>(0, topLeft.x); x <= std::min<int>(ReachabilityMapWidth - 1, bottomRight.x); ++x) {
+			if (layer->GetComponent(Vec2i(x, y)) == component) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+//@}
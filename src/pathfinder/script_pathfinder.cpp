@@ -89,6 +89,42 @@ static int CclAStar(lua_State *l)
 			} else {
 				AStarUnknownTerrainCost = i;
 			}
+		} else if (value == "hierarchical") {
+			AStarHierarchical = true;
+		} else if (value == "no-hierarchical") {
+			AStarHierarchical = false;
+		} else if (value == "flow-field") {
+			AStarFlowField = true;
+		} else if (value == "no-flow-field") {
+			AStarFlowField = false;
+		} else if (value == "harvest-routes") {
+			AStarHarvestRoutes = true;
+		} else if (value == "no-harvest-routes") {
+			AStarHarvestRoutes = false;
+		} else if (value == "distance-fields") {
+			AStarDistanceFields = true;
+		} else if (value == "no-distance-fields") {
+			AStarDistanceFields = false;
+		} else if (value == "hierarchical-min-distance") {
+			++j;
+			i = LuaToNumber(l, j + 1);
+			if (i <= 0) {
+				ErrorPrint("Hierarchical min distance must be strictly > 0\n");
+			} else {
+				AStarHierarchicalMinDistance = i;
+			}
+		} else if (value == "batch") {
+			AStarBatch = true;
+		} else if (value == "no-batch") {
+			AStarBatch = false;
+		} else if (value == "threads") {
+			++j;
+			i = LuaToNumber(l, j + 1);
+			if (i <= 0) {
+				ErrorPrint("A* threads must be strictly > 0\n");
+			} else {
+				AStarThreads = i;
+			}
 		} else if (value == "max-search-iterations") {
 			++j;
 			i = LuaToNumber(l, j + 1);
@@ -63,7 +63,8 @@ enum class ClfType
 	Invalid, /// invalid file handle
 	Plain, /// plain text file handle
 	Gzip, /// gzip file handle
-	Bzip2 /// bzip2 file handle
+	Bzip2, /// bzip2 file handle
+	Memory /// in memory buffer, written only
 };
 
 class CFile::PImpl
@@ -81,6 +82,7 @@ class CFile::PImpl
 	int seek(long offset, int whence);
 	long tell();
 	int write(const void *buf, size_t len);
+	std::string takeBuffer() { return std::move(cl_memory); }
 
 private:
 	ClfType cl_type; /// type of CFile
@@ -91,6 +93,7 @@ class CFile::PImpl
 #ifdef USE_BZ2LIB
 	BZFILE *cl_bz;   /// bzip2 file pointer
 #endif // !USE_BZ2LIB
+	std::string cl_memory; /// content of a memory file
 };
 
 CFile::CFile() : pimpl(std::make_unique<CFile::PImpl>())
@@ -136,6 +139,25 @@ int CFile::read(void *buf, size_t len)
 	return pimpl->read(buf, len);
 }
 
+/**
+**  CLwrite Library file write
+**
+**  @param buf  Pointer to the data to write.
+**  @param len  number of bytes to write.
+*/
+int CFile::write(const void *buf, size_t len)
+{
+	return pimpl->write(buf, len);
+}
+
+/**
+**  Take the content written to a file opened with CL_WRITE_MEMORY.
+*/
+std::string CFile::takeBuffer()
+{
+	return pimpl->takeBuffer();
+}
+
 /**
 **  CLseek Library file seek
 **
@@ -319,6 +341,11 @@ int CFile::PImpl::open(const char *name, long openflags)
 
 	cl_type = ClfType::Invalid;
 
+	if ((openflags & CL_OPEN_WRITE) && (openflags & CL_WRITE_MEMORY)) {
+		cl_memory.clear();
+		cl_type = ClfType::Memory;
+		return 0;
+	}
 	if (openflags & CL_OPEN_WRITE) {
 #ifdef USE_BZ2LIB
 		if ((openflags & CL_WRITE_BZ2)
@@ -413,6 +440,9 @@ int CFile::PImpl::close()
 			ret = 0;
 		}
 #endif // USE_BZ2LIB
+		if (tp == ClfType::Memory) {
+			ret = 0;
+		}
 	} else {
 		errno = EBADF;
 	}
@@ -484,6 +514,10 @@ int CFile::PImpl::write(const void *buf, size_t size)
 			ret = BZ2_bzwrite(cl_bz, const_cast<void *>(buf), size);
 		}
 #endif // USE_BZ2LIB
+		if (tp == ClfType::Memory) {
+			cl_memory.append(static_cast<const char *>(buf), size);
+			ret = size;
+		}
 	} else {
 		errno = EBADF;
 	}
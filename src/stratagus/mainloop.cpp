@@ -44,6 +44,7 @@
 #include "missile.h"
 #include "network.h"
 #include "particle.h"
+#include "profiler.h"
 #include "replay.h"
 #include "results.h"
 #include "sound.h"
@@ -61,6 +62,9 @@
 #include <guichan.hpp>
 void DrawGuichanWidgets();
 
+#include <array>
+#include <chrono>
+
 
 enum CallPeriod { cEvery2nd   = 0b1,
 				  cEvery4th   = 0b11,
@@ -71,6 +75,13 @@ enum CallPeriod { cEvery2nd   = 0b1,
 				  cEvery128th = 0b1111111,
 				  cEvery256th = 0b11111111 };
 
+/// Phases of the game logic, timed for the headless replays
+enum class EGamePhase { TriggersEachCycle, UnitActions, MissileActions, PlayersEachCycle, Ai, Count };
+static constexpr const char *GamePhaseNames[] = {
+	"TriggersEachCycle", "UnitActions", "MissileActions", "PlayersEachCycle", "PlayersEachSecond (AI)"
+};
+static_assert(std::size(GamePhaseNames) == size_t(EGamePhase::Count));
+
 //----------------------------------------------------------------------------
 // Variables
 //----------------------------------------------------------------------------
@@ -84,6 +95,9 @@ int MouseScrollState = ScrollNone;
 EventCallback GameCallbacks;   /// Game callbacks
 EventCallback EditorCallbacks; /// Editor callbacks
 
+/// Time spent in each phase of the game logic since the game start
+static std::array<std::chrono::steady_clock::duration, size_t(EGamePhase::Count)> GamePhaseTimes;
+
 //----------------------------------------------------------------------------
 // Functions
 //----------------------------------------------------------------------------
@@ -189,6 +203,7 @@ void UpdateDisplay()
 		// to prevent empty spaces in the UI
 		Video.FillRectangleClip(ColorBlack, 0, 0, Video.Width, Video.Height);
 		DrawMapArea();
+		PROFILE_ZONE("DrawInterface");
 		// TODO: for e.g. environmental effects, we want to push to the renderer here with appropriate shaders set,
 		// then do the rest.
 		DrawMessages();
@@ -250,8 +265,29 @@ static void InitGameCallbacks()
 	GameCallbacks.NetworkEvent = NetworkEvent;
 }
 
+/**
+**  Run a phase of the game logic, and add its time to GamePhaseTimes.
+*/
+template <typename F>
+static void RunGamePhase(EGamePhase phase, F &&f)
+{
+	PROFILE_ZONE(GamePhaseNames[size_t(phase)]);
+	const auto start = std::chrono::steady_clock::now();
+	f();
+	GamePhaseTimes[size_t(phase)] += std::chrono::steady_clock::now() - start;
+}
+
+/**
+**  Check if the game runs headless, without display nor events.
+*/
+static bool IsHeadless()
+{
+	return !Parameters::Instance.headlessReplay.empty();
+}
+
 static void GameLogicLoop()
 {
+	PROFILE_ZONE_ARG("GameLogicLoop", GameCycle);
 	// Can't find a better place.
 	// FIXME: We need find better place!
 	SaveGameLoading = false;
@@ -264,10 +300,10 @@ static void GameLogicLoop()
 		++GameCycle;
 		MultiPlayerReplayEachCycle();
 		NetworkCommands(); // Get network commands
-		TriggersEachCycle();// handle triggers
-		UnitActions();      // handle units
-		MissileActions();   // handle missiles
-		PlayersEachCycle(); // handle players
+		RunGamePhase(EGamePhase::TriggersEachCycle, TriggersEachCycle); // handle triggers
+		RunGamePhase(EGamePhase::UnitActions, UnitActions);             // handle units
+		RunGamePhase(EGamePhase::MissileActions, MissileActions);       // handle missiles
+		RunGamePhase(EGamePhase::PlayersEachCycle, PlayersEachCycle);   // handle players
 		UpdateTimer();      // update game timer
 
 
@@ -285,11 +321,12 @@ static void GameLogicLoop()
 			case 0: // At cycle 0, start all ai players...
 				if (GameCycle == 0) {
 					for (int player = 0; player < NumPlayers; ++player) {
-						PlayersEachSecond(player);
+						RunGamePhase(EGamePhase::Ai, [=]() { PlayersEachSecond(player); });
 					}
 				}
 				break;
-			case 1:
+			case 1: // write the replay log, at most a second of commands is lost on crash
+				FlushReplayLog();
 				break;
 			case 2:
 				break;
@@ -309,22 +346,25 @@ static void GameLogicLoop()
 				int player = (GameCycle % CYCLES_PER_SECOND) - 7;
 				Assert(player >= 0);
 				if (player < NumPlayers) {
-					PlayersEachSecond(player);
+					RunGamePhase(EGamePhase::Ai, [=]() { PlayersEachSecond(player); });
 				}
 			}
 		}
 
 		if (Preference.AutosaveMinutes != 0 && !IsNetworkGame() && !IsReplayGame() && GameCycle > 0 && (GameCycle % (CYCLES_PER_SECOND * 60 * Preference.AutosaveMinutes)) == 0) { // autosave every X minutes (default is 5), if the option is enabled
 		//Wyrmgus end
-			UI.StatusLine.Set(_("Autosave"));
-			SaveGame("autosave.sav");
+			// skipped if the previous one is still being written
+			if (SaveGameAsync("autosave.sav")) {
+				UI.StatusLine.Set(_("Autosave"));
+			}
 		}
 	}
 
 	UpdateMessages();     // update messages
 	ParticleManager.update(); // handle particles
 
-	if (FastForwardCycle <= GameCycle || !(GameCycle & CallPeriod::cEvery256th)) {
+	if (!IsHeadless() && (FastForwardCycle <= GameCycle || !(GameCycle & CallPeriod::cEvery256th))) {
+		PROFILE_ZONE("WaitEventsOneFrame");
 		WaitEventsOneFrame();
 	}
 
@@ -339,6 +379,7 @@ static void GameLogicLoop()
 
 static void DisplayLoop()
 {
+	PROFILE_ZONE("DisplayLoop");
 	/* update only if viewmode changed */
 	CheckViewportMode();
 
@@ -347,6 +388,7 @@ static void DisplayLoop()
 	 *	FIXME: still not secure
 	 */
 	if (UI.Minimap.UpdateCache) {
+		PROFILE_ZONE("MinimapUpdate");
 		UI.Minimap.Update();
 		UI.Minimap.UpdateCache = false;
 	}
@@ -365,7 +407,11 @@ static void DisplayLoop()
 
 		FogOfWar->Update(FastForwardCycle > GameCycle);
 
-		UpdateDisplay();
+		{
+			PROFILE_ZONE("UpdateDisplay");
+			UpdateDisplay();
+		}
+		PROFILE_ZONE("RealizeVideoMemory");
 		RealizeVideoMemory();
 	}
 }
@@ -378,6 +424,35 @@ static void SingleGameLoop()
 	}
 }
 
+/**
+**  Run the game logic flat out, until the end of the replay.
+*/
+static void HeadlessReplayLoop()
+{
+	while (GameRunning && !IsReplayFinished()) {
+		GameLogicLoop();
+	}
+	GameRunning = false;
+}
+
+/**
+**  Print the results of a headless replay, used to check performance regressions.
+*/
+static void PrintHeadlessReplayResult(std::chrono::steady_clock::duration duration)
+{
+	const auto ms = [](std::chrono::steady_clock::duration d) {
+		return long(std::chrono::duration_cast<std::chrono::milliseconds>(d).count());
+	};
+	const double seconds = std::chrono::duration<double>(duration).count();
+
+	fprintf(stdout, "REPLAY RESULT: %lu cycles in %ldms, %f cycles/s, SyncHash %08x\n",
+	        GameCycle, ms(duration), seconds > 0 ? GameCycle / seconds : 0., SyncHash);
+	for (size_t i = 0; i != GamePhaseTimes.size(); ++i) {
+		fprintf(stdout, "REPLAY PHASE: %s %ldms\n", GamePhaseNames[i], ms(GamePhaseTimes[i]));
+	}
+	fflush(stdout);
+}
+
 /**
 **  Game main loop.
 **
@@ -407,10 +482,17 @@ void GameMainLoop()
 	CclCommand("if (GameStarting ~= nil) then GameStarting() end");
 
 	long ticks = SDL_GetTicks();
+	const auto start = std::chrono::steady_clock::now();
+	GamePhaseTimes.fill(std::chrono::steady_clock::duration::zero());
 
 	MultiPlayerReplayEachCycle();
 
-	SingleGameLoop();
+	if (IsHeadless()) {
+		HeadlessReplayLoop();
+		PrintHeadlessReplayResult(std::chrono::steady_clock::now() - start);
+	} else {
+		SingleGameLoop();
+	}
 
 	//
 	// Game over
@@ -0,0 +1,205 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name profiler.cpp - The game loop profiler. */
+//
+//      (c) Copyright 2026 by the Stratagus Team
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+//@{
+
+/*----------------------------------------------------------------------------
+--  Includes
+----------------------------------------------------------------------------*/
+
+#include "stratagus.h"
+
+#include "profiler.h"
+
+#include "game.h"
+#include "iolib.h"
+#include "parameters.h"
+#include "script.h"
+
+#ifdef USE_PROFILER
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <vector>
+#endif
+
+/*----------------------------------------------------------------------------
+--  Variables
+----------------------------------------------------------------------------*/
+
+#ifdef USE_PROFILER
+
+namespace
+{
+
+/// A zone run to its end
+struct ProfileEvent {
+	const char *Name = nullptr; /// Name of the zone, nullptr if the slot is unused
+	long Arg = -1;              /// Argument of the zone, -1 if none
+	int64_t Start = 0;          /// Start time in ns since the profiler start
+	int64_t Duration = 0;       /// Duration in ns
+	int Thread = 0;             /// Index of the thread which ran the zone
+};
+
+} // namespace
+
+/// Number of zones kept, the oldest ones are overwritten
+static constexpr size_t ProfileEventMax = 1 << 16;
+
+static const auto ProfilerStart = std::chrono::steady_clock::now();
+/// Ring buffer of the recorded zones
+static std::vector<ProfileEvent> ProfileEvents(ProfileEventMax);
+/// Number of zones recorded since the start, the A* workers record too
+static std::atomic<size_t> ProfileEventCount(0);
+static std::atomic<int> ProfileThreadCount(0);
+static thread_local const int ProfileThread = ProfileThreadCount++;
+
+#endif
+
+/*----------------------------------------------------------------------------
+--  Functions
+----------------------------------------------------------------------------*/
+
+#ifdef USE_PROFILER
+
+static int64_t ProfilerNow()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()
+	                                                            - ProfilerStart).count();
+}
+
+CProfileZone::CProfileZone(const char *name, long arg) : Name(name), Arg(arg), Start(ProfilerNow())
+{
+}
+
+CProfileZone::~CProfileZone()
+{
+	ProfileEvent &event = ProfileEvents[ProfileEventCount++ % ProfileEventMax];
+
+	event.Name = Name;
+	event.Arg = Arg;
+	event.Start = Start;
+	event.Duration = ProfilerNow() - Start;
+	event.Thread = ProfileThread;
+}
+
+#endif
+
+/**
+**  Save the recorded zones as a Chrome trace event file.
+**
+**  Must be called from the game thread, while no worker thread runs zones.
+**
+**  @param filename  File to write, if empty a new file in the logs directory.
+**
+**  @return          true if saved.
+*/
+bool SaveProfile(fs::path filename)
+{
+#ifdef USE_PROFILER
+	if (filename.empty()) {
+		filename = Parameters::Instance.GetUserDirectory();
+		if (!GameName.empty()) {
+			filename /= GameName;
+		}
+		filename /= "logs";
+		fs::create_directories(filename);
+		filename /= "profile_" + std::to_string((intmax_t) time(nullptr)) + ".json";
+	}
+	CFile file;
+	if (file.open(filename.string().c_str(), CL_OPEN_WRITE) == -1) {
+		ErrorPrint("Can't save the profile to '%s'\n", filename.u8string().c_str());
+		return false;
+	}
+	const size_t count = ProfileEventCount;
+	const size_t first = count > ProfileEventMax ? count - ProfileEventMax : 0;
+
+	file.printf("{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+	const char *separator = "";
+	for (size_t i = first; i != count; ++i) {
+		const ProfileEvent &event = ProfileEvents[i % ProfileEventMax];
+		if (event.Name == nullptr) {
+			continue;
+		}
+		file.printf("%s{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f",
+		            separator, event.Name, event.Thread,
+		            event.Start / 1000., event.Duration / 1000.);
+		if (event.Arg != -1) {
+			file.printf(", \"args\": {\"arg\": %ld}", event.Arg);
+		}
+		file.printf("}");
+		separator = ",\n";
+	}
+	file.printf("\n]}\n");
+	file.close();
+	LogPrint("Profile of %d zones saved to '%s'\n", int(count - first), filename.u8string().c_str());
+	return true;
+#else
+	(void)filename; // unused arg.
+	ErrorPrint("Compiled without the profiler, configure with -DENABLE_PROFILER=ON\n");
+	return false;
+#endif
+}
+
+/**
+**  Save the recorded zones as a Chrome trace.
+**
+**  @param l  Lua state.
+**
+**  Example:
+**
+**  <div class="example"><code><strong>SaveProfile</strong>("stall.json")</code></div>
+**
+**  A relative file name is in the logs directory, without file name
+**  a new file is created there. Returns true if saved.
+*/
+static int CclSaveProfile(lua_State *l)
+{
+	const int args = lua_gettop(l);
+	if (args > 1) {
+		LuaError(l, "incorrect argument");
+	}
+	fs::path filename;
+	if (args == 1) {
+		filename = Parameters::Instance.GetUserDirectory() / GameName / "logs"
+		           / std::string(LuaToString(l, 1));
+	}
+	lua_pushboolean(l, SaveProfile(filename));
+	return 1;
+}
+
+/**
+**  Register CCL features for the profiler.
+*/
+void ProfilerCclRegister()
+{
+	lua_register(Lua, "SaveProfile", CclSaveProfile);
+}
+
+//@}
@@ -395,6 +395,7 @@ void Exit(int err)
 		return;
 	}
 	GameCycle = 0;
+	WaitSaveGame();
 	StopMusic();
 	QuitSound();
 	NetworkQuitGame();
@@ -465,6 +466,7 @@ static void Usage()
 		"\t-p\t\tEnables debug messages printing in console\n"
 		"\t-P port\t\tNetwork port to use\n"
 		"\t-r\t\tIndicate a rapid start. Skips a few things like title screens\n"
+		"\t-R replay\tRun a replay without display as fast as possible, report its timings and exit\n"
 		"\t-s sleep\tNumber of frames for the AI to sleep before it starts\n"
 		"\t-S speed\tSync speed (100 = 30 frames/s)\n"
 		"\t-u userpath\tPath where stratagus saves preferences, log and savegame. Use 'userhome' to force platform-default userhome directory.\n"
@@ -523,7 +525,7 @@ void ParseCommandLine(int argc, char **argv, Parameters &parameters)
 #endif
 	char *sep;
 	for (;;) {
-		switch (getopt(argc, argv, "abc:d:D:eE:FgG:hiI:lN:oOP:prs:S:u:v:W?-")) {
+		switch (getopt(argc, argv, "abc:d:D:eE:FgG:hiI:lN:oOP:prR:s:S:u:v:W?-")) {
 			case 'a':
 				EnableAssert = true;
 				continue;
@@ -584,6 +586,9 @@ void ParseCommandLine(int argc, char **argv, Parameters &parameters)
 			case 'r':
 				IsRestart = true;
 				continue;
+			case 'R':
+				parameters.headlessReplay = fs::absolute(optarg);
+				continue;
 			case 's':
 				AiSleepCycles = to_number(optarg);
 				continue;
@@ -777,7 +782,7 @@ try {
 	LoadFonts();
 	SetClipping(0, 0, Video.Width - 1, Video.Height - 1);
 	Video.ClearScreen();
-	if (!IsRestart) {
+	if (!IsRestart && parameters.headlessReplay.empty()) {
 		ShowTitleScreens();
 	}
 
@@ -790,7 +795,12 @@ try {
 	UnitManager->Init(); // Units memory management
 	PreMenuSetup();     // Load everything needed for menus
 
-	MenuLoop();
+	if (!parameters.headlessReplay.empty()) {
+		initGuichan();
+		StartReplay(parameters.headlessReplay.string(), false);
+	} else {
+		MenuLoop();
+	}
 
 	Exit(0);
 	return 0;
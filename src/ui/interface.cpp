@@ -44,6 +44,7 @@
 #include "iolib.h"
 #include "network.h"
 #include "player.h"
+#include "profiler.h"
 #include "replay.h"
 #include "sound.h"
 #include "sound_server.h"
@@ -617,6 +618,14 @@ static bool CommandKey(int key)
 			CenterOnMessage();
 			break;
 
+#ifdef USE_PROFILER
+		case SDLK_F12: // Save the profile of the last frames
+			if (SaveProfile()) {
+				UI.StatusLine.Set(_("Profile saved"));
+			}
+			break;
+#endif
+
 		case SDLK_EQUALS: // plus is shift-equals.
 		case SDLK_KP_PLUS:
 			UiIncreaseGameSpeed();
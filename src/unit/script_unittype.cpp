@@ -760,6 +760,10 @@ static int CclDefineUnitType(lua_State *l)
 			type->OnEachCycle.init(l, -1);
 		} else if (value == "OnEachSecond") {
 			type->OnEachSecond.init(l, -1);
+		} else if (value == "OnEachCycleBatch") {
+			type->OnEachCycleBatch.init(l, -1);
+		} else if (value == "OnEachSecondBatch") {
+			type->OnEachSecondBatch.init(l, -1);
 		} else if (value == "OnInit") {
 			type->OnInit.init(l, -1);
 		} else if (value == "OnReady") {
@@ -1315,6 +1319,8 @@ static int CclCopyUnitType(lua_State *l)
 	to->OnHit = from.OnHit;
 	to->OnEachCycle = from.OnEachCycle;
 	to->OnEachSecond = from.OnEachSecond;
+	to->OnEachCycleBatch = from.OnEachCycleBatch;
+	to->OnEachSecondBatch = from.OnEachSecondBatch;
 	to->OnInit = from.OnInit;
 	to->OnReady = from.OnReady;
 	to->MoveType = from.MoveType;
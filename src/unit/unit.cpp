@@ -50,6 +50,7 @@
 #include "map.h"
 #include "missile.h"
 #include "network.h"
+#include "pathfinder.h"
 #include "player.h"
 #include "script.h"
 #include "settings.h"
@@ -58,6 +59,7 @@
 #include "spells.h"
 #include "tileset.h"
 #include "translate.h"
+#include "trigger.h"
 #include "ui.h"
 #include "unit_find.h"
 #include "unit_manager.h"
@@ -422,7 +424,12 @@ void CUnit::Init()
 	Stats = nullptr;
 	CurrentSightRange = 0;
 
-	pathFinderData = std::make_unique<PathFinderData>();
+	// Reused slots keep their memory
+	if (pathFinderData) {
+		*pathFinderData = PathFinderData();
+	} else {
+		pathFinderData = std::make_unique<PathFinderData>();
+	}
 	pathFinderData->input.SetUnit(*this);
 
 	Frame = 0;
@@ -540,6 +547,7 @@ void CUnit::Release(bool final)
 	NewOrder = nullptr;
 	CriticalOrder = nullptr;
 
+	MapSightForget(*this);
 	// Remove the unit from the global units table.
 	UnitManager->ReleaseUnit(*this);
 }
@@ -794,6 +802,32 @@ static void MapMarkUnitSightRec(const CUnit &unit, const Vec2i &pos, int width,
 	}
 }
 
+/**
+**  Move on vision table the Sight of the unit
+**  (and units inside for transporter (recursively))
+**
+**  @param unit    Unit to move the sight of.
+**  @param oldPos  Previous coord of first container of unit.
+**  @param newPos  New coord of first container of unit.
+**  @param width   Width of the first container of unit.
+**  @param height  Height of the first container of unit.
+*/
+static void MapMoveUnitSightRec(const CUnit &unit, const Vec2i &oldPos, const Vec2i &newPos,
+								int width, int height)
+{
+	const bool detectCloak = unit.Type && unit.Type->BoolFlag[DETECTCLOAK_INDEX].value;
+	MapSightMove(*unit.Player, unit, oldPos, newPos, width, height,
+				 unit.Container ? unit.Container->CurrentSightRange : unit.CurrentSightRange,
+				 MapMarkTileSight, MapUnmarkTileSight,
+				 detectCloak ? MapMarkTileDetectCloak : nullptr,
+				 detectCloak ? MapUnmarkTileDetectCloak : nullptr);
+
+	CUnit *unit_inside = unit.UnitInside;
+	for (int i = unit.InsideCount; i--; unit_inside = unit_inside->NextContained) {
+		MapMoveUnitSightRec(*unit_inside, oldPos, newPos, width, height);
+	}
+}
+
 /**
 **  Return the unit not transported, by viewing the container recursively.
 **
@@ -869,6 +903,36 @@ void MapUnmarkUnitSight(CUnit &unit)
 	}
 }
 
+/**
+**  Move on vision table the Sight of a unit which has moved
+**  (and units inside for transporter), only the tiles leaving or entering
+**  the sight are updated.
+**
+**  @param unit    unit not transported, already at its new position.
+**  @param oldPos  previous position of the unit.
+**  @see MapCanMoveSight.
+*/
+static void MapMoveUnitSight(CUnit &unit, const Vec2i &oldPos)
+{
+	Assert(unit.Type && !unit.Container);
+
+	const int width = unit.Type->TileWidth;
+	const int height = unit.Type->TileHeight;
+	MapMoveUnitSightRec(unit, oldPos, unit.tilePos, width, height);
+
+	if (!unit.IsUnusable()) {
+		if (unit.Stats->Variables[RADAR_INDEX].Value) {
+			MapSightMove(*unit.Player, unit, oldPos, unit.tilePos, width, height,
+						 unit.Stats->Variables[RADAR_INDEX].Value, MapMarkTileRadar, MapUnmarkTileRadar);
+		}
+		if (unit.Stats->Variables[RADARJAMMER_INDEX].Value) {
+			MapSightMove(*unit.Player, unit, oldPos, unit.tilePos, width, height,
+						 unit.Stats->Variables[RADARJAMMER_INDEX].Value,
+						 MapMarkTileRadarJammer, MapUnmarkTileRadarJammer);
+		}
+	}
+}
+
 /**
 **  Mark/Unmark on vision table the Sight for the units
 **  around the tilePos
@@ -881,9 +945,9 @@ void MapUnmarkUnitSight(CUnit &unit)
 */
 void MapRefreshUnitsSight(const Vec2i &tilePos, const bool resetSight /*= false*/)
 {
-	const CMapField *mapField = Map.Field(tilePos);
+	const unsigned int index = Map.getIndex(tilePos);
 	for (const CPlayer &player : Players) {
-		if(!mapField->playerInfo.Visible[player.Index]) {
+		if (!Map.Visibility.IsExplored(player.Index, index)) {
 			continue;
 		}
 		for (CUnit *const unit : player.GetUnits()) {
@@ -982,6 +1046,10 @@ void MarkUnitFieldFlags(const CUnit &unit)
 		} while (--w);
 		index += Map.Info.MapWidth;
 	} while (--h);
+	if (flags & ~(MapFieldLandUnit | MapFieldAirUnit | MapFieldSeaUnit)) {
+		// a building, not only a moving unit
+		MapTerrainChanged(unit.tilePos, Vec2i(width, unit.Type->TileHeight));
+	}
 }
 
 class _UnmarkUnitFieldFlags
@@ -1032,6 +1100,10 @@ void UnmarkUnitFieldFlags(const CUnit &unit)
 		} while (--w);
 		index += Map.Info.MapWidth;
 	} while (--h);
+	if (unit.Type->FieldFlags & ~(MapFieldLandUnit | MapFieldAirUnit | MapFieldSeaUnit)) {
+		// a building, not only a moving unit
+		MapTerrainChanged(unit.tilePos, Vec2i(width, unit.Type->TileHeight));
+	}
 }
 
 /**
@@ -1130,7 +1202,12 @@ static void UnitInXY(CUnit &unit, const Vec2i &pos)
 */
 void CUnit::MoveToXY(const Vec2i &pos)
 {
-	MapUnmarkUnitSight(*this);
+	const Vec2i oldPos = this->tilePos;
+	const bool moveSight = !this->Container && MapCanMoveSight();
+
+	if (!moveSight) {
+		MapUnmarkUnitSight(*this);
+	}
 	Map.Remove(*this);
 	UnmarkUnitFieldFlags(*this);
 
@@ -1142,7 +1219,11 @@ void CUnit::MoveToXY(const Vec2i &pos)
 	MarkUnitFieldFlags(*this);
 	//  Recalculate the seen count.
 	UnitCountSeen(*this);
-	MapMarkUnitSight(*this);
+	if (moveSight) {
+		MapMoveUnitSight(*this, oldPos);
+	} else {
+		MapMarkUnitSight(*this);
+	}
 }
 
 /**
@@ -1665,9 +1746,10 @@ void UnitCountSeen(CUnit &unit)
 			do {
 				CMapField *mf = Map.Field(index);
 				int x = width;
+				unsigned int tileIndex = index;
 				do {
 					if (unit.Type->BoolFlag[PERMANENTCLOAK_INDEX].value && unit.Player != &Players[p]) {
-						if (mf->playerInfo.VisCloak[p] || Players[p].Type == PlayerTypes::PlayerNobody) {
+						if (Map.Visibility.VisCloak(p, tileIndex) || Players[p].Type == PlayerTypes::PlayerNobody) {
 							newv++;
 						}
 					} else {
@@ -1676,6 +1758,7 @@ void UnitCountSeen(CUnit &unit)
 						}
 					}
 					++mf;
+					++tileIndex;
 				} while (--x);
 				index += Map.Info.MapWidth;
 			} while (--y);
@@ -1830,6 +1913,7 @@ void CUnit::ChangeOwner(CPlayer &newplayer)
 	for (int i = InsideCount; i; --i, uins = uins->NextContained) {
 		uins->ChangeOwner(newplayer);
 	}
+	TriggerUnitChanged(*this);
 
 	//  Must change food/gold and other.
 	UnitLost(*this);
@@ -1878,6 +1962,9 @@ void CUnit::ChangeOwner(CPlayer &newplayer)
 	}
 
 	UpdateForNewUnit(*this, 1);
+	TriggerUnitChanged(*this);
+	DistanceFieldsUnitChanged(*this);
+	AiInfluenceUnitChanged(*this);
 }
 
 static bool IsMineAssignedBy(const CUnit &mine, const CUnit &worker)
@@ -2412,6 +2499,7 @@ PixelPos CUnit::GetMapPixelPosCenter() const
 */
 void LetUnitDie(CUnit &unit, bool suicide)
 {
+	TriggerUnitChanged(unit);
 	unit.Variable[HP_INDEX].Value = std::min<int>(0, unit.Variable[HP_INDEX].Value);
 	unit.Moving = 0;
 	unit.TTL = 0;
@@ -50,10 +50,48 @@
 #include "unit_manager.h"
 #include "unittype.h"
 
+#include <algorithm>
+#include <tuple>
+
 /*----------------------------------------------------------------------------
   -- Finding units
   ----------------------------------------------------------------------------*/
 
+/**
+**  Find the units of an area with Map.UnitBuckets, sorted as if its tiles
+**  were scanned: by their first tile in the area, then by their place in
+**  the UnitCache of that tile.
+**
+**  @param ltPos  Top left tile of the area (on the map).
+**  @param rbPos  Bottom right tile of the area (on the map).
+*/
+std::vector<CUnit *> FindUnitsInTileOrder(const Vec2i &ltPos, const Vec2i &rbPos)
+{
+	struct Entry {
+		unsigned int Index;      /// Index of the first tile in the area
+		unsigned int CacheIndex; /// Place in the UnitCache of that tile
+		CUnit *Unit;
+	};
+	std::vector<Entry> entries;
+
+	ForEachUnitInArea(ltPos, rbPos, [&](CUnit *unit) {
+		const Vec2i pos(std::max(unit->tilePos.x, ltPos.x), std::max(unit->tilePos.y, ltPos.y));
+		const auto &cache = Map.Field(pos)->UnitCache;
+		const unsigned int cacheIndex = ranges::find(cache, unit) - cache.begin();
+
+		entries.push_back({Map.getIndex(pos), cacheIndex, unit});
+	});
+	std::sort(entries.begin(), entries.end(), [](const Entry &lhs, const Entry &rhs) {
+		return std::tie(lhs.Index, lhs.CacheIndex) < std::tie(rhs.Index, rhs.CacheIndex);
+	});
+	std::vector<CUnit *> units;
+	units.reserve(entries.size());
+	for (const Entry &entry : entries) {
+		units.push_back(entry.Unit);
+	}
+	return units;
+}
+
 std::vector<CUnit *> Select(const Vec2i &ltPos, const Vec2i &rbPos)
 {
 	return Select(ltPos, rbPos, NoFilter());
@@ -158,6 +196,12 @@ VisitResult TerrainFinder::Visit(TerrainTraversal &terrainTraversal, const Vec2i
 bool FindTerrainType(int movemask, int resmask, int range,
 					 const CPlayer &player, const Vec2i &startPos, Vec2i *terrainPos)
 {
+	// The AI doesn't care about the explored tiles, it can read the forest field.
+	if (resmask == MapFieldForest && player.AiEnabled) {
+		if (const auto found = DistanceFieldFindForest(startPos, movemask, range, terrainPos)) {
+			return *found;
+		}
+	}
 	TerrainTraversal terrainTraversal;
 
 	terrainTraversal.SetSize(Map.Info.MapWidth, Map.Info.MapHeight);
@@ -442,6 +486,9 @@ CUnit *UnitFindResource(const CUnit &unit, const CUnit &startUnit, int range, in
 */
 CUnit *FindDeposit(const CUnit &unit, int range, int resource)
 {
+	if (const auto depot = DistanceFieldFindDeposit(unit, range, resource)) {
+		return *depot;
+	}
 	BestDepotFinder<false> finder(unit, resource, range);
 	std::vector<CUnit *> table = unit.Player->GetUnits();
 	if (GameSettings.AllyDepositsAllowed) {
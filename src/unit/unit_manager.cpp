@@ -36,11 +36,34 @@
 #include "stratagus.h"
 
 #include "unit_manager.h"
+#include "actions.h"
 #include "unit.h"
 #include "iolib.h"
 #include "script.h"
 
 
+/*----------------------------------------------------------------------------
+--  Declarations
+----------------------------------------------------------------------------*/
+
+/**
+**  Contiguous storage for a fixed number of units.
+**
+**  Units are built in place when their slot is first used and are only
+**  destroyed by CUnitManager::Init, released slots are reused instead.
+**  So every slot of CUnitManager::unitSlots holds a constructed unit.
+*/
+class CUnitSlab
+{
+public:
+	static constexpr size_t Size = 64; /// Number of units by slab
+
+	CUnit *Construct(size_t index) { return new (Storage[index]) CUnit; }
+
+private:
+	alignas(CUnit) unsigned char Storage[Size][sizeof(CUnit)];
+};
+
 /*----------------------------------------------------------------------------
 --  Variables
 ----------------------------------------------------------------------------*/
@@ -51,23 +74,73 @@ CUnitManager *UnitManager;          /// Unit manager
 --  Functions
 ----------------------------------------------------------------------------*/
 
+/**
+**  Drop the orders of a unit, they may release the units they reference.
+*/
+static void DropOrders(CUnit &unit)
+{
+	// Moved out first, the unit itself may be released meanwhile.
+	const auto orders = std::move(unit.Orders);
+	const auto savedOrder = std::move(unit.SavedOrder);
+	const auto newOrder = std::move(unit.NewOrder);
+	const auto criticalOrder = std::move(unit.CriticalOrder);
+}
+
 /**
 **  Initial memory allocation for units.
+**
+**  All the units are destroyed, even the ones still referenced (by each
+**  other, the game is over).
 */
 void CUnitManager::Init()
 {
 	lastCreated = nullptr;
-	//Assert(units.empty());
 	units.clear();
-	// Release memory of units in release list.
-	while (!releasedUnits.empty()) {
-		CUnit *unit = releasedUnits.front();
-		releasedUnits.pop_front();
-		delete unit;
+	locked = false;
+	lockedUnits.clear();
+	releasedUnits.clear();
+
+	// The orders reference other units: drop them all before destroying any unit.
+	clearing = true;
+	for (CUnit *unit : unitSlots) {
+		if (!unit->ReleaseCycle) {
+			DebugPrint("Unit %d still referenced\n", UnitNumber(*unit));
+		}
+		DropOrders(*unit);
 	}
+	for (CUnit *unit : unitSlots) {
+		unit->~CUnit();
+	}
+	clearing = false;
 
 	// Initialize the free unit slots
 	unitSlots.clear();
+	unitSlabs.clear();
+}
+
+CUnitManager::CUnitManager() = default;
+
+CUnitManager::~CUnitManager()
+{
+	Init();
+}
+
+/**
+**  Build a unit in a new slot.
+**
+**  @return  New unit
+*/
+CUnit *CUnitManager::NewSlotUnit()
+{
+	const size_t slot = unitSlots.size();
+
+	if (slot % CUnitSlab::Size == 0) {
+		unitSlabs.push_back(std::make_unique<CUnitSlab>());
+	}
+	CUnit *unit = unitSlabs.back()->Construct(slot % CUnitSlab::Size);
+	unit->UnitManagerData.slot = slot;
+	unitSlots.push_back(unit);
+	return unit;
 }
 
 /**
@@ -87,11 +160,7 @@ CUnit *CUnitManager::AllocUnit()
 		unit->UnitManagerData.unitSlot = -1;
 		return unit;
 	} else {
-		CUnit *unit = new CUnit;
-
-		unit->UnitManagerData.slot = unitSlots.size();
-		unitSlots.push_back(unit);
-		return unit;
+		return NewSlotUnit();
 	}
 }
 
@@ -105,14 +174,15 @@ void CUnitManager::ReleaseUnit(CUnit &unit)
 	if (lastCreated == &unit) {
 		lastCreated = nullptr;
 	}
+	if (clearing) { // destroyed by Init right after
+		return;
+	}
 	if (unit.UnitManagerData.unitSlot != -1) { // == -1 when loading.
-		Assert(units[unit.UnitManagerData.unitSlot] == &unit);
-
-		CUnit *temp = units.back();
-		temp->UnitManagerData.unitSlot = unit.UnitManagerData.unitSlot;
-		units[unit.UnitManagerData.unitSlot] = temp;
-		unit.UnitManagerData.unitSlot = -1;
-		units.pop_back();
+		if (locked && lockedUnits.empty()) {
+			// keep the units walked at their place
+			lockedUnits.assign(units.begin(), units.begin() + lockedCount);
+		}
+		RemoveFromUnits(unit);
 	}
 	Assert(unit.PlayerSlot == static_cast<size_t>(-1));
 	releasedUnits.push_back(&unit);
@@ -120,6 +190,56 @@ void CUnitManager::ReleaseUnit(CUnit &unit)
 	//Refs = GameCycle + (NetworkMaxLag << 1); // could be reuse after this time
 }
 
+/**
+**  Remove a unit from the units table, the last unit takes its place.
+*/
+void CUnitManager::RemoveFromUnits(CUnit &unit)
+{
+	Assert(units[unit.UnitManagerData.unitSlot] == &unit);
+
+	CUnit *temp = units.back();
+	temp->UnitManagerData.unitSlot = unit.UnitManagerData.unitSlot;
+	units[unit.UnitManagerData.unitSlot] = temp;
+	unit.UnitManagerData.unitSlot = -1;
+	units.pop_back();
+}
+
+/**
+**  Lock the units table to walk it as it is now with GetLockedUnit.
+**
+**  GetUnits() stays up to date meanwhile. New units are only added at
+**  its end, so it is only copied (once) if a unit is released before
+**  UnlockUnits. The released units are Destroyed, the walk skips them.
+*/
+void CUnitManager::LockUnits()
+{
+	Assert(!locked);
+	locked = true;
+	lockedCount = units.size();
+}
+
+/**
+**  Get a unit of the table as it was when locked.
+**
+**  @param index  Index of the unit, less than GetLockedCount().
+*/
+CUnit &CUnitManager::GetLockedUnit(size_t index) const
+{
+	Assert(locked && index < lockedCount);
+	return *(lockedUnits.empty() ? units : lockedUnits)[index];
+}
+
+/**
+**  Unlock the units table.
+*/
+void CUnitManager::UnlockUnits()
+{
+	Assert(locked);
+	locked = false;
+	lockedCount = 0;
+	lockedUnits.clear();
+}
+
 CUnit &CUnitManager::GetSlotUnit(int index) const
 {
 	return *unitSlots[index];
@@ -177,9 +297,7 @@ void CUnitManager::Load(lua_State *l)
 		LuaError(l, "incorrect argument");
 	}
 	for (unsigned int i = 0; i < unitCount; i++) {
-		CUnit *unit = new CUnit;
-		unitSlots.push_back(unit);
-		unit->UnitManagerData.slot = i;
+		NewSlotUnit();
 	}
 	const unsigned int args = lua_rawlen(l, 2);
 	for (unsigned int i = 0; i < args; i++) {
@@ -33,6 +33,9 @@
 #include "network.h"
 #include "net_message.h"
 
+#include <algorithm>
+#include <iterator>
+
 void FillCustomValue(CNetworkCommand *obj)
 {
 	obj->Dest = 0x1234;
@@ -58,6 +61,21 @@ void FillCustomValue(CNetworkCommandSync *obj)
 {
 	obj->syncSeed = 0x01234567;
 	obj->syncHash = 0x89ABCDEF;
+	obj->strongHash = 0x13579BDF;
+}
+void FillCustomValue(CNetworkSyncBuckets *obj)
+{
+	obj->player = 3;
+	obj->Buckets.Cycle = 0x01234567;
+	for (int i = 0; i != SyncHashRegionCount; ++i) {
+		obj->Buckets.Regions[i] = 0x0123 * i;
+	}
+	for (int i = 0; i != SyncHashUnitRangeCount; ++i) {
+		obj->Buckets.Units[i] = 0x4567 + i;
+	}
+	for (int i = 0; i != PlayerMax; ++i) {
+		obj->Buckets.Players[i] = 0x89AB ^ i;
+	}
 }
 void FillCustomValue(CNetworkCommandQuit *obj)
 {
@@ -94,6 +112,14 @@ bool Comp(const CNetworkSelection &lhs, const CNetworkSelection &rhs)
 	return lhs.Units == rhs.Units;
 }
 
+bool Comp(const CNetworkSyncBuckets &lhs, const CNetworkSyncBuckets &rhs)
+{
+	return lhs.player == rhs.player && lhs.Buckets.Cycle == rhs.Buckets.Cycle
+	       && std::equal(std::begin(lhs.Buckets.Regions), std::end(lhs.Buckets.Regions), rhs.Buckets.Regions)
+	       && std::equal(std::begin(lhs.Buckets.Units), std::end(lhs.Buckets.Units), rhs.Buckets.Units)
+	       && std::equal(std::begin(lhs.Buckets.Players), std::end(lhs.Buckets.Players), rhs.Buckets.Players);
+}
+
 
 template <typename T>
 bool CheckSerialization()
@@ -126,6 +152,10 @@ TEST_CASE("CNetworkCommandSync")
 {
 	CHECK(CheckSerialization<CNetworkCommandSync>());
 }
+TEST_CASE("CNetworkSyncBuckets")
+{
+	CHECK(CheckSerialization<CNetworkSyncBuckets>());
+}
 TEST_CASE("CNetworkCommandQuit")
 {
 	CHECK(CheckSerialization<CNetworkCommandQuit>());
@@ -0,0 +1,205 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name test_actions.cpp - The test file for actions.cpp. */
+//
+//      (c) Copyright 2026 by the Stratagus Team
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#include <doctest.h>
+
+#include "stratagus.h"
+
+#include "actions.h"
+#include "player.h"
+#include "script.h"
+#include "unit.h"
+#include "unit_manager.h"
+#include "unittype.h"
+
+namespace
+{
+/**
+**  Two unit-types with per-unit and batched callbacks which log the ids
+**  of the units they are called for.
+*/
+class CallbackUnits
+{
+public:
+	CallbackUnits()
+	{
+		InitLua();
+		const std::string_view script = R"(
+			each = {a = "", b = ""}
+			batch = {a = "", b = ""}
+			order = ""
+			function EachA(id) each.a = each.a .. string.format("%d ", id) end
+			function EachB(id) each.b = each.b .. string.format("%d ", id) end
+			function BatchA(ids)
+				order = order .. "a"
+				for _, id in ipairs(ids) do batch.a = batch.a .. string.format("%d ", id) end
+			end
+			function BatchB(ids)
+				order = order .. "b"
+				for _, id in ipairs(ids) do batch.b = batch.b .. string.format("%d ", id) end
+			end
+)";
+		REQUIRE(luaL_loadbuffer(Lua, script.data(), script.size(), "test") == 0);
+		LuaCall(Lua, 0, 0, lua_gettop(Lua), false);
+
+		typeA = NewUnitTypeSlot("unit-test-a").first;
+		typeB = NewUnitTypeSlot("unit-test-b").first;
+		REQUIRE(typeA->Slot < typeB->Slot);
+		const auto initCallback = [](auto &callback, const char *function) {
+			lua_getglobal(Lua, function);
+			callback.init(Lua, -1);
+			lua_pop(Lua, 1);
+		};
+		initCallback(typeA->OnEachCycle, "EachA");
+		initCallback(typeB->OnEachCycle, "EachB");
+		initCallback(typeA->OnEachCycleBatch, "BatchA");
+		initCallback(typeB->OnEachCycleBatch, "BatchB");
+		initCallback(typeB->OnEachSecondBatch, "BatchB");
+
+		oldUnitManager = UnitManager;
+		UnitManager = &manager;
+	}
+	CallbackUnits(const CallbackUnits &) = delete;
+	~CallbackUnits()
+	{
+		UnitManager = oldUnitManager;
+		CleanUnitTypes();
+		lua_close(Lua);
+		Lua = nullptr;
+	}
+
+	CUnit &Create(CUnitType &type)
+	{
+		CUnit &unit = *manager.AllocUnit();
+		manager.Add(&unit);
+		unit.Type = &type;
+		unit.Player = &Players[0];
+		unit.Orders.push_back(COrder::NewActionStill());
+		unit.Removed = 0;
+		return unit;
+	}
+
+	/// Call the per-unit callbacks, as UnitActionsEachCycle does
+	void EachCycle(size_t count)
+	{
+		for (size_t i = 0; i != count; ++i) {
+			CUnit &unit = manager.GetLockedUnit(i);
+
+			if (!unit.Destroyed && unit.Type->OnEachCycle && unit.IsUnusable(false) == false) {
+				unit.Type->OnEachCycle(UnitNumber(unit));
+			}
+		}
+	}
+
+	static std::string Log(const char *table, const char *field)
+	{
+		lua_getglobal(Lua, table);
+		lua_getfield(Lua, -1, field);
+		const std::string res{LuaToString(Lua, -1)};
+		lua_pop(Lua, 2);
+		return res;
+	}
+	static std::string Order()
+	{
+		lua_getglobal(Lua, "order");
+		const std::string res{LuaToString(Lua, -1)};
+		lua_pop(Lua, 1);
+		return res;
+	}
+	static void ClearOrder()
+	{
+		lua_pushstring(Lua, "");
+		lua_setglobal(Lua, "order");
+	}
+
+	CUnitType *typeA = nullptr;
+	CUnitType *typeB = nullptr;
+
+private:
+	CUnitManager manager;
+	CUnitManager *oldUnitManager = nullptr;
+};
+} // namespace
+
+TEST_CASE("Batched unit-type callbacks")
+{
+	CallbackUnits units;
+
+	// Interleaved types, the first unit isn't of the first type
+	std::vector<CUnit *> created;
+	for (int i = 0; i != 20; ++i) {
+		created.push_back(&units.Create(i % 3 ? *units.typeA : *units.typeB));
+	}
+	created[3]->Removed = 1; // unusable
+	created[4]->Destroyed = 1;
+	created[5]->Orders[0] = COrder::NewActionDie();
+	UnitManager->LockUnits();
+	const size_t count = UnitManager->GetLockedCount();
+	REQUIRE(count == created.size());
+
+	units.EachCycle(count);
+	UnitActionsBatchedCallback(count, false);
+
+	const std::string eachA = CallbackUnits::Log("each", "a");
+	const std::string eachB = CallbackUnits::Log("each", "b");
+	std::string expectedA;
+	std::string expectedB;
+	for (size_t i = 0; i != created.size(); ++i) {
+		if (i < 3 || i > 5) {
+			const CUnit &unit = *created[i];
+			(unit.Type == units.typeA ? expectedA : expectedB) += std::to_string(UnitNumber(unit)) + " ";
+		}
+	}
+	CHECK(eachA == expectedA);
+	CHECK(eachB == expectedB);
+	// Same units in the same order, ordered by unit-type slot
+	CHECK(CallbackUnits::Log("batch", "a") == eachA);
+	CHECK(CallbackUnits::Log("batch", "b") == eachB);
+	CHECK(CallbackUnits::Order() == "ab");
+
+	SUBCASE("Each second")
+	{
+		CallbackUnits::ClearOrder();
+		UnitActionsBatchedCallback(count, true);
+		CHECK(CallbackUnits::Order() == "b"); // only typeB has one
+		CHECK(CallbackUnits::Log("batch", "b") == eachB + eachB);
+	}
+	SUBCASE("No usable unit")
+	{
+		for (CUnit *unit : created) {
+			if (unit->Type == units.typeA) {
+				unit->Removed = 1;
+			}
+		}
+		CallbackUnits::ClearOrder();
+		UnitActionsBatchedCallback(count, false);
+		CHECK(CallbackUnits::Order() == "b"); // not called with no id
+	}
+	UnitManager->UnlockUnits();
+}
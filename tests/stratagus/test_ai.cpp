@@ -0,0 +1,538 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name test_ai.cpp - The test file for the AI. */
+//
+//      (c) Copyright 2026 by the Stratagus Team
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#include <doctest.h>
+
+#include "stratagus.h"
+
+#include "ai.h"
+#include "actions.h"
+#include "iolib.h"
+#include "map.h"
+#include "player.h"
+#include "script.h"
+#include "unit.h"
+#include "unit_find.h"
+#include "unit_manager.h"
+#include "unittype.h"
+
+#include <algorithm>
+#include <deque>
+
+namespace
+{
+/**
+**  A player with some units, whose AI tasks are split over the cycles
+**  like AiEachCycle does, without running them.
+*/
+class AiTasksPlayer
+{
+public:
+	AiTasksPlayer(CPlayer &player, int unitCount) : player(player), units(unitCount)
+	{
+		for (CUnit &unit : units) {
+			player.AddUnit(unit);
+		}
+	}
+	AiTasksPlayer(const AiTasksPlayer &) = delete;
+	~AiTasksPlayer()
+	{
+		for (CUnit &unit : units) {
+			player.RemoveUnit(unit);
+		}
+	}
+
+	/// Put some units of the player in a force
+	void Recruit(PlayerAi &ai, unsigned int force, int count)
+	{
+		for (int i = 0; i != count; ++i) {
+			ai.Force[force].Units.push_back(&units[i]);
+		}
+	}
+
+	/// Start the tasks of a second, like AiEachSecond does
+	static void StartSecond(PlayerAi &ai)
+	{
+		ai.NextTask = AiTask::Script;
+		ai.NextForce = 0;
+		ai.ForcePathing = AI_MAX_FORCE_PATHING;
+	}
+
+	/// Tasks run in each cycle, until the end of the second
+	static std::vector<std::vector<AiTask>> SplitSecond(PlayerAi &ai)
+	{
+		std::vector<std::vector<AiTask>> cycles;
+
+		while (ai.NextTask != AiTask::Done) {
+			std::vector<AiTask> &tasks = cycles.emplace_back();
+			AiRunTasks(ai, [&]() {
+				tasks.push_back(ai.NextTask);
+				// Move to the next task like AiRunNextTask
+				if (ai.NextTask == AiTask::Forces && ai.NextForce < ai.Force.Size()) {
+					++ai.NextForce;
+				} else {
+					ai.NextTask = AiTask(static_cast<int>(ai.NextTask) + 1);
+				}
+			});
+		}
+		return cycles;
+	}
+
+private:
+	CPlayer &player;
+	std::vector<CUnit> units;
+};
+
+constexpr int InfluenceMapSize = 64;
+
+/**
+**  A map with units of 3 players: 0 and 1 are enemies, 2 is an enemy of
+**  0 only. The units are placed, moved, given and killed like the engine
+**  does, so the influence map follows them.
+*/
+class InfluenceUnitsMap
+{
+public:
+	InfluenceUnitsMap()
+	{
+		Map.Info.MapWidth = InfluenceMapSize;
+		Map.Info.MapHeight = InfluenceMapSize;
+		Map.Create();
+		for (int i = 0; i != 3; ++i) {
+			Players[i].Index = i;
+		}
+		Players[0].SetDiplomacyEnemyWith(Players[1]);
+		Players[1].SetDiplomacyEnemyWith(Players[0]);
+		Players[2].SetDiplomacyEnemyWith(Players[0]);
+
+		footman.CanAttack = true;
+		footman.CanTarget = ECanTargetFlag::Land;
+		archer.CanAttack = true;
+		archer.CanTarget = ECanTargetFlag::Land | ECanTargetFlag::Air;
+		flyer.MoveType = EMovement::Fly;
+		flyer.CanAttack = true;
+		flyer.CanTarget = ECanTargetFlag::Air;
+		ship.MoveType = EMovement::Naval;
+		ship.CanAttack = true;
+		ship.CanTarget = ECanTargetFlag::Land | ECanTargetFlag::Sea;
+		hall.Building = true;
+		int damage = 1;
+		for (CUnitType *type : Types()) {
+			type->TileWidth = type->TileHeight = type == &hall ? 3 : type == &ship ? 2 : 1;
+			type->BoolFlag.resize(UnitTypeVar.GetNumberBoolFlag());
+			for (CUnitStats &stats : type->Stats) {
+				stats.Variables.resize(NVARALREADYDEFINED);
+				stats.Variables[BASICDAMAGE_INDEX].Value = damage;
+				stats.Variables[PIERCINGDAMAGE_INDEX].Value = 2 * damage;
+			}
+			++damage;
+		}
+		oldUnitManager = UnitManager;
+		UnitManager = &manager;
+	}
+	InfluenceUnitsMap(const InfluenceUnitsMap &) = delete;
+	~InfluenceUnitsMap()
+	{
+		for (CUnit *unit : manager.GetUnits()) {
+			if (!unit->Removed) {
+				Map.Remove(*unit);
+			}
+		}
+		UnitManager = oldUnitManager;
+		AiCleanInfluence();
+		Map.UnitBuckets.Clear();
+		Map.Fields.clear();
+		Map.Visibility.Clear();
+		Map.Info.MapWidth = 0;
+		Map.Info.MapHeight = 0;
+		for (int i = 0; i != 3; ++i) {
+			for (int j = 0; j != 3; ++j) {
+				Players[i].SetDiplomacyNeutralWith(Players[j]);
+			}
+		}
+	}
+
+	std::vector<CUnitType *> Types() { return {&footman, &archer, &flyer, &ship, &hall}; }
+
+	CUnit &Create(CUnitType &type, int player, const Vec2i &pos)
+	{
+		CUnit &unit = *manager.AllocUnit();
+		manager.Add(&unit);
+		unit.Type = &type;
+		unit.Player = &Players[player];
+		unit.Stats = &type.Stats[player];
+		unit.Orders.push_back(COrder::NewActionStill());
+		unit.Removed = 0;
+		unit.tilePos = pos;
+		unit.Offset = Map.getIndex(pos);
+		Map.Insert(unit);
+		return unit;
+	}
+
+	void Move(CUnit &unit, const Vec2i &pos)
+	{
+		Map.Remove(unit);
+		unit.tilePos = pos;
+		unit.Offset = Map.getIndex(pos);
+		Map.Insert(unit);
+	}
+
+	/// What CUnit::ChangeOwner does for the influence map
+	void ChangeOwner(CUnit &unit, int player)
+	{
+		unit.Player = &Players[player];
+		unit.Stats = const_cast<CUnitStats *>(&unit.Type->Stats[player]);
+		AiInfluenceUnitChanged(unit);
+	}
+
+	/// What LetUnitDie does, the unit stays on the map if it has a corpse
+	void Die(CUnit &unit, bool corpse)
+	{
+		Map.Remove(unit);
+		unit.Removed = 1;
+		unit.Orders[0] = COrder::NewActionDie();
+		if (corpse) {
+			unit.Removed = 0;
+			Map.Insert(unit);
+		}
+	}
+
+	/// Sum the units of some players with their top left tile in a cell
+	AiInfluence CellInfluence(const std::bitset<PlayerMax> &players, int cellX, int cellY) const
+	{
+		AiInfluence sum;
+
+		for (const CUnit *unit : manager.GetUnits()) {
+			if (unit->Removed || !players.test(unit->Player->Index)
+			    || unit->tilePos.x / AiInfluenceCellSize != cellX
+			    || unit->tilePos.y / AiInfluenceCellSize != cellY) {
+				continue;
+			}
+			++sum.Units;
+			if (!unit->Type->CanAttack) {
+				continue;
+			}
+			const int strength = unit->IsAlive() ? unit->Stats->Variables[BASICDAMAGE_INDEX].Value
+			                                       + unit->Stats->Variables[PIERCINGDAMAGE_INDEX].Value
+			                                     : 0;
+			const std::pair<EMovement, ECanTargetFlag> targets[] = {{EMovement::Land, ECanTargetFlag::Land},
+			                                                        {EMovement::Fly, ECanTargetFlag::Air},
+			                                                        {EMovement::Naval, ECanTargetFlag::Sea}};
+			sum.Strength += strength;
+			for (const auto &[movement, flag] : targets) {
+				if ((unit->Type->CanTarget & flag) != ECanTargetFlag::NulFlag) {
+					sum.Threat[int(movement)] += strength;
+					++sum.Attackers[int(movement)];
+				}
+			}
+		}
+		return sum;
+	}
+
+	/// Compare the influence map with the units, cell by cell
+	void CheckInfluence() const
+	{
+		std::vector<std::bitset<PlayerMax>> playerSets(4);
+		playerSets[0].set(0);
+		playerSets[1].set(1);
+		playerSets[2].set(1).set(2);
+		playerSets[3] = AiInfluenceHostiles(Players[0]);
+		CHECK(playerSets[3] == playerSets[2]);
+
+		// the biggest unit is 3x3: start the area 2 tiles in the cell to only sum it
+		const Vec2i inCell(2, 2);
+		for (const auto &players : playerSets) {
+			for (int cellY = 0; cellY != InfluenceMapSize / AiInfluenceCellSize; ++cellY) {
+				for (int cellX = 0; cellX != InfluenceMapSize / AiInfluenceCellSize; ++cellX) {
+					const Vec2i topLeft(cellX * AiInfluenceCellSize, cellY * AiInfluenceCellSize);
+					const Vec2i bottomRight = topLeft + Vec2i(AiInfluenceCellSize - 1, AiInfluenceCellSize - 1);
+					const AiInfluence influence = AiGetInfluence(players, topLeft + inCell, bottomRight);
+					const AiInfluence expected = CellInfluence(players, cellX, cellY);
+
+					CHECK(influence.Units == expected.Units);
+					CHECK(influence.Strength == expected.Strength);
+					for (int i = 0; i != 3; ++i) {
+						CHECK(influence.Threat[i] == expected.Threat[i]);
+						CHECK(influence.Attackers[i] == expected.Attackers[i]);
+					}
+				}
+			}
+		}
+	}
+
+	CUnitType footman;
+	CUnitType archer;
+	CUnitType flyer;
+	CUnitType ship;
+	CUnitType hall;
+
+private:
+	CUnitManager manager;
+	CUnitManager *oldUnitManager = nullptr;
+};
+
+/// Units of several types and players, spread with a fixed sequence
+std::vector<CUnit *> SpreadUnits(InfluenceUnitsMap &unitsMap, unsigned int &seed)
+{
+	const auto next = [&seed](int max) {
+		seed = seed * 1103515245 + 12345;
+		return int((seed >> 16) % max);
+	};
+	const std::vector<CUnitType *> types = unitsMap.Types();
+	std::vector<CUnit *> units;
+
+	for (int i = 0; i != 200; ++i) {
+		CUnitType &type = *types[next(types.size())];
+		const Vec2i pos(next(InfluenceMapSize - 2), next(InfluenceMapSize - 2));
+		units.push_back(&unitsMap.Create(type, next(3), pos));
+	}
+	return units;
+}
+
+} // namespace
+
+TEST_CASE("AI tasks split")
+{
+	CPlayer player;
+	AiTasksPlayer tasksPlayer(player, 100);
+	PlayerAi ai;
+	ai.Player = &player;
+
+	SUBCASE("Costs")
+	{
+		AiTasksPlayer::StartSecond(ai);
+		CHECK(AiNextTaskCost(ai) == 1);
+		for (AiTask task : {AiTask::CheckUnits, AiTask::Resources, AiTask::AssignFreeUnits, AiTask::Magic}) {
+			ai.NextTask = task;
+			CHECK(AiNextTaskCost(ai) == 101);
+		}
+		ai.NextTask = AiTask::Forces;
+		tasksPlayer.Recruit(ai, 0, 30);
+		CHECK(AiNextTaskCost(ai) == 31);
+		ai.NextForce = 1;
+		CHECK(AiNextTaskCost(ai) == 1);
+		ai.ForcePathing = -1; // the forces are not updated anymore
+		ai.NextForce = 0;
+		CHECK(AiNextTaskCost(ai) == 1);
+		ai.NextTask = AiTask::Explorers;
+		CHECK(AiNextTaskCost(ai) == 1);
+		ai.NextTask = AiTask::Done;
+		CHECK(AiNextTaskCost(ai) == 0);
+	}
+	SUBCASE("Cycles")
+	{
+		tasksPlayer.Recruit(ai, 0, 30);
+		tasksPlayer.Recruit(ai, 1, 100);
+		AiTasksPlayer::StartSecond(ai);
+		const auto cycles = AiTasksPlayer::SplitSecond(ai);
+
+		// 1 + 101 + 101 + 31, then the second force goes over the budget
+		REQUIRE(cycles.size() == 2);
+		CHECK((cycles[0]
+		       == std::vector{AiTask::Script, AiTask::CheckUnits, AiTask::Resources, AiTask::Forces, AiTask::Forces}));
+		// the empty forces and the end of the forces, then 101 + 101 + 1
+		CHECK(std::count(cycles[1].begin(), cycles[1].end(), AiTask::Forces) == AI_MAX_FORCES - 1);
+		CHECK((std::vector(cycles[1].end() - 3, cycles[1].end())
+		       == std::vector{AiTask::AssignFreeUnits, AiTask::Magic, AiTask::Explorers}));
+	}
+	SUBCASE("Same state, same split")
+	{
+		// Other units and AI, with the same counts
+		CPlayer otherPlayer;
+		AiTasksPlayer otherTasksPlayer(otherPlayer, 100);
+		PlayerAi otherAi;
+		otherAi.Player = &otherPlayer;
+		for (unsigned int force = 0; force != 5; ++force) {
+			tasksPlayer.Recruit(ai, force, 20 * force);
+			otherTasksPlayer.Recruit(otherAi, force, 20 * force);
+		}
+		AiTasksPlayer::StartSecond(ai);
+		AiTasksPlayer::StartSecond(otherAi);
+		const auto cycles = AiTasksPlayer::SplitSecond(ai);
+		CHECK(cycles.size() > 1);
+		CHECK(AiTasksPlayer::SplitSecond(otherAi) == cycles);
+
+		// and the next second is split the same way
+		AiTasksPlayer::StartSecond(ai);
+		CHECK(AiTasksPlayer::SplitSecond(ai) == cycles);
+	}
+	SUBCASE("Each cycle runs a task")
+	{
+		CPlayer bigPlayer;
+		AiTasksPlayer bigTasksPlayer(bigPlayer, 2 * AI_TASK_BUDGET);
+		PlayerAi bigAi;
+		bigAi.Player = &bigPlayer;
+		bigTasksPlayer.Recruit(bigAi, 0, 2 * AI_TASK_BUDGET);
+		AiTasksPlayer::StartSecond(bigAi);
+		const auto cycles = AiTasksPlayer::SplitSecond(bigAi);
+
+		for (const auto &tasks : cycles) {
+			CHECK(!tasks.empty());
+		}
+		// Script and CheckUnits, then each big task alone
+		CHECK((cycles.front() == std::vector{AiTask::Script, AiTask::CheckUnits}));
+		CHECK((cycles[1] == std::vector{AiTask::Resources}));
+		CHECK((cycles[2] == std::vector{AiTask::Forces}));
+	}
+}
+
+TEST_CASE("AI tasks saved in the middle of a second")
+{
+	InitLua();
+	AiCclRegister();
+	CAiType &aiType = *AiTypes.emplace_back(std::make_unique<CAiType>());
+	aiType.Name = "ai-test";
+
+	CPlayer &player = Players[1];
+	AiTasksPlayer tasksPlayer(player, 300);
+	player.Ai = std::make_unique<PlayerAi>();
+	player.Ai->Player = &player;
+	player.Ai->AiType = &aiType;
+	for (unsigned int force = 0; force != 4; ++force) {
+		player.Ai->Force[force].State = AiForceAttackingState::Waiting;
+		player.Ai->Force[force].GoalPos = Vec2i(force, 2 * force);
+	}
+	player.Ai->NextTask = AiTask::Forces;
+	player.Ai->NextForce = 3;
+	player.Ai->ForcePathing = 1;
+
+	CFile file;
+	file.open(nullptr, CL_WRITE_MEMORY | CL_OPEN_WRITE);
+	SaveAi(file);
+	file.close();
+	const std::string save = file.takeBuffer();
+
+	const auto rest = AiTasksPlayer::SplitSecond(*player.Ai);
+	player.Ai.reset();
+
+	REQUIRE(CclCommand(save, false) == 0);
+	REQUIRE(player.Ai);
+	PlayerAi &ai = *player.Ai;
+	CHECK(ai.NextTask == AiTask::Forces);
+	CHECK(ai.NextForce == 3);
+	CHECK(ai.ForcePathing == 1);
+	CHECK(ai.Force[ai.NextForce].GoalPos == Vec2i(3, 6));
+	CHECK(AiTasksPlayer::SplitSecond(ai) == rest);
+
+	player.Ai.reset();
+	AiTypes.pop_back();
+	lua_close(Lua);
+	Lua = nullptr;
+}
+
+TEST_CASE("AI influence map")
+{
+	InfluenceUnitsMap unitsMap;
+	unsigned int seed = 42;
+	const std::vector<CUnit *> units = SpreadUnits(unitsMap, seed);
+	unitsMap.CheckInfluence();
+
+	SUBCASE("Move")
+	{
+		for (size_t i = 0; i < units.size(); i += 2) {
+			const Vec2i pos((units[i]->tilePos.x + 11) % (InfluenceMapSize - 2), (units[i]->tilePos.y + 5) % (InfluenceMapSize - 2));
+			unitsMap.Move(*units[i], pos);
+		}
+		unitsMap.CheckInfluence();
+	}
+	SUBCASE("Change owner")
+	{
+		for (size_t i = 0; i < units.size(); i += 3) {
+			unitsMap.ChangeOwner(*units[i], (units[i]->Player->Index + 1) % 3);
+		}
+		unitsMap.CheckInfluence();
+	}
+	SUBCASE("Die")
+	{
+		for (size_t i = 0; i < units.size(); i += 4) {
+			unitsMap.Die(*units[i], i % 8 == 0);
+		}
+		unitsMap.CheckInfluence();
+	}
+	SUBCASE("All")
+	{
+		for (size_t i = 0; i < units.size(); ++i) {
+			switch (i % 4) {
+				case 0: unitsMap.Move(*units[i], Vec2i(i % 7, i % 13)); break;
+				case 1: unitsMap.ChangeOwner(*units[i], i % 3); break;
+				case 2: unitsMap.Die(*units[i], i % 3 == 0); break;
+				default: break;
+			}
+		}
+		unitsMap.CheckInfluence();
+
+		// the whole map is all the units
+		std::bitset<PlayerMax> all;
+		all.set(0).set(1).set(2);
+		const Vec2i last(InfluenceMapSize - 1, InfluenceMapSize - 1);
+		int count = 0;
+		for (const CUnit *unit : units) {
+			count += !unit->Removed;
+		}
+		CHECK(AiGetInfluence(all, Vec2i(0, 0), last).Units == count);
+		CHECK(AiGetInfluence(all, Vec2i(-10, -10), last + Vec2i(10, 10)).Units == count);
+	}
+}
+
+TEST_CASE("AI enemy units in distance")
+{
+	InfluenceUnitsMap unitsMap;
+	unsigned int seed = 7;
+	const std::vector<CUnit *> units = SpreadUnits(unitsMap, seed);
+	// some dying units still on the map
+	for (size_t i = 0; i < units.size(); i += 10) {
+		unitsMap.Die(*units[i], true);
+	}
+	std::vector<const CUnitType *> types{nullptr};
+	for (const CUnitType *type : unitsMap.Types()) {
+		types.push_back(type);
+	}
+
+	for (int player = 0; player != 3; ++player) {
+		for (const CUnitType *type : types) {
+			const Vec2i typeSize = type ? Vec2i(type->TileWidth - 1, type->TileHeight - 1) : Vec2i(0, 0);
+			// The selection without the influence map, like the predicates of AiEnemyUnitsInDistance
+			const auto pred = [&](const CUnit *unit) {
+				return unit->IsEnemy(Players[player]) && (type == nullptr || CanTarget(*unit->Type, *type));
+			};
+
+			for (unsigned int range : {1u, 3u, 8u, 20u}) {
+				const Vec2i offset(range, range);
+				for (int y = 0; y < InfluenceMapSize; y += 3) {
+					for (int x = 0; x < InfluenceMapSize; x += 5) {
+						const Vec2i pos(x, y);
+						const bool found = !Select<1>(pos - offset, pos + typeSize + offset, pred).empty();
+
+						CHECK(AiEnemyUnitsInDistance(Players[player], type, pos, range) == found);
+					}
+				}
+			}
+		}
+	}
+}
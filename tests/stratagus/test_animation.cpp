@@ -0,0 +1,160 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name test_animation.cpp - The test file for the animation operands. */
+//
+//      (c) Copyright 2026 by the Stratagus Team
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#include <doctest.h>
+
+#include "stratagus.h"
+
+#include "actions.h"
+#include "animation.h"
+#include "player.h"
+#include "script.h"
+#include "unit.h"
+#include "unittype.h"
+
+#include <set>
+
+namespace
+{
+/// A unit of player 0 following a goal, with hit points and bool flags
+class AnimUnits
+{
+public:
+	AnimUnits()
+	{
+		for (int i = 0; i != 3; ++i) {
+			Players[i].Index = i;
+		}
+		type.BoolFlag.resize(UnitTypeVar.GetNumberBoolFlag());
+		type.BoolFlag[COWARD_INDEX].value = true;
+		for (CUnit *u : {&unit, &goal}) {
+			u->Type = &type;
+			u->Variable.resize(UnitTypeVar.GetNumberVariable());
+		}
+		unit.Player = &Players[0];
+		goal.Player = &Players[1];
+		unit.Variable[HP_INDEX].Value = 30;
+		unit.Variable[HP_INDEX].Max = 120;
+		goal.Variable[HP_INDEX].Value = 45;
+		goal.Variable[HP_INDEX].Max = 50;
+		unit.Orders.push_back(COrder::NewActionFollow(goal));
+	}
+
+	CUnitType type;
+	CUnit goal; // destroyed after the order of unit
+	CUnit unit;
+};
+
+/// Define an animation set with one frame, return the status of the Lua call
+int DefineAnimation(const std::string &frame)
+{
+	const std::string script = "DefineAnimations(\"animations-test\", {Still = {\"" + frame + "\", \"wait 1\"}})";
+	if (luaL_loadbuffer(Lua, script.data(), script.size(), "test") != 0) {
+		return -1;
+	}
+	return lua_pcall(Lua, 0, 0, 0);
+}
+} // namespace
+
+TEST_CASE("Animation operands")
+{
+	AnimUnits units;
+	const CUnit &unit = units.unit;
+
+	SUBCASE("Numbers")
+	{
+		CHECK(CAnimInt("42", nullptr).GetNumber() == 42);
+		CHECK(CAnimInt("-7", nullptr).GetNumber() == -7);
+		CHECK(CAnimInt("42", nullptr).Eval(unit) == 42);
+		CHECK(CAnimInt("", nullptr).Eval(unit) == 0);
+	}
+	SUBCASE("Random")
+	{
+		const CAnimInt range("r.3.5", nullptr);
+		const CAnimInt max("r.4", nullptr);
+		std::set<int> rangeValues;
+		std::set<int> maxValues;
+		for (int i = 0; i != 200; ++i) {
+			rangeValues.insert(range.Eval(unit));
+			maxValues.insert(max.Eval(unit));
+		}
+		CHECK((rangeValues == std::set<int>{3, 4, 5}));
+		CHECK((maxValues == std::set<int>{0, 1, 2, 3, 4}));
+	}
+	SUBCASE("Unit variables")
+	{
+		CHECK(CAnimInt("v.HitPoints.Value", nullptr).Eval(unit) == 30);
+		CHECK(CAnimInt("v.HitPoints.Max", nullptr).Eval(unit) == 120);
+		CHECK(CAnimInt("v.HitPoints.Percent", nullptr).Eval(unit) == 25);
+		CHECK(CAnimInt("t.HitPoints.Value", nullptr).Eval(unit) == 45);
+		CHECK(CAnimInt("t.HitPoints.Percent", nullptr).Eval(unit) == 90);
+		CHECK(CAnimInt("b.Coward", nullptr).Eval(unit) == 1);
+		CHECK(CAnimInt("g.Coward", nullptr).Eval(unit) == 1);
+
+		// no goal
+		units.unit.Orders[0] = COrder::NewActionStill();
+		CHECK(CAnimInt("t.HitPoints.Value", nullptr).Eval(unit) == 0);
+		CHECK(CAnimInt("v.HitPoints.Value", nullptr).Eval(unit) == 30);
+	}
+	SUBCASE("Players")
+	{
+		Players[0].Score = 10;
+		Players[1].Score = 20;
+		Players[2].Score = 30;
+		CHECK(CAnimInt("p.this.Score", nullptr).Eval(unit) == 10);
+		CHECK(CAnimInt("p.1.Score", nullptr).Eval(unit) == 20);
+		CHECK(CAnimInt("l.this", nullptr).Eval(unit) == 0);
+		CHECK(CAnimInt("l.2", nullptr).Eval(unit) == 2);
+		for (int i = 0; i != 3; ++i) {
+			Players[i].Score = 0;
+		}
+	}
+}
+
+TEST_CASE("Animation operand errors")
+{
+	InitLua();
+	AnimationCclRegister();
+
+	CHECK(DefineAnimation("wait v.HitPoints.Percent") == 0);
+	CHECK(DefineAnimation("wait p.this.Score") == 0);
+	CHECK(DefineAnimation("wait r.2.8") == 0);
+	// reported when the animation is defined, not when it is played
+	CHECK(DefineAnimation("wait v.NoSuchVariable.Value") != 0);
+	CHECK(DefineAnimation("wait v.HitPoints.NoSuchTag") != 0);
+	CHECK(DefineAnimation("wait v.HitPoints") != 0);
+	CHECK(DefineAnimation("wait b.NoSuchFlag") != 0);
+	CHECK(DefineAnimation("wait r.x") != 0);
+	CHECK(DefineAnimation("wait twelve") != 0);
+	CHECK(DefineAnimation("wait p.this") != 0);
+
+	FreeAnimations();
+	lua_close(Lua);
+	Lua = nullptr;
+}
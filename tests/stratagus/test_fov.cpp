@@ -0,0 +1,121 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name test_fov.cpp - The test file for field of view. */
+//
+//      (c) Copyright 2026 by the Stratagus Team
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#include <doctest.h>
+
+#include "stratagus.h"
+
+#include "fov.h"
+#include "map.h"
+#include "player.h"
+#include "settings.h"
+#include "unit.h"
+#include "unittype.h"
+
+#include <algorithm>
+
+namespace
+{
+constexpr int MapSize = 64;
+
+std::vector<int> *Counts = nullptr;
+
+void CountMark(const CPlayer &, const unsigned int index)
+{
+	++(*Counts)[index];
+}
+
+void CountUnmark(const CPlayer &, const unsigned int index)
+{
+	--(*Counts)[index];
+}
+}
+
+TEST_CASE("Field of view move")
+{
+	Map.Info.MapWidth = MapSize;
+	Map.Info.MapHeight = MapSize;
+	Map.Create();
+	for (int i = 0; i < MapSize * MapSize; i += 7) {
+		Map.Field(i)->Flags = MapFieldOpaque;
+	}
+	const FieldOfViewTypes oldFoV = GameSettings.FoV;
+
+	CUnitType type;
+	type.BoolFlag.resize(NBARALREADYDEFINED);
+	CUnit unit;
+	unit.Type = &type;
+	unit.Player = &Players[0];
+
+	for (const auto fov : {FieldOfViewTypes::cSimpleRadial, FieldOfViewTypes::cShadowCasting}) {
+		for (const int size : {1, 2}) {
+			GameSettings.FoV = fov;
+			const int range = 6;
+			std::vector<int> refreshed(MapSize * MapSize);
+			std::vector<int> moved(MapSize * MapSize);
+			const auto refresh = [&](std::vector<int> &counts, const Vec2i &pos, MapMarkerFunc *marker) {
+				Counts = &counts;
+				FieldOfView.Refresh(Players[0], unit, pos, size, size, range, marker);
+			};
+
+			Vec2i pos(4, 4);
+			refresh(refreshed, pos, CountMark);
+			refresh(moved, pos, CountMark);
+			// along the border, then diagonally through the opaque tiles
+			const Vec2i steps[] = {{-1, 0}, {-1, -1}, {0, -1}, {0, -1}, {1, 1}, {1, 1}, {1, 0}, {0, 1}};
+			for (int i = 0; i != 40; ++i) {
+				const Vec2i step = steps[i % 8];
+				const Vec2i next(std::clamp(pos.x + step.x, 0, MapSize - size),
+				                 std::clamp(pos.y + step.y, 0, MapSize - size));
+				if (i == 20) {
+					// terrain change, around which the sights are refreshed
+					refresh(refreshed, pos, CountUnmark);
+					refresh(moved, pos, CountUnmark);
+					Map.Field(Vec2i(6, 6))->Flags ^= MapFieldOpaque;
+					FieldOfView.TerrainChanged();
+					refresh(refreshed, pos, CountMark);
+					refresh(moved, pos, CountMark);
+				}
+				refresh(refreshed, pos, CountUnmark);
+				refresh(refreshed, next, CountMark);
+				Counts = &moved;
+				FieldOfView.Move(Players[0], unit, pos, next, size, size, range, CountMark, CountUnmark);
+				REQUIRE(refreshed == moved);
+				pos = next;
+			}
+		}
+	}
+
+	GameSettings.FoV = oldFoV;
+	Counts = nullptr;
+	FieldOfView.Clean();
+	Map.Fields.clear();
+	Map.Info.MapWidth = 0;
+	Map.Info.MapHeight = 0;
+}
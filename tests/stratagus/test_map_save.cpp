@@ -0,0 +1,105 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name test_map_save.cpp - The test file for the map save. */
+//
+//      (c) Copyright 2026 by the Stratagus Team
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#include <doctest.h>
+
+#include "stratagus.h"
+
+#include "map.h"
+#include "tileset.h"
+
+#include <chrono>
+
+namespace
+{
+constexpr int MapSize = 512;
+
+void CreateMap()
+{
+	Map.Info.MapWidth = MapSize;
+	Map.Info.MapHeight = MapSize;
+	Map.Create();
+}
+
+void FreeMap()
+{
+	Map.Fields.clear();
+	Map.Visibility.Clear();
+	Map.Info.MapWidth = 0;
+	Map.Info.MapHeight = 0;
+}
+}
+
+TEST_CASE("Binary map fields")
+{
+	CreateMap();
+	for (int i = 0; i != MapSize * MapSize; ++i) {
+		CMapField &mf = *Map.Field(i);
+		mf.setGraphicTile(i % 300);
+		mf.playerInfo.SeenTile = i % 200;
+		mf.Value = i % 1000;
+		mf.Flags = (i % 3 ? MapFieldLandAllowed : MapFieldForest) | (i % 7 ? 0 : MapFieldOpaque)
+		         | (i % 11 ? 0 : MapFieldDecorative); // the last one is not saved
+		Map.Visibility.SetVisible(i % PlayerMax, i, 1);
+		Map.Visibility.SetVisible((i + 1) % PlayerMax, i, 3); // seen ones are counted again on load
+	}
+	const fs::path fieldsFile = fs::temp_directory_path() / "stratagus_test_map.fields";
+
+	using Clock = std::chrono::steady_clock;
+	const auto t0 = Clock::now();
+	REQUIRE(Map.SaveFields(fieldsFile));
+	const std::vector<CMapField> saved = Map.Fields;
+	FreeMap();
+	CreateMap();
+	const auto t1 = Clock::now();
+	REQUIRE(Map.LoadFields(fieldsFile));
+	const auto t2 = Clock::now();
+
+	for (int i = 0; i != MapSize * MapSize; ++i) {
+		const CMapField &mf = *Map.Field(i);
+		REQUIRE(mf.getGraphicTile() == saved[i].getGraphicTile());
+		REQUIRE(mf.playerInfo.SeenTile == saved[i].playerInfo.SeenTile);
+		REQUIRE(mf.Value == saved[i].Value);
+		REQUIRE(mf.getCost() == saved[i].getCost());
+		REQUIRE(mf.Flags == (saved[i].Flags & ~MapFieldDecorative));
+		for (int p = 0; p != PlayerMax; ++p) {
+			REQUIRE(Map.Visibility.GetVisible(p, i) == (p == i % PlayerMax ? 1 : 0));
+		}
+	}
+	const auto us = [](auto d) {
+		return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+	};
+	MESSAGE("save: " << us(t1 - t0) << "us, load: " << us(t2 - t1) << "us");
+
+	std::error_code ec;
+	for (const char *extension : {"", ".gz", ".bz2"}) {
+		fs::remove(fieldsFile.string() + extension, ec);
+	}
+	FreeMap();
+}
@@ -0,0 +1,560 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name test_pathfinder.cpp - The test file for pathfinder. */
+//
+//      (c) Copyright 2026 by the Stratagus Team
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#include <doctest.h>
+
+#include "stratagus.h"
+
+#include "actions.h"
+#include "map.h"
+#include "pathfinder.h"
+#include "player.h"
+#include "settings.h"
+#include "unit.h"
+#include "unit_find.h"
+#include "unit_manager.h"
+#include "unittype.h"
+
+#include <algorithm>
+#include <chrono>
+#include <optional>
+
+namespace
+{
+constexpr int MazeSize = 256;
+constexpr int LandMask = MapFieldUnpassable | MapFieldBuilding | MapFieldLandUnit;
+
+/**
+**  A serpentine maze: a wall every 8 columns, with a single gap
+**  alternately at the top and at the bottom.
+*/
+Vec2i MazeGap(int wallIndex)
+{
+	return Vec2i(wallIndex * 8 + 7, wallIndex % 2 ? 1 : MazeSize - 2);
+}
+
+[[nodiscard]] auto InitMaze()
+{
+	Map.Info.MapWidth = MazeSize;
+	Map.Info.MapHeight = MazeSize;
+	Map.Create();
+	for (int x = 7; x < MazeSize; x += 8) {
+		for (int y = 0; y != MazeSize; ++y) {
+			Map.Field(x, y)->Flags = MapFieldUnpassable;
+		}
+		Map.Field(MazeGap(x / 8))->Flags = 0;
+	}
+	InitPathfinder();
+
+	struct S
+	{
+		S() {}
+		S(const S &) = delete;
+		~S()
+		{
+			FreePathfinder();
+			Map.Fields.clear();
+			Map.Info.MapWidth = 0;
+			Map.Info.MapHeight = 0;
+		}
+	};
+	return S(); // copy-elision
+}
+}
+
+TEST_CASE("Hierarchical path finder")
+{
+	const auto maze = InitMaze();
+	const Vec2i start(0, 0);
+	const Vec2i goal(MazeSize - 2, MazeSize - 1);
+	std::vector<Vec2i> waypoints;
+
+	REQUIRE(HierarchicalFindPath(start, goal, LandMask, waypoints));
+	CHECK(!waypoints.empty());
+	for (const Vec2i &waypoint : waypoints) {
+		CHECK(CanMoveToMask(waypoint, LandMask));
+	}
+
+	SUBCASE("closed gap")
+	{
+		const Vec2i gap = MazeGap(10);
+		Map.Field(gap)->Flags = MapFieldUnpassable;
+		PathfinderTerrainChanged(gap, Vec2i(1, 1));
+		CHECK_FALSE(HierarchicalFindPath(start, goal, LandMask, waypoints));
+
+		Map.Field(gap)->Flags = 0;
+		PathfinderTerrainChanged(gap, Vec2i(1, 1));
+		CHECK(HierarchicalFindPath(start, goal, LandMask, waypoints));
+	}
+	SUBCASE("unpassable goal")
+	{
+		const Vec2i wall(7 * 8 + 7, MazeSize / 2);
+		CHECK(HierarchicalFindPath(start, wall, LandMask, waypoints));
+	}
+}
+
+TEST_CASE("Flow field")
+{
+	const auto maze = InitMaze();
+	const Vec2i goal(MazeSize - 2, MazeSize - 1);
+	char path[PathFinderOutput::MAX_PATH_LENGTH];
+
+	// the first unit only registers the goal
+	CHECK(FlowFieldFindPath(Vec2i(240, 200), goal, LandMask, path, PathFinderOutput::MAX_PATH_LENGTH) == PF_FAILED);
+	const int length = FlowFieldFindPath(Vec2i(241, 200), goal, LandMask, path, PathFinderOutput::MAX_PATH_LENGTH);
+	REQUIRE(length > PathFinderOutput::MAX_PATH_LENGTH);
+	Vec2i pos(241, 200);
+	for (int i = PathFinderOutput::MAX_PATH_LENGTH - 1; i >= 0; --i) {
+		pos += Vec2i(Heading2X[int(path[i])], Heading2Y[int(path[i])]);
+		CHECK(CanMoveToMask(pos, LandMask));
+	}
+	CHECK(FlowFieldFindPath(pos, goal, LandMask, path, PathFinderOutput::MAX_PATH_LENGTH)
+	      == length - PathFinderOutput::MAX_PATH_LENGTH);
+
+	// the field only covers the tiles around the units which asked for it
+	CHECK(FlowFieldFindPath(Vec2i(0, 0), goal, LandMask, path, PathFinderOutput::MAX_PATH_LENGTH) == PF_FAILED);
+
+	// a terrain change drops the field
+	PathfinderTerrainChanged(MazeGap(3), Vec2i(1, 1));
+	CHECK(FlowFieldFindPath(Vec2i(240, 200), goal, LandMask, path, PathFinderOutput::MAX_PATH_LENGTH) == PF_FAILED);
+}
+
+TEST_CASE("Reachability")
+{
+	const auto maze = InitMaze();
+	const Vec2i start(0, 0);
+	const Vec2i goal(MazeSize - 2, MazeSize - 1);
+	const Vec2i gap = MazeGap(10);
+
+	CHECK(ReachabilityMayReach(start, goal, goal, LandMask));
+
+	Map.Field(gap)->Flags = MapFieldUnpassable;
+	PathfinderTerrainChanged(gap, Vec2i(1, 1));
+	CHECK_FALSE(ReachabilityMayReach(start, goal, goal, LandMask));
+	CHECK(ReachabilityMayReach(start, gap - Vec2i(1, 0), gap, LandMask));
+
+	Map.Field(gap)->Flags = 0;
+	PathfinderTerrainChanged(gap, Vec2i(1, 1));
+	CHECK(ReachabilityMayReach(start, goal, goal, LandMask));
+
+	// a building in the open doesn't split anything
+	const Vec2i building(MazeGap(10).x - 4, MazeSize / 2);
+	for (int y = 0; y != 3; ++y) {
+		for (int x = 0; x != 3; ++x) {
+			Map.Field(building + Vec2i(x, y))->Flags = MapFieldBuilding;
+		}
+	}
+	PathfinderTerrainChanged(building, Vec2i(3, 3));
+	CHECK(ReachabilityMayReach(start, goal, goal, LandMask));
+	CHECK(ReachabilityMayReach(building - Vec2i(1, 0), building + Vec2i(3, 0), building + Vec2i(3, 0), LandMask));
+}
+
+TEST_CASE("A* batch")
+{
+	CUnitType type;
+	type.MovementMask = LandMask;
+	type.TileWidth = 1;
+	type.TileHeight = 1;
+	CUnit unit;
+	unit.Type = &type;
+
+	const bool oldKnowUnseenTerrain = AStarKnowUnseenTerrain;
+	const bool oldBatch = AStarBatch;
+	const int oldThreads = AStarThreads;
+	AStarKnowUnseenTerrain = true;
+	AStarThreads = 4;
+
+	std::vector<AStarRequest> requests(24);
+	for (size_t i = 0; i != requests.size(); ++i) {
+		requests[i].Unit = &unit;
+		requests[i].StartPos = Vec2i(i * 8 % (MazeSize - 8), i % 2 ? 3 : MazeSize - 4);
+		requests[i].UnitSize = Vec2i(1, 1);
+		requests[i].GoalPos = requests[i].StartPos + Vec2i(12, 0);
+		requests[i].GoalSize = Vec2i(1, 1);
+	}
+	// the worker threads are started with the map
+	const auto solve = [&requests](bool batch) {
+		AStarBatch = batch;
+		const auto maze = InitMaze();
+		auto solved = requests;
+		AStarFindPathBatch(solved);
+		// the workers are kept for the next batches
+		auto solvedAgain = requests;
+		AStarFindPathBatch(solvedAgain);
+		for (size_t i = 0; i != solved.size(); ++i) {
+			CHECK(solved[i].Result == solvedAgain[i].Result);
+		}
+		return solved;
+	};
+	const auto sequential = solve(false);
+	const auto parallel = solve(true);
+
+	AStarKnowUnseenTerrain = oldKnowUnseenTerrain;
+	AStarBatch = oldBatch;
+	AStarThreads = oldThreads;
+
+	for (size_t i = 0; i != requests.size(); ++i) {
+		REQUIRE(sequential[i].Result == parallel[i].Result);
+		CHECK(sequential[i].Result > 0);
+		const int length = std::min<int>(sequential[i].Result, PathFinderOutput::MAX_PATH_LENGTH);
+		CHECK(std::equal(sequential[i].Path, sequential[i].Path + length, parallel[i].Path));
+	}
+}
+
+TEST_CASE("Harvest routes")
+{
+	CUnitType type;
+	type.MovementMask = LandMask;
+	type.TileWidth = 1;
+	type.TileHeight = 1;
+	CUnitType buildingType;
+	buildingType.TileWidth = 2;
+	buildingType.TileHeight = 2;
+
+	CUnit harvester;
+	harvester.Type = &type;
+	harvester.tilePos = Vec2i(2, MazeSize / 2);
+	CUnit mine;
+	mine.Type = &buildingType;
+	mine.tilePos = Vec2i(0, MazeSize / 2);
+	CUnit depot;
+	depot.Type = &buildingType;
+
+	const bool oldKnowUnseenTerrain = AStarKnowUnseenTerrain;
+	const bool oldHarvestRoutes = AStarHarvestRoutes;
+	AStarKnowUnseenTerrain = true;
+	AStarHarvestRoutes = true;
+	const auto maze = InitMaze();
+	char path[PathFinderOutput::MAX_PATH_LENGTH];
+
+	SUBCASE("reachable depot")
+	{
+		depot.tilePos = Vec2i(3, MazeSize / 2 + 20);
+		const int length = HarvestRouteFindPath(harvester, mine, depot, true, path, PathFinderOutput::MAX_PATH_LENGTH);
+		CHECK(length > 0);
+		CHECK(HarvestRouteHasRoute(mine, depot, LandMask));
+	}
+	SUBCASE("unreachable depot")
+	{
+		depot.tilePos = Vec2i(3, 0);
+		for (int x = 0; x != 7; ++x) {
+			Map.Field(x, 3)->Flags = MapFieldUnpassable;
+		}
+		PathfinderTerrainChanged(Vec2i(0, 3), Vec2i(7, 1));
+		CHECK(HarvestRouteFindPath(harvester, mine, depot, true, path, PathFinderOutput::MAX_PATH_LENGTH) == PF_FAILED);
+		CHECK_FALSE(HarvestRouteHasRoute(mine, depot, LandMask));
+	}
+	SUBCASE("depot too far for A*")
+	{
+		// A* stops at its iteration limit, with a path not reaching the depot
+		depot.tilePos = Vec2i(MazeSize - 3, MazeSize / 2);
+		CHECK(HarvestRouteFindPath(harvester, mine, depot, true, path, PathFinderOutput::MAX_PATH_LENGTH) == PF_FAILED);
+		CHECK_FALSE(HarvestRouteHasRoute(mine, depot, LandMask));
+	}
+	FreeHarvestRoutes();
+	AStarKnowUnseenTerrain = oldKnowUnseenTerrain;
+	AStarHarvestRoutes = oldHarvestRoutes;
+}
+
+TEST_CASE("Hierarchical path finder benchmark")
+{
+	const auto maze = InitMaze();
+	const Vec2i start(0, 0);
+	const Vec2i goal(MazeSize - 2, MazeSize - 1);
+
+	CUnitType type;
+	type.MovementMask = LandMask;
+	type.TileWidth = 1;
+	type.TileHeight = 1;
+	CUnit unit;
+	unit.Type = &type;
+	unit.tilePos = start;
+
+	const bool oldKnowUnseenTerrain = AStarKnowUnseenTerrain;
+	const int oldMaxSearchIterations = AStarMaxSearchIterations;
+	AStarKnowUnseenTerrain = true;
+	AStarMaxSearchIterations = MazeSize * MazeSize;
+
+	using Clock = std::chrono::steady_clock;
+	const auto t0 = Clock::now();
+	const int flatLength = PlaceReachable(unit, goal, 1, 1, 0, 0, false);
+	const auto t1 = Clock::now();
+	std::vector<Vec2i> waypoints;
+	const bool found = HierarchicalFindPath(start, goal, LandMask, waypoints); // builds the graph
+	const auto t2 = Clock::now();
+	HierarchicalFindPath(start, goal, LandMask, waypoints);
+	const auto t3 = Clock::now();
+
+	AStarKnowUnseenTerrain = oldKnowUnseenTerrain;
+	AStarMaxSearchIterations = oldMaxSearchIterations;
+
+	CHECK(flatLength > 0);
+	CHECK(found);
+	const auto us = [](auto d) {
+		return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+	};
+	MESSAGE("flat A*: " << us(t1 - t0) << "us, hierarchical: " << us(t2 - t1)
+	        << "us (with graph build), " << us(t3 - t2) << "us");
+}
+
+TEST_CASE("Terrain traversal benchmark")
+{
+	constexpr int MapSize = 512;
+	constexpr int ForestSpacing = 24;
+	Map.Info.MapWidth = MapSize;
+	Map.Info.MapHeight = MapSize;
+	Map.Create();
+	for (int y = ForestSpacing / 2; y < MapSize; y += ForestSpacing) {
+		for (int x = ForestSpacing / 2; x < MapSize; x += ForestSpacing) {
+			Map.Field(x, y)->Flags = MapFieldForest;
+		}
+	}
+	CPlayer &player = Players[0];
+	const bool oldAiEnabled = player.AiEnabled;
+	player.AiEnabled = true; // search the unexplored tiles too
+
+	using Clock = std::chrono::steady_clock;
+	const auto t0 = Clock::now();
+	for (int i = 0; i != 2000; ++i) {
+		const Vec2i start(i * 37 % MapSize, i * 91 % MapSize);
+		Vec2i pos;
+		REQUIRE(FindTerrainType(LandMask, MapFieldForest, ForestSpacing, player, start, &pos));
+		CHECK(Map.Field(pos)->Flags == MapFieldForest);
+		CHECK(std::max(abs(pos.x - start.x), abs(pos.y - start.y)) <= ForestSpacing / 2);
+	}
+	const auto t1 = Clock::now();
+	Vec2i pos;
+	CHECK_FALSE(FindTerrainType(LandMask, MapFieldRocks, MapSize, player, Vec2i(0, 0), &pos));
+	const auto t2 = Clock::now();
+
+	player.AiEnabled = oldAiEnabled;
+	Map.Fields.clear();
+	Map.Info.MapWidth = 0;
+	Map.Info.MapHeight = 0;
+
+	const auto us = [](auto d) {
+		return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+	};
+	MESSAGE("2000 local searches on " << MapSize << "x" << MapSize << ": " << us(t1 - t0)
+	        << "us, whole map search: " << us(t2 - t1) << "us");
+}
+
+TEST_CASE("Forest distance field")
+{
+	constexpr int MapSize = 48;
+	constexpr tile_flags Forest = MapFieldForest | MapFieldUnpassable;
+	Map.Info.MapWidth = MapSize;
+	Map.Info.MapHeight = MapSize;
+	Map.Create();
+	for (int i = 0; i < MapSize * MapSize; i += 13) {
+		Map.Field(i)->Flags = (i / 13) % 3 ? Forest : MapFieldUnpassable;
+	}
+	CPlayer &player = Players[0];
+	const bool oldAiEnabled = player.AiEnabled;
+	const bool oldDistanceFields = AStarDistanceFields;
+	player.AiEnabled = true;
+	AStarDistanceFields = true;
+	InitDistanceFields(MapSize, MapSize);
+
+	const auto findAll = [&]() {
+		std::vector<Vec2i> found;
+		for (int i = 0; i != MapSize * MapSize; ++i) {
+			Vec2i pos(-1, -1);
+			FindTerrainType(LandMask, MapFieldForest, 8, player, Vec2i(i % MapSize, i / MapSize), &pos);
+			found.push_back(pos);
+		}
+		return found;
+	};
+	// cut, regrow, block and open some tiles, the field is updated in place
+	for (int step = 0; step != 40; ++step) {
+		const Vec2i pos(step * 17 % MapSize, step * 29 % MapSize);
+		tile_flags &flags = Map.Field(pos)->Flags;
+		flags = flags & MapFieldForest ? MapFieldNoBuilding : step % 2 ? Forest : MapFieldUnpassable;
+		DistanceFieldsTerrainChanged(pos, Vec2i(1, 1));
+
+		const std::vector<Vec2i> updated = findAll();
+		InitDistanceFields(MapSize, MapSize);
+		REQUIRE(findAll() == updated);
+
+		for (int i = step; i < MapSize * MapSize; i += 97) {
+			const Vec2i start(i % MapSize, i / MapSize);
+			Vec2i forestPos;
+			AStarDistanceFields = false;
+			const bool searched = FindTerrainType(LandMask, MapFieldForest, 8, player, start, &forestPos);
+			AStarDistanceFields = true;
+			CHECK(searched == (updated[i] != Vec2i(-1, -1)));
+		}
+	}
+
+	player.AiEnabled = oldAiEnabled;
+	AStarDistanceFields = oldDistanceFields;
+	FreeDistanceFields();
+	Map.Fields.clear();
+	Map.Info.MapWidth = 0;
+	Map.Info.MapHeight = 0;
+}
+
+TEST_CASE("Depot distance field")
+{
+	constexpr int MapSize = 48;
+	Map.Info.MapWidth = MapSize;
+	Map.Info.MapHeight = MapSize;
+	Map.Create();
+	for (int i = 0; i < MapSize * MapSize; i += 11) {
+		Map.Field(i)->Flags = MapFieldUnpassable;
+	}
+	for (int i = 0; i != 3; ++i) {
+		Players[i].Index = i;
+	}
+	const bool oldDistanceFields = AStarDistanceFields;
+	const bool oldAllyDeposits = GameSettings.AllyDepositsAllowed;
+	AStarDistanceFields = true;
+	GameSettings.AllyDepositsAllowed = true;
+	CUnitManager manager;
+	CUnitManager *oldUnitManager = UnitManager;
+	UnitManager = &manager;
+	InitDistanceFields(MapSize, MapSize);
+
+	CUnitType depotType;
+	depotType.TileWidth = 3;
+	depotType.TileHeight = 3;
+	depotType.Building = true;
+	depotType.CanStore[GoldCost] = 1;
+	CUnitType workerType;
+	workerType.MovementMask = LandMask;
+	workerType.TileWidth = 1;
+	workerType.TileHeight = 1;
+	CUnit worker;
+	worker.Type = &workerType;
+
+	// the tiles of the depots are blocked as when they are placed
+	const auto markDepot = [&](const CUnit &depot, bool mark) {
+		for (int y = 0; y != depot.Type->TileHeight; ++y) {
+			for (int x = 0; x != depot.Type->TileWidth; ++x) {
+				tile_flags &flags = Map.Field(depot.tilePos + Vec2i(x, y))->Flags;
+				flags = mark ? flags | MapFieldBuilding : flags & ~MapFieldBuilding;
+			}
+		}
+		DistanceFieldsTerrainChanged(depot.tilePos, Vec2i(depot.Type->TileWidth, depot.Type->TileHeight));
+	};
+	const auto createDepot = [&](int player, const Vec2i &pos) -> CUnit & {
+		CUnit &depot = *manager.AllocUnit();
+		manager.Add(&depot);
+		depot.Type = &depotType;
+		Players[player].AddUnit(depot);
+		depot.Orders.push_back(COrder::NewActionStill());
+		depot.Removed = 0;
+		depot.Constructed = 1;
+		depot.tilePos = pos;
+		markDepot(depot, true);
+		DistanceFieldsUnitChanged(depot);
+		return depot;
+	};
+	const auto findDeposit = [&](int player, const Vec2i &pos) {
+		worker.Player = &Players[player];
+		worker.tilePos = pos;
+		return DistanceFieldFindDeposit(worker, 1000, GoldCost);
+	};
+	// the fields updated in place must be the ones built from scratch
+	const auto checkFields = [&]() {
+		const auto findAll = [&]() {
+			std::vector<std::optional<CUnit *>> found;
+			for (int player = 0; player != 3; ++player) {
+				for (int i = 0; i < MapSize * MapSize; i += 5) {
+					found.push_back(findDeposit(player, Vec2i(i % MapSize, i / MapSize)));
+				}
+			}
+			return found;
+		};
+		const auto updated = findAll();
+		InitDistanceFields(MapSize, MapSize);
+		CHECK(findAll() == updated);
+	};
+	checkFields();
+
+	CUnit &depotA = createDepot(0, Vec2i(5, 5));
+	checkFields();
+	CHECK(findDeposit(0, Vec2i(10, 10)) == std::optional<CUnit *>(nullptr)); // not finished
+
+	depotA.Constructed = 0;
+	DistanceFieldsUnitChanged(depotA);
+	checkFields();
+	CHECK(findDeposit(0, Vec2i(10, 10)) == &depotA);
+
+	CUnit &depotB = createDepot(1, Vec2i(30, 30));
+	depotB.Constructed = 0;
+	DistanceFieldsUnitChanged(depotB);
+	checkFields();
+	CHECK(findDeposit(0, Vec2i(35, 35)) == &depotA);
+	CHECK(findDeposit(1, Vec2i(10, 10)) == &depotB);
+
+	// the allied depots are used: the fields are built again
+	Players[0].SetDiplomacyAlliedWith(Players[1]);
+	Players[1].SetDiplomacyAlliedWith(Players[0]);
+	checkFields();
+	CHECK(findDeposit(0, Vec2i(35, 35)) == &depotB);
+	CHECK(findDeposit(1, Vec2i(10, 10)) == &depotA);
+
+	CUnit &depotC = createDepot(0, Vec2i(40, 5));
+	depotC.Constructed = 0;
+	DistanceFieldsUnitChanged(depotC);
+	checkFields();
+	CHECK(findDeposit(1, Vec2i(40, 10)) == &depotC);
+
+	// given to another player
+	Players[2].AddUnit(depotC);
+	DistanceFieldsUnitChanged(depotC);
+	checkFields();
+	CHECK(findDeposit(1, Vec2i(40, 10)) != &depotC);
+	CHECK(findDeposit(2, Vec2i(10, 10)) == &depotC);
+
+	// destroyed
+	DistanceFieldsUnitChanged(depotA, true);
+	depotA.Removed = 1;
+	depotA.Orders[0] = COrder::NewActionDie();
+	markDepot(depotA, false);
+	checkFields();
+	CHECK(findDeposit(0, Vec2i(10, 10)) == &depotB);
+
+	Players[0].SetDiplomacyNeutralWith(Players[1]);
+	Players[1].SetDiplomacyNeutralWith(Players[0]);
+	checkFields();
+	CHECK(findDeposit(0, Vec2i(10, 10)) == std::optional<CUnit *>(nullptr));
+
+	for (CUnit *depot : {&depotA, &depotB, &depotC}) {
+		depot->Player->RemoveUnit(*depot);
+	}
+	FreeDistanceFields();
+	UnitManager = oldUnitManager;
+	GameSettings.AllyDepositsAllowed = oldAllyDeposits;
+	AStarDistanceFields = oldDistanceFields;
+	Map.Fields.clear();
+	Map.Info.MapWidth = 0;
+	Map.Info.MapHeight = 0;
+}
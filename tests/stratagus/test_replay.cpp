@@ -0,0 +1,345 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name test_replay.cpp - The test file for the replay logs. */
+//
+//      (c) Copyright 2026 by the Stratagus Team
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#include <doctest.h>
+
+#include "stratagus.h"
+
+#include "filesystem.h"
+#include "replay.h"
+#include "script.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+namespace
+{
+/// A command with none of the optional fields
+LogEntry MakeLog(unsigned long cycle, const std::string &action)
+{
+	LogEntry log;
+	log.GameCycle = cycle;
+	log.Action = action;
+	log.UnitNumber = -1;
+	log.Pos = {-1, -1};
+	log.DestUnitNumber = -1;
+	log.Num = -1;
+	return log;
+}
+
+/// Commands of every kind, with and without each optional field
+std::vector<LogEntry> MakeLogs()
+{
+	std::vector<LogEntry> logs;
+	LogEntry log = MakeLog(0, "stop");
+	log.UnitNumber = 12;
+	log.UnitIdent = "unit-footman";
+	log.SyncRandSeed = 0x89ABCDEF;
+	logs.push_back(log);
+
+	log = MakeLog(5, "move");
+	log.UnitNumber = 12;
+	log.UnitIdent = "unit-footman";
+	log.Flush = 1;
+	log.Pos = {40, 51};
+	log.SyncRandSeed = 42;
+	logs.push_back(log);
+
+	log = MakeLog(5, "attack");
+	log.UnitNumber = 13;
+	log.UnitIdent = "unit-archer";
+	log.Pos = {0, 0};
+	log.DestUnitNumber = 200;
+	logs.push_back(log);
+
+	log = MakeLog(64, "train");
+	log.UnitNumber = 3;
+	log.UnitIdent = "unit-barracks";
+	log.Value = "unit-footman";
+	logs.push_back(log);
+
+	log = MakeLog(70, "spell-cast");
+	log.UnitNumber = 14;
+	log.UnitIdent = "unit-mage";
+	log.Pos = {7, 9};
+	log.DestUnitNumber = 15;
+	log.Num = 2;
+	logs.push_back(log);
+
+	log = MakeLog(100, "diplomacy");
+	log.Value = "enemy";
+	log.Num = 1;
+	log.DestUnitNumber = 0;
+	logs.push_back(log);
+
+	logs.push_back(MakeLog(100000, "quit"));
+	return logs;
+}
+
+bool operator==(const LogEntry &lhs, const LogEntry &rhs)
+{
+	return lhs.GameCycle == rhs.GameCycle && lhs.UnitNumber == rhs.UnitNumber
+	       && lhs.UnitIdent == rhs.UnitIdent && lhs.Action == rhs.Action && lhs.Flush == rhs.Flush
+	       && lhs.Pos == rhs.Pos && lhs.DestUnitNumber == rhs.DestUnitNumber && lhs.Value == rhs.Value
+	       && lhs.Num == rhs.Num && lhs.SyncRandSeed == rhs.SyncRandSeed;
+}
+
+std::string Write(const std::vector<LogEntry> &logs)
+{
+	CReplayCommandWriter writer;
+	std::string out;
+	for (const LogEntry &log : logs) {
+		writer.Write(log, out);
+	}
+	return out;
+}
+
+/// Read all the commands of data, return false if the last one is incomplete.
+bool Read(const std::string &data, std::vector<LogEntry> &logs)
+{
+	CReplayCommandReader reader;
+	const unsigned char *p = reinterpret_cast<const unsigned char *>(data.data());
+	const unsigned char *end = p + data.size();
+	logs.clear();
+	LogEntry log;
+	while (p != end) {
+		if (!reader.Read(p, end, log)) {
+			return false;
+		}
+		REQUIRE(p <= end);
+		logs.push_back(log);
+	}
+	return true;
+}
+
+std::string ReadFile(const fs::path &path)
+{
+	std::ifstream file(path, std::ios::binary);
+	return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+/// The commands of a binary replay file, after its lua header
+std::string BinaryCommands(const std::string &content)
+{
+	REQUIRE(content.compare(0, 4, "SRP1") == 0);
+	size_t pos = 4;
+	uint64_t headerSize = 0;
+	for (int shift = 0;; shift += 7) {
+		REQUIRE(pos < content.size());
+		const unsigned char byte = content[pos++];
+		headerSize |= uint64_t(byte & 0x7F) << shift;
+		if (!(byte & 0x80)) {
+			break;
+		}
+	}
+	REQUIRE(pos + headerSize <= content.size());
+	return content.substr(pos + headerSize);
+}
+} // namespace
+
+TEST_CASE("Replay commands round trip")
+{
+	const std::vector<LogEntry> logs = MakeLogs();
+	std::vector<LogEntry> read;
+
+	REQUIRE(Read(Write(logs), read));
+	REQUIRE(read.size() == logs.size());
+	for (size_t i = 0; i != logs.size(); ++i) {
+		CHECK(read[i] == logs[i]);
+	}
+}
+
+TEST_CASE("Replay varints")
+{
+	std::vector<LogEntry> logs;
+	unsigned long cycle = 0;
+	for (const int value : {0, 1, 63, 64, 127, 128, 8191, 8192, INT_MAX, -2, -64, -65, -128, -129, INT_MIN}) {
+		LogEntry log = MakeLog(cycle, "test");
+		log.UnitNumber = value;
+		log.DestUnitNumber = value;
+		log.Num = value;
+		log.Flush = value;
+		log.Pos = {short(value & 0x7FFF), short(-(value & 0x7FFF))};
+		logs.push_back(log);
+		// the delta to the previous cycle is a varint too
+		cycle += value >= 0 && value <= 8192 ? value : 1;
+	}
+	// the cycle may go back
+	logs.push_back(MakeLog(3, "test"));
+	std::vector<LogEntry> read;
+
+	REQUIRE(Read(Write(logs), read));
+	REQUIRE(read.size() == logs.size());
+	for (size_t i = 0; i != logs.size(); ++i) {
+		CHECK(read[i] == logs[i]);
+	}
+
+	// lengths of the strings are unsigned varints: 127 fits in one byte, not 128
+	const std::string oneByte = Write({MakeLog(0, std::string(127, 'a'))});
+	const std::string twoBytes = Write({MakeLog(0, std::string(128, 'a'))});
+	CHECK(twoBytes.size() == oneByte.size() + 2);
+}
+
+TEST_CASE("Replay strings")
+{
+	LogEntry log = MakeLog(0, "a-long-action-name");
+	log.UnitIdent = "a-long-unit-ident";
+	log.Value = "a-long-value";
+	const std::string once = Write({log});
+	const std::string twice = Write({log, log});
+	const std::string second = twice.substr(once.size());
+
+	CHECK(twice.compare(0, once.size(), once) == 0);
+	CHECK(second.size() < once.size());
+	CHECK(second.find("a-long-action-name") == std::string::npos);
+	CHECK(second.find("a-long-unit-ident") == std::string::npos);
+	CHECK(second.find("a-long-value") == std::string::npos);
+
+	// the same content in another field is interned once too
+	LogEntry other = MakeLog(1, "a-long-value");
+	other.UnitIdent = "a-long-action-name";
+	const std::string mixed = Write({log, other});
+	CHECK(mixed.find("a-long-value") == mixed.rfind("a-long-value"));
+	CHECK(mixed.find("a-long-action-name") == mixed.rfind("a-long-action-name"));
+
+	std::vector<LogEntry> read;
+	REQUIRE(Read(mixed, read));
+	REQUIRE(read.size() == 2);
+	CHECK(read[0] == log);
+	CHECK(read[1] == other);
+}
+
+TEST_CASE("Replay truncated commands")
+{
+	const std::vector<LogEntry> logs = MakeLogs();
+	std::vector<size_t> ends; // end of each command
+	for (size_t i = 1; i <= logs.size(); ++i) {
+		ends.push_back(Write(std::vector<LogEntry>(logs.begin(), logs.begin() + i)).size());
+	}
+	const std::string data = Write(logs);
+	std::vector<LogEntry> read;
+
+	SUBCASE("truncated")
+	{
+		for (size_t size = 0; size != data.size(); ++size) {
+			// a copy, so the sanitizers see any read past the end
+			const std::string truncated = data.substr(0, size);
+			const bool complete = std::find(ends.begin(), ends.end(), size) != ends.end() || size == 0;
+			CHECK(Read(truncated, read) == complete);
+		}
+	}
+	SUBCASE("unknown string")
+	{
+		// the first command of data uses the string 0, there is no string 5 yet
+		std::string corrupted = data.substr(0, ends[0]);
+		REQUIRE(corrupted[2] == 0);
+		corrupted[2] = 5;
+		CHECK_FALSE(Read(corrupted, read));
+	}
+	SUBCASE("too long string")
+	{
+		std::string corrupted = data.substr(0, ends[0]);
+		REQUIRE(corrupted[3] == char(logs[0].Action.size()));
+		corrupted[3] = 0x7F;
+		CHECK_FALSE(Read(corrupted, read));
+	}
+	SUBCASE("too long varint")
+	{
+		CHECK_FALSE(Read(std::string(12, char(0xFF)) + data, read));
+	}
+}
+
+TEST_CASE("Replay conversion")
+{
+	const std::vector<LogEntry> logs = MakeLogs();
+	const fs::path dir = fs::temp_directory_path();
+	const fs::path luaReplay = dir / "stratagus_test_replay.lua";
+	const fs::path binaryReplay = dir / "stratagus_test_replay.log";
+	const fs::path luaAgain = dir / "stratagus_test_replay_again.lua";
+	const fs::path binaryAgain = dir / "stratagus_test_replay_again.log";
+	{
+		std::ofstream file(luaReplay);
+		file << "ReplayLog( {\n  Comment1 = \"test\",\n  Map = \"test\",\n"
+		        "  Engine = { 3, 3, 0 },\n  Network = { 3, 3, 0 }\n} )\n";
+		for (const LogEntry &log : logs) {
+			file << "Log( { GameCycle = " << log.GameCycle << ", ";
+			if (log.UnitNumber != -1) {
+				file << "UnitNumber = " << log.UnitNumber << ", ";
+			}
+			if (!log.UnitIdent.empty()) {
+				file << "UnitIdent = \"" << log.UnitIdent << "\", ";
+			}
+			file << "Action = \"" << log.Action << "\", Flush = " << log.Flush << ", ";
+			if (log.Pos.x != -1 || log.Pos.y != -1) {
+				file << "PosX = " << log.Pos.x << ", PosY = " << log.Pos.y << ", ";
+			}
+			if (log.DestUnitNumber != -1) {
+				file << "DestUnitNumber = " << log.DestUnitNumber << ", ";
+			}
+			if (!log.Value.empty()) {
+				file << "Value = [[" << log.Value << "]], ";
+			}
+			if (log.Num != -1) {
+				file << "Num = " << log.Num << ", ";
+			}
+			file << "SyncRandSeed = " << int(log.SyncRandSeed) << " } )\n";
+		}
+	}
+	InitLua();
+	ReplayCclRegister();
+
+	// the absolute paths are kept by ConvertReplay
+	const auto convert = [](const fs::path &source, const fs::path &destination) {
+		return CclCommand("ConvertReplay(\"" + source.generic_string() + "\", \""
+		                  + destination.generic_string() + "\")", false);
+	};
+	REQUIRE(convert(luaReplay, binaryReplay) == 0);
+	const std::string binary = ReadFile(binaryReplay);
+	std::vector<LogEntry> read;
+	REQUIRE(Read(BinaryCommands(binary), read));
+	REQUIRE(read.size() == logs.size());
+	for (size_t i = 0; i != logs.size(); ++i) {
+		CHECK(read[i] == logs[i]);
+	}
+
+	// and back, the lua replay gives the same binary one
+	REQUIRE(convert(binaryReplay, luaAgain) == 0);
+	REQUIRE(convert(luaAgain, binaryAgain) == 0);
+	CHECK(ReadFile(binaryAgain) == binary);
+
+	lua_close(Lua);
+	Lua = nullptr;
+	std::error_code ec;
+	for (const fs::path &path : {luaReplay, binaryReplay, luaAgain, binaryAgain}) {
+		fs::remove(path, ec);
+	}
+}
@@ -0,0 +1,188 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name test_savegame.cpp - The test file for the save games. */
+//
+//      (c) Copyright 2026 by the Stratagus Team
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#include <doctest.h>
+
+#include "stratagus.h"
+
+#include "game.h"
+#include "iolib.h"
+#include "map.h"
+#include "parameters.h"
+#include "player.h"
+#include "script.h"
+#include "unit_manager.h"
+
+#include <sstream>
+
+namespace
+{
+/// Read a whole file, compressed or not
+std::string ReadFile(const fs::path &path)
+{
+	CFile file;
+	REQUIRE(file.open(path.string().c_str(), CL_OPEN_READ) == 0);
+	std::string content;
+	char buf[1024];
+	int len;
+	while ((len = file.read(buf, sizeof(buf))) > 0) {
+		content.append(buf, len);
+	}
+	file.close();
+	return content;
+}
+
+/// Remove the lines of the save game which depend on the time of the save
+std::string WithoutDate(const std::string &content)
+{
+	std::istringstream stream(content);
+	std::string res;
+	std::string line;
+	while (std::getline(stream, line)) {
+		if (line.rfind("---  \"date\"", 0) != 0) {
+			res += line + '\n';
+		}
+	}
+	return res;
+}
+
+/// Minimal game state to save: a small map and no unit
+class SaveGameState
+{
+public:
+	SaveGameState()
+	{
+		oldUserDirectory = Parameters::Instance.GetUserDirectory();
+		directory = fs::temp_directory_path() / "stratagus_test_savegame";
+		fs::remove_all(directory);
+		Parameters::Instance.SetUserDirectory(directory);
+
+		InitLua();
+		oldUnitManager = UnitManager;
+		UnitManager = &manager;
+		ThisPlayer = &Players[0];
+		Map.Info.MapWidth = 32;
+		Map.Info.MapHeight = 32;
+		Map.Create();
+		for (int i = 0; i != 32 * 32; ++i) {
+			Map.Field(i)->Value = i % 100;
+			Map.Field(i)->Flags = i % 3 ? MapFieldLandAllowed : MapFieldForest;
+		}
+	}
+	~SaveGameState()
+	{
+		Map.Fields.clear();
+		Map.Visibility.Clear();
+		Map.Info.MapWidth = 0;
+		Map.Info.MapHeight = 0;
+		ThisPlayer = nullptr;
+		UnitManager = oldUnitManager;
+		lua_close(Lua);
+		Lua = nullptr;
+		Parameters::Instance.SetUserDirectory(oldUserDirectory);
+		std::error_code ec;
+		fs::remove_all(directory, ec);
+	}
+
+	fs::path SaveDir() const { return directory / "save"; }
+
+private:
+	CUnitManager manager;
+	CUnitManager *oldUnitManager = nullptr;
+	fs::path directory;
+	fs::path oldUserDirectory;
+};
+} // namespace
+
+TEST_CASE("Memory file")
+{
+	const std::string longText(5000, 'x');
+	const char binary[] = {'a', '\0', 'b', '\0'};
+
+	CFile file;
+	REQUIRE(file.open(nullptr, CL_WRITE_MEMORY | CL_OPEN_WRITE) == 0);
+	file.printf("GameCycle = %d\n", 42);
+	file.printf("%s\n", longText.c_str()); // longer than the printf buffer
+	CHECK(file.write(binary, sizeof(binary)) == int(sizeof(binary)));
+	file.close();
+	const std::string content = file.takeBuffer();
+	const std::string expected = "GameCycle = 42\n" + longText + "\n" + std::string(binary, sizeof(binary));
+	CHECK(content == expected);
+
+	SUBCASE("Write to the disk and read back")
+	{
+		const fs::path path = fs::temp_directory_path() / "stratagus_test_memory_file";
+		CFile gzFile;
+		REQUIRE(gzFile.open(path.string().c_str(), CL_WRITE_GZ | CL_OPEN_WRITE) == 0);
+		CHECK(gzFile.write(content.data(), content.size()) == int(content.size()));
+		CHECK(gzFile.close() == 0);
+
+		CHECK(ReadFile(path) == expected); // finds the compressed one
+		std::error_code ec;
+		fs::remove(path.string() + ".gz", ec);
+		fs::remove(path, ec);
+	}
+	SUBCASE("Reopen")
+	{
+		REQUIRE(file.open(nullptr, CL_WRITE_MEMORY | CL_OPEN_WRITE) == 0);
+		file.printf("new");
+		file.close();
+		CHECK(file.takeBuffer() == "new");
+	}
+}
+
+TEST_CASE("Async save game")
+{
+	SaveGameState state;
+
+	REQUIRE(SaveGame("test-a.sav") == 0);
+	REQUIRE(SaveGameAsync("test-b.sav"));
+	REQUIRE(WaitSaveGame() == 0);
+	CHECK(WaitSaveGame() == 0); // nothing left to wait for
+
+	std::string syncSave = ReadFile(state.SaveDir() / "test-a.sav");
+	std::string asyncSave = ReadFile(state.SaveDir() / "test-b.sav");
+	REQUIRE(!syncSave.empty());
+	// The file names are written in the save games
+	CHECK(syncSave.find("\"test-a.fields\"") != std::string::npos);
+	CHECK(asyncSave.find("\"test-b.fields\"") != std::string::npos);
+	for (auto [save, name] : {std::pair{&syncSave, "test-a"}, std::pair{&asyncSave, "test-b"}}) {
+		for (size_t pos = save->find(name); pos != std::string::npos; pos = save->find(name, pos)) {
+			save->replace(pos, strlen(name), "name");
+		}
+	}
+	CHECK(WithoutDate(asyncSave) == WithoutDate(syncSave));
+
+	const std::string syncFields = ReadFile(state.SaveDir() / "test-a.fields");
+	CHECK(!syncFields.empty());
+	CHECK(ReadFile(state.SaveDir() / "test-b.fields") == syncFields);
+
+	DeleteSaveGame("test-b.sav");
+	CHECK(!fs::exists(state.SaveDir() / "test-b.fields.gz"));
+}
@@ -32,7 +32,13 @@
 #include "stratagus.h"
 
 #include "trigger.h"
+#include "actions.h"
+#include "map.h"
+#include "player.h"
 #include "script.h"
+#include "unit.h"
+#include "unit_manager.h"
+#include "unittype.h"
 
 namespace
 {
@@ -92,6 +98,78 @@ int test_getLuaTableSize(const char* varname)
 	return size;
 }
 
+/**
+**  A small map with a unit manager and two unit-types, the units are
+**  placed and moved like CUnit::Place and CUnit::MoveToXY do.
+*/
+class TriggerUnitsMap
+{
+public:
+	TriggerUnitsMap()
+	{
+		Map.Info.MapWidth = 32;
+		Map.Info.MapHeight = 32;
+		Map.Create();
+		for (const char *ident : {"unit-test-footman", "unit-test-hall"}) {
+			CUnitType &type = *NewUnitTypeSlot(ident).first;
+			type.TileWidth = type.TileHeight = 1;
+		}
+		oldUnitManager = UnitManager;
+		UnitManager = &manager;
+	}
+	TriggerUnitsMap(const TriggerUnitsMap &) = delete;
+	~TriggerUnitsMap()
+	{
+		for (CUnit *unit : manager.GetUnits()) {
+			if (!unit->Removed) {
+				Map.Remove(*unit);
+			}
+		}
+		UnitManager = oldUnitManager;
+		Map.UnitBuckets.Clear();
+		Map.Fields.clear();
+		Map.Visibility.Clear();
+		Map.Info.MapWidth = 0;
+		Map.Info.MapHeight = 0;
+		CleanUnitTypes();
+	}
+
+	CUnit &Create(const char *ident, const Vec2i &pos)
+	{
+		CUnit &unit = *manager.AllocUnit();
+		manager.Add(&unit);
+		unit.Type = &UnitTypeByIdent(ident);
+		unit.Player = &Players[0];
+		unit.Orders.push_back(COrder::NewActionStill());
+		unit.Removed = 0;
+		unit.tilePos = pos;
+		unit.Offset = Map.getIndex(pos);
+		Map.Insert(unit);
+		return unit;
+	}
+
+	void Move(CUnit &unit, const Vec2i &pos)
+	{
+		Map.Remove(unit);
+		unit.tilePos = pos;
+		unit.Offset = Map.getIndex(pos);
+		Map.Insert(unit);
+	}
+
+	/// What LetUnitDie does for a unit without corpse
+	void Die(CUnit &unit)
+	{
+		TriggerUnitChanged(unit);
+		Map.Remove(unit);
+		unit.Removed = 1;
+		unit.Orders[0] = COrder::NewActionDie();
+	}
+
+private:
+	CUnitManager manager;
+	CUnitManager *oldUnitManager = nullptr;
+};
+
 } // namespace
 
 
@@ -167,3 +245,68 @@ TEST_CASE("Trigger Pause")
 	// do not run check C3
 	CHECK(test_getLuaGlobalStr("log") == "C1 C2 A2 ");
 }
+
+TEST_CASE("Trigger native condition")
+{
+	const auto raii = InitLuaTrigger(R"(
+		AddTrigger({"timer", ">=", 10}, function() l("A1") return false end)
+		AddTrigger(function() l("C2") return false end, function() l("A2") return false end)
+	)");
+	CHECK(test_getLuaTableSize("_triggers_") == 2 * 2);
+
+	GameTimer.Init = true;
+	GameTimer.Cycles = 5;
+	test_setLuaGlobalStr("log", "");
+	TriggersEachCycle();
+	CHECK(test_getLuaGlobalStr("log") == "C2 ");
+
+	GameTimer.Cycles = 10;
+	test_setLuaGlobalStr("log", "");
+	TriggersEachCycle();
+	CHECK(test_getLuaGlobalStr("log") == "A1 C2 ");
+
+	test_setLuaGlobalStr("log", "");
+	TriggersEachCycle();
+	CHECK(test_getLuaGlobalStr("log") == "C2 ");
+	CleanTriggers();
+}
+
+TEST_CASE("Trigger native unit conditions")
+{
+	TriggerUnitsMap map;
+	CUnit &hall = map.Create("unit-test-hall", Vec2i(20, 20));
+	const auto raii = InitLuaTrigger(R"(
+		AddTrigger({"units-at", 0, "unit-test-footman", {5, 5}, {10, 10}, ">=", 1},
+		           function() l("A1") return true end)
+		AddTrigger({"near-unit", 0, ">=", 1, "unit-test-footman", "unit-test-hall"},
+		           function() l("A2") return true end)
+	)");
+	const auto run = []() {
+		test_setLuaGlobalStr("log", "");
+		TriggersEachCycle();
+		return std::string(test_getLuaGlobalStr("log"));
+	};
+	CHECK(run() == "");
+
+	// a unit created in the area
+	CUnit &footman = map.Create("unit-test-footman", Vec2i(6, 6));
+	CHECK(run() == "A1 ");
+	CHECK(run() == "A1 ");
+
+	// moved out of the area, next to the hall
+	map.Move(footman, Vec2i(21, 20));
+	CHECK(run() == "A2 ");
+
+	// the hall moves away
+	map.Move(hall, Vec2i(25, 25));
+	CHECK(run() == "");
+	map.Move(hall, Vec2i(20, 21));
+	CHECK(run() == "A2 ");
+
+	// back in the area, then killed there
+	map.Move(footman, Vec2i(10, 10));
+	CHECK(run() == "A1 ");
+	map.Die(footman);
+	CHECK(run() == "");
+	CleanTriggers();
+}
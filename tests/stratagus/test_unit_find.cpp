@@ -0,0 +1,149 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name test_unit_find.cpp - The test file for unit_find. */
+//
+//      (c) Copyright 2026 by the Stratagus Team
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#include <doctest.h>
+
+#include "stratagus.h"
+
+#include "map.h"
+#include "unit.h"
+#include "unit_find.h"
+#include "unittype.h"
+
+#include <chrono>
+#include <deque>
+
+namespace
+{
+constexpr int MapSize = 256;
+
+/**
+**  A map with some units of size 1 and 3, spread with a fixed sequence.
+*/
+class UnitsMap
+{
+public:
+	UnitsMap()
+	{
+		Map.Info.MapWidth = MapSize;
+		Map.Info.MapHeight = MapSize;
+		Map.Create();
+		smallType.TileWidth = smallType.TileHeight = 1;
+		bigType.TileWidth = bigType.TileHeight = 3;
+
+		unsigned int seed = 42;
+		const auto next = [&seed](int max) {
+			seed = seed * 1103515245 + 12345;
+			return int((seed >> 16) % max);
+		};
+		for (int i = 0; i != 1500; ++i) {
+			CUnit &unit = units.emplace_back();
+			unit.Type = i % 5 ? &smallType : &bigType;
+			unit.tilePos = Vec2i(next(MapSize - 2), next(MapSize - 2));
+			unit.Offset = Map.getIndex(unit.tilePos);
+			Map.Insert(unit);
+		}
+	}
+	UnitsMap(const UnitsMap &) = delete;
+	~UnitsMap()
+	{
+		for (CUnit &unit : units) {
+			Map.Remove(unit);
+		}
+		Map.UnitBuckets.Clear();
+		Map.Fields.clear();
+		Map.Info.MapWidth = 0;
+		Map.Info.MapHeight = 0;
+	}
+
+	std::deque<CUnit> units;
+	CUnitType smallType;
+	CUnitType bigType;
+};
+}
+
+TEST_CASE("Unit buckets")
+{
+	UnitsMap unitsMap;
+	const auto pred = [](const CUnit *unit) { return unit->tilePos.x % 2 == 0; };
+
+	for (int range : {3, 8, 20, 40}) {
+		for (int y = 0; y < MapSize; y += 23) {
+			for (int x = 0; x < MapSize; x += 29) {
+				Vec2i ltPos(x - range, y - range);
+				Vec2i rbPos(x + range, y + range);
+				Map.FixSelectionArea(ltPos, rbPos);
+
+				const std::vector<CUnit *> units = SelectFixedByTile(ltPos, rbPos, NoFilter());
+				CHECK(FindUnitsInTileOrder(ltPos, rbPos) == units);
+				CHECK(SelectFixed(ltPos, rbPos, pred) == SelectFixedByTile(ltPos, rbPos, pred));
+				CHECK(SelectFixed<1>(ltPos, rbPos, pred) == SelectFixedByTile<1>(ltPos, rbPos, pred));
+
+				size_t count = 0;
+				ForEachUnitInRadius(Vec2i(x, y), range, [&](CUnit *unit) {
+					CHECK(unit->MapDistanceTo(Vec2i(x, y)) <= range);
+					++count;
+				});
+				CHECK(count <= units.size());
+			}
+		}
+	}
+}
+
+TEST_CASE("Unit buckets benchmark")
+{
+	UnitsMap unitsMap;
+	using Clock = std::chrono::steady_clock;
+	const auto us = [](auto d) {
+		return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+	};
+
+	for (int range : {8, 16, 32}) {
+		size_t tileCount = 0;
+		size_t bucketCount = 0;
+		const auto t0 = Clock::now();
+		for (int i = 0; i != 1000; ++i) {
+			Vec2i ltPos(i * 37 % MapSize - range, i * 91 % MapSize - range);
+			Vec2i rbPos = ltPos + Vec2i(2 * range, 2 * range);
+			Map.FixSelectionArea(ltPos, rbPos);
+			tileCount += SelectFixedByTile(ltPos, rbPos, NoFilter()).size();
+		}
+		const auto t1 = Clock::now();
+		for (int i = 0; i != 1000; ++i) {
+			Vec2i ltPos(i * 37 % MapSize - range, i * 91 % MapSize - range);
+			Vec2i rbPos = ltPos + Vec2i(2 * range, 2 * range);
+			Map.FixSelectionArea(ltPos, rbPos);
+			bucketCount += FindUnitsInTileOrder(ltPos, rbPos).size();
+		}
+		const auto t2 = Clock::now();
+
+		CHECK(tileCount == bucketCount);
+		MESSAGE("range " << range << ": per tile " << us(t1 - t0) << "us, buckets " << us(t2 - t1) << "us");
+	}
+}
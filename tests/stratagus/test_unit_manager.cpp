@@ -0,0 +1,68 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name test_unit_manager.cpp - The test file for the unit manager. */
+//
+//      (c) Copyright 2026 by the Stratagus Team
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#include <doctest.h>
+
+#include "stratagus.h"
+
+#include "unit.h"
+#include "unit_manager.h"
+
+#include <algorithm>
+
+TEST_CASE("Units table locked")
+{
+	CUnitManager manager;
+	CUnit *units[4];
+
+	for (CUnit *&unit : units) {
+		unit = manager.AllocUnit();
+		manager.Add(unit);
+	}
+	manager.LockUnits();
+	REQUIRE(manager.GetLockedCount() == 4);
+
+	// a released unit is no longer in the table, but is still walked
+	manager.ReleaseUnit(*units[1]);
+	CHECK(manager.GetUnits().size() == 3);
+	CHECK(std::find(manager.GetUnits().begin(), manager.GetUnits().end(), units[1]) == manager.GetUnits().end());
+	CUnit *added = manager.AllocUnit();
+	manager.Add(added);
+	CHECK(manager.GetUnits().back() == added);
+	for (size_t i = 0; i != 4; ++i) {
+		CHECK(&manager.GetLockedUnit(i) == units[i]);
+	}
+	const std::vector<CUnit *> whileLocked = manager.GetUnits();
+	manager.UnlockUnits();
+
+	// same order as without lock: the last unit took the place of the released one
+	const std::vector<CUnit *> expected{units[0], units[3], units[2], added};
+	CHECK(manager.GetUnits() == whileLocked);
+	CHECK(manager.GetUnits() == expected);
+}